@@ -49,3 +49,9 @@ test-coverage-lcov: test-coverage
 
 test-coverage-html: test-coverage-lcov
 	genhtml $(top_srcdir)/.coverage.lcov --output-directory=/tmp/html
+
+tracefile-analyser: $(top_srcdir)/contrib/tracefile-analyser.c
+	$(CC) $(CFLAGS) -O2 -o $@ $(top_srcdir)/contrib/tracefile-analyser.c -lz -lpthread
+
+coverage-shared-dump: $(top_srcdir)/contrib/coverage-shared-dump.c
+	$(CC) $(CFLAGS) -O2 -o $@ $(top_srcdir)/contrib/coverage-shared-dump.c
@@ -0,0 +1,181 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+
+/*
+ * Dumps the cumulative line coverage that PHP processes collect in the file
+ * that xdebug.coverage_shared_file points to.
+ *
+ * Build with:
+ *
+ *   cc -O2 -o coverage-shared-dump coverage-shared-dump.c
+ *
+ * or "make coverage-shared-dump" from a configured extension tree.
+ *
+ * Run as "coverage-shared-dump [-s] file". For each file that was executed,
+ * it shows how many of its lines ran, and which ones, as ranges such as
+ * "3-5,9". Lines that are never listed never ran in any of the sampled
+ * requests. With -s, the line ranges are left out.
+ *
+ * The file can be read while PHP processes are still writing to it.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* These must match src/coverage/shared.h */
+#define SHARED_MAGIC      "XDCOVSHM"
+#define SHARED_VERSION    2
+#define SHARED_ENTRY_SIZE 512
+#define SHARED_NAME_SIZE  (SHARED_ENTRY_SIZE - 32)
+
+typedef struct _shared_header {
+	char     magic[8];
+	uint32_t version;
+	uint32_t max_files;
+	uint32_t max_words;
+	uint32_t file_count;
+	uint32_t words_used;
+	uint32_t entry_size;
+	uint64_t requests;
+	char     reserved[24];
+} shared_header;
+
+typedef struct _shared_entry {
+	uint32_t bitmap_offset;
+	uint32_t line_count;
+	uint32_t name_len;
+	uint32_t reserved;
+	uint64_t source_size;
+	uint64_t source_mtime;
+	char     name[SHARED_NAME_SIZE];
+} shared_entry;
+
+static int line_is_set(const uint64_t *bitmap, uint32_t lineno)
+{
+	return (bitmap[lineno / 64] >> (lineno % 64)) & 1;
+}
+
+static void dump_entry(const shared_entry *entry, const uint64_t *bitmaps, uint32_t max_words, int summary_only)
+{
+	const uint64_t *bitmap;
+	uint32_t        lineno, executed = 0, first;
+	int             ranges = 0;
+
+	if (entry->name_len > SHARED_NAME_SIZE || entry->bitmap_offset + entry->line_count / 64 > max_words) {
+		return;
+	}
+	bitmap = bitmaps + entry->bitmap_offset;
+
+	for (lineno = 0; lineno < entry->line_count; lineno++) {
+		if (line_is_set(bitmap, lineno)) {
+			executed++;
+		}
+	}
+
+	printf("%.*s\n  executed: %u\n", (int) entry->name_len, entry->name, executed);
+	if (summary_only || !executed) {
+		return;
+	}
+
+	printf("  lines: ");
+	for (lineno = 0; lineno < entry->line_count; lineno++) {
+		if (!line_is_set(bitmap, lineno)) {
+			continue;
+		}
+
+		first = lineno;
+		while (lineno + 1 < entry->line_count && line_is_set(bitmap, lineno + 1)) {
+			lineno++;
+		}
+
+		printf("%s%u", ranges++ ? "," : "", first);
+		if (lineno != first) {
+			printf("-%u", lineno);
+		}
+	}
+	printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char          *path;
+	int                  fd, summary_only = 0;
+	struct stat          st;
+	void                *map;
+	const shared_header *header;
+	const char          *entries;
+	const uint64_t      *bitmaps;
+	uint32_t             i, file_count;
+
+	if (argc == 3 && strcmp(argv[1], "-s") == 0) {
+		summary_only = 1;
+		path = argv[2];
+	} else if (argc == 2) {
+		path = argv[1];
+	} else {
+		fprintf(stderr, "Usage: %s [-s] shared-coverage-file\n", argv[0]);
+		return 1;
+	}
+
+	fd = open(path, O_RDONLY);
+	if (fd == -1 || fstat(fd, &st) == -1) {
+		fprintf(stderr, "Can not open '%s': %s\n", path, strerror(errno));
+		return 1;
+	}
+
+	if ((size_t) st.st_size < sizeof(shared_header)) {
+		fprintf(stderr, "'%s' is not a shared coverage file\n", path);
+		return 1;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "Can not map '%s': %s\n", path, strerror(errno));
+		return 1;
+	}
+
+	header = (const shared_header*) map;
+	if (
+		memcmp(header->magic, SHARED_MAGIC, sizeof(header->magic)) != 0 ||
+		header->version != SHARED_VERSION ||
+		header->entry_size != SHARED_ENTRY_SIZE ||
+		(size_t) st.st_size < sizeof(shared_header) + (size_t) header->max_files * SHARED_ENTRY_SIZE + (size_t) header->max_words * sizeof(uint64_t)
+	) {
+		fprintf(stderr, "'%s' is not a shared coverage file of version %d\n", path, SHARED_VERSION);
+		return 1;
+	}
+
+	entries = (const char*) map + sizeof(shared_header);
+	bitmaps = (const uint64_t*) (entries + (size_t) header->max_files * SHARED_ENTRY_SIZE);
+	file_count = header->file_count < header->max_files ? header->file_count : header->max_files;
+
+	printf("requests: %llu\nfiles: %u\n\n", (unsigned long long) header->requests, file_count);
+
+	for (i = 0; i < file_count; i++) {
+		dump_entry((const shared_entry*) (entries + (size_t) i * SHARED_ENTRY_SIZE), bitmaps, header->max_words, summary_only);
+	}
+
+	munmap(map, st.st_size);
+	close(fd);
+
+	return 0;
+}
@@ -0,0 +1,1050 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+
+/*
+ * Streaming analyser for computerized (xdebug.trace_format=1) trace files.
+ *
+ * Build with:
+ *
+ *   cc -O2 -o tracefile-analyser tracefile-analyser.c -lz -lpthread
+ *
+ * or "make tracefile-analyser" from a configured extension tree.
+ *
+ * The trace file, plain or gzip compressed, is read in blocks and never held
+ * in memory as a whole. The reader thread cuts the stream into chunks at the
+ * entries of the outermost traced calls' children (normally the functions
+ * called directly from {main}), and a pool of worker threads rebuilds the
+ * call tree of each chunk with a bounded stack. Every worker aggregates into
+ * its own function table; the tables are merged once all chunks are done.
+ * Frames that are shallower than the split level (such as {main} itself) are
+ * handled by the reader thread.
+ */
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define READ_BLOCK_SIZE      (1024 * 1024)
+#define CHUNK_SIZE           (4 * 1024 * 1024)
+#define MAX_STACK_DEPTH      16384
+#define MAX_THREADS          256
+#define NAME_FIELD           5
+
+typedef struct _function_stats {
+	char      *name;
+	uint32_t   hash;
+	long long  calls;
+	double     time_inclusive;
+	long long  memory_inclusive;
+	double     time_children;
+	long long  memory_children;
+	int        on_stack;
+} function_stats;
+
+typedef struct _function_table {
+	function_stats **slots;
+	size_t           size;
+	size_t           used;
+} function_table;
+
+typedef struct _stack_frame {
+	function_stats *function;
+	double          time;
+	long long       memory;
+	double          nested_time;
+	long long       nested_memory;
+} stack_frame;
+
+typedef struct _chunk {
+	char          *data;
+	size_t         len;
+	size_t         size;
+
+	/* Names of the shallow frames that were open when this chunk started */
+	char         **ancestors;
+	int            ancestor_count;
+
+	/* Time and memory of the split level calls, for their shallow parent */
+	double         top_time;
+	long long      top_memory;
+
+	struct _chunk *next;
+} chunk;
+
+typedef struct _analyser {
+	int             split_level;
+
+	pthread_mutex_t lock;
+	pthread_cond_t  queue_changed;
+	pthread_cond_t  chunk_done;
+	chunk          *queue_head;
+	chunk          *queue_tail;
+	int             queue_length;
+	int             queue_capacity;
+	chunk          *finished;
+	int             pending;
+	int             shutdown;
+} analyser;
+
+typedef struct _worker {
+	pthread_t       thread;
+	analyser       *analyser;
+	function_table  functions;
+	stack_frame    *stack;
+} worker;
+
+static const char *sort_keys[] = { "calls", "time-inclusive", "memory-inclusive", "time-own", "memory-own", NULL };
+
+static void show_usage(void)
+{
+	printf("usage:\n\ttracefile-analyser [-j threads] tracefile [sortkey] [elements]\n\n");
+	printf("Allowed sortkeys:\n\tcalls, time-inclusive, memory-inclusive, time-own, memory-own\n");
+	exit(1);
+}
+
+static void *xmalloc(size_t size)
+{
+	void *ptr = malloc(size);
+
+	if (!ptr) {
+		fprintf(stderr, "Out of memory\n");
+		exit(2);
+	}
+	return ptr;
+}
+
+static void *xcalloc(size_t nmemb, size_t size)
+{
+	void *ptr = calloc(nmemb, size);
+
+	if (!ptr) {
+		fprintf(stderr, "Out of memory\n");
+		exit(2);
+	}
+	return ptr;
+}
+
+static void *xrealloc(void *ptr, size_t size)
+{
+	ptr = realloc(ptr, size);
+
+	if (!ptr) {
+		fprintf(stderr, "Out of memory\n");
+		exit(2);
+	}
+	return ptr;
+}
+
+static char *xstrndup(const char *str, size_t len)
+{
+	char *tmp = xmalloc(len + 1);
+
+	memcpy(tmp, str, len);
+	tmp[len] = '\0';
+
+	return tmp;
+}
+
+/* Function tables: open addressing, keyed on the function name */
+static uint32_t hash_name(const char *name, size_t len)
+{
+	uint32_t h = 2166136261u;
+	size_t   i;
+
+	for (i = 0; i < len; i++) {
+		h ^= (unsigned char) name[i];
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+static void function_table_init(function_table *table)
+{
+	table->size  = 1024;
+	table->used  = 0;
+	table->slots = xcalloc(table->size, sizeof(function_stats *));
+}
+
+static void function_table_grow(function_table *table)
+{
+	function_stats **old_slots = table->slots;
+	size_t           old_size = table->size;
+	size_t           i;
+
+	table->size *= 2;
+	table->slots = xcalloc(table->size, sizeof(function_stats *));
+
+	for (i = 0; i < old_size; i++) {
+		size_t slot;
+
+		if (!old_slots[i]) {
+			continue;
+		}
+
+		slot = old_slots[i]->hash & (table->size - 1);
+		while (table->slots[slot]) {
+			slot = (slot + 1) & (table->size - 1);
+		}
+		table->slots[slot] = old_slots[i];
+	}
+
+	free(old_slots);
+}
+
+static function_stats *function_table_find(function_table *table, const char *name, size_t len)
+{
+	uint32_t        hash = hash_name(name, len);
+	size_t          slot = hash & (table->size - 1);
+	function_stats *stats;
+
+	while (table->slots[slot]) {
+		stats = table->slots[slot];
+		if (stats->hash == hash && strncmp(stats->name, name, len) == 0 && stats->name[len] == '\0') {
+			return stats;
+		}
+		slot = (slot + 1) & (table->size - 1);
+	}
+
+	stats = xcalloc(1, sizeof(function_stats));
+	stats->name = xstrndup(name, len);
+	stats->hash = hash;
+	table->slots[slot] = stats;
+	table->used++;
+
+	if (table->used * 2 > table->size) {
+		function_table_grow(table);
+	}
+
+	return stats;
+}
+
+static void function_table_destroy(function_table *table)
+{
+	size_t i;
+
+	for (i = 0; i < table->size; i++) {
+		if (table->slots[i]) {
+			free(table->slots[i]->name);
+			free(table->slots[i]);
+		}
+	}
+	free(table->slots);
+}
+
+static void function_table_merge(function_table *target, function_table *source)
+{
+	size_t i;
+
+	for (i = 0; i < source->size; i++) {
+		function_stats *src = source->slots[i];
+		function_stats *dst;
+
+		if (!src || src->calls == 0) {
+			continue;
+		}
+
+		dst = function_table_find(target, src->name, strlen(src->name));
+		dst->calls            += src->calls;
+		dst->time_inclusive   += src->time_inclusive;
+		dst->memory_inclusive += src->memory_inclusive;
+		dst->time_children    += src->time_children;
+		dst->memory_children  += src->memory_children;
+	}
+}
+
+/* Records a finished call, the same way the original PHP analyser did: the
+ * call is always counted, but its cost only when the function is not already
+ * further up the stack, so that recursion is not counted twice */
+static void add_to_function(function_stats *function, double time, long long memory, double nested_time, long long nested_memory)
+{
+	function->calls++;
+	function->on_stack--;
+
+	if (function->on_stack == 0) {
+		function->time_inclusive   += time;
+		function->memory_inclusive += memory;
+		function->time_children    += nested_time;
+		function->memory_children  += nested_memory;
+	}
+}
+
+/* Records the calls that were left out of the trace because of
+ * xdebug.trace_call_limit. Only their number and cumulative time is known */
+static void add_summary_to_function(function_stats *function, long long calls, double time)
+{
+	function->calls += calls;
+
+	if (function->on_stack == 0) {
+		function->time_inclusive += time;
+	}
+}
+
+/* Line parsing: '0' is a function entry, '1' a function exit, and 'S' the
+ * summary of calls that were left out */
+typedef struct _trace_line {
+	int         level;
+	char        type;
+	double      time;
+	long long   memory;
+	const char *name;
+	size_t      name_len;
+	long long   summary_calls;
+	double      summary_time;
+} trace_line;
+
+#define IS_LINE_TYPE(t) ((t) == '0' || (t) == '1' || (t) == 'S')
+
+/* Returns the position of the start of the given (0-based) tab separated
+ * field, or NULL if the line does not have that many fields */
+static const char *find_field(const char *line, const char *end, int field)
+{
+	while (field > 0) {
+		line = memchr(line, '\t', end - line);
+		if (!line) {
+			return NULL;
+		}
+		line++;
+		field--;
+	}
+
+	return line;
+}
+
+static int parse_line(const char *line, const char *end, trace_line *parsed)
+{
+	const char *p;
+	const char *name_end;
+
+	if (line == end || *line < '0' || *line > '9') {
+		return 0;
+	}
+
+	parsed->level = atoi(line);
+
+	p = find_field(line, end, 2);
+	if (!p || p == end) {
+		return 0;
+	}
+	parsed->type = *p;
+	if (!IS_LINE_TYPE(parsed->type)) {
+		return 0;
+	}
+
+	p = find_field(p, end, 1);
+	if (!p) {
+		return 0;
+	}
+	parsed->time = strtod(p, NULL);
+
+	p = find_field(p, end, 1);
+	if (!p) {
+		return 0;
+	}
+	parsed->memory = strtoll(p, NULL, 10);
+
+	if (parsed->type == '0' || parsed->type == 'S') {
+		p = find_field(p, end, 1);
+		if (!p) {
+			return 0;
+		}
+		name_end = memchr(p, '\t', end - p);
+		parsed->name     = p;
+		parsed->name_len = name_end ? (size_t) (name_end - p) : (size_t) (end - p);
+	}
+
+	if (parsed->type == 'S') {
+		p = find_field(p, end, 1);
+		if (!p) {
+			return 0;
+		}
+		parsed->summary_calls = strtoll(p, NULL, 10);
+
+		p = find_field(p, end, 1);
+		if (!p) {
+			return 0;
+		}
+		parsed->summary_time = strtod(p, NULL);
+	}
+
+	return 1;
+}
+
+/* Chunk processing, run by the worker threads */
+static void process_chunk(worker *w, chunk *c)
+{
+	int          split_level = w->analyser->split_level;
+	int          top = -1;
+	const char  *line = c->data;
+	const char  *data_end = c->data + c->len;
+	int          i;
+	function_stats **ancestors = xmalloc(sizeof(function_stats *) * (c->ancestor_count + 1));
+
+	for (i = 0; i < c->ancestor_count; i++) {
+		ancestors[i] = function_table_find(&w->functions, c->ancestors[i], strlen(c->ancestors[i]));
+		ancestors[i]->on_stack++;
+	}
+
+	while (line < data_end) {
+		const char *line_end = memchr(line, '\n', data_end - line);
+		trace_line  parsed;
+		int         depth;
+
+		if (!line_end) {
+			line_end = data_end;
+		}
+
+		if (!parse_line(line, line_end, &parsed)) {
+			line = line_end + 1;
+			continue;
+		}
+
+		depth = parsed.level - split_level;
+		if (depth < 0 || depth >= MAX_STACK_DEPTH) {
+			line = line_end + 1;
+			continue;
+		}
+
+		if (parsed.type == '0') {
+			stack_frame *frame = &w->stack[depth];
+
+			/* Frames that never saw their exit line */
+			for (i = top; i >= depth; i--) {
+				if (w->stack[i].function) {
+					w->stack[i].function->on_stack--;
+					w->stack[i].function = NULL;
+				}
+			}
+
+			frame->function      = function_table_find(&w->functions, parsed.name, parsed.name_len);
+			frame->time          = parsed.time;
+			frame->memory        = parsed.memory;
+			frame->nested_time   = 0;
+			frame->nested_memory = 0;
+			frame->function->on_stack++;
+			top = depth;
+		} else if (parsed.type == 'S') {
+			function_stats *function = function_table_find(&w->functions, parsed.name, parsed.name_len);
+
+			if (depth == 0) {
+				c->top_time += parsed.summary_time;
+			} else {
+				w->stack[depth - 1].nested_time += parsed.summary_time;
+			}
+			add_summary_to_function(function, parsed.summary_calls, parsed.summary_time);
+		} else if (depth == top && w->stack[depth].function) {
+			stack_frame *frame = &w->stack[depth];
+			double       d_time   = parsed.time - frame->time;
+			long long    d_memory = parsed.memory - frame->memory;
+
+			if (depth == 0) {
+				c->top_time   += d_time;
+				c->top_memory += d_memory;
+			} else {
+				w->stack[depth - 1].nested_time   += d_time;
+				w->stack[depth - 1].nested_memory += d_memory;
+			}
+
+			add_to_function(frame->function, d_time, d_memory, frame->nested_time, frame->nested_memory);
+			frame->function = NULL;
+			top = depth - 1;
+		}
+
+		line = line_end + 1;
+	}
+
+	/* Calls that did not finish inside the chunk (a truncated trace) are
+	 * dropped, like the original analyser did */
+	for (i = top; i >= 0; i--) {
+		if (w->stack[i].function) {
+			w->stack[i].function->on_stack--;
+			w->stack[i].function = NULL;
+		}
+	}
+	for (i = 0; i < c->ancestor_count; i++) {
+		ancestors[i]->on_stack--;
+	}
+	free(ancestors);
+}
+
+static void *worker_run(void *arg)
+{
+	worker   *w = arg;
+	analyser *a = w->analyser;
+
+	for (;;) {
+		chunk *c;
+
+		pthread_mutex_lock(&a->lock);
+		while (!a->queue_head && !a->shutdown) {
+			pthread_cond_wait(&a->queue_changed, &a->lock);
+		}
+		if (!a->queue_head) {
+			pthread_mutex_unlock(&a->lock);
+			break;
+		}
+		c = a->queue_head;
+		a->queue_head = c->next;
+		if (!a->queue_head) {
+			a->queue_tail = NULL;
+		}
+		a->queue_length--;
+		pthread_cond_broadcast(&a->queue_changed);
+		pthread_mutex_unlock(&a->lock);
+
+		process_chunk(w, c);
+
+		free(c->data);
+		c->data = NULL;
+
+		pthread_mutex_lock(&a->lock);
+		c->next = a->finished;
+		a->finished = c;
+		a->pending--;
+		pthread_cond_broadcast(&a->chunk_done);
+		pthread_mutex_unlock(&a->lock);
+	}
+
+	return NULL;
+}
+
+/* Shallow frames, handled by the reader thread */
+typedef struct _shallow_frame {
+	function_stats *function;
+	double          time;
+	long long       memory;
+	double          nested_time;
+	long long       nested_memory;
+} shallow_frame;
+
+typedef struct _reader {
+	analyser      *analyser;
+	function_table functions;
+	shallow_frame *shallow;
+	chunk         *current;
+} reader;
+
+static void chunk_free(chunk *c)
+{
+	int i;
+
+	for (i = 0; i < c->ancestor_count; i++) {
+		free(c->ancestors[i]);
+	}
+	free(c->ancestors);
+	free(c->data);
+	free(c);
+}
+
+static chunk *chunk_new(reader *r)
+{
+	chunk *c = xcalloc(1, sizeof(chunk));
+	int    i;
+
+	c->size      = CHUNK_SIZE + 4096;
+	c->data      = xmalloc(c->size);
+	c->ancestors = xmalloc(sizeof(char *) * (r->analyser->split_level + 1));
+
+	for (i = 0; i < r->analyser->split_level; i++) {
+		if (r->shallow[i].function) {
+			c->ancestors[c->ancestor_count++] = xstrndup(r->shallow[i].function->name, strlen(r->shallow[i].function->name));
+		}
+	}
+
+	return c;
+}
+
+static void submit_current_chunk(reader *r)
+{
+	analyser *a = r->analyser;
+	chunk    *c = r->current;
+
+	if (!c) {
+		return;
+	}
+	r->current = NULL;
+
+	if (c->len == 0) {
+		chunk_free(c);
+		return;
+	}
+
+	pthread_mutex_lock(&a->lock);
+	while (a->queue_length >= a->queue_capacity) {
+		pthread_cond_wait(&a->queue_changed, &a->lock);
+	}
+	if (a->queue_tail) {
+		a->queue_tail->next = c;
+	} else {
+		a->queue_head = c;
+	}
+	a->queue_tail = c;
+	a->queue_length++;
+	a->pending++;
+	pthread_cond_broadcast(&a->queue_changed);
+	pthread_mutex_unlock(&a->lock);
+}
+
+/* Waits for all submitted chunks, and attributes their cost to the innermost
+ * open shallow frame. This only happens when a shallow frame starts or ends,
+ * which is rare compared to the number of chunks */
+static void wait_for_chunks(reader *r)
+{
+	analyser *a = r->analyser;
+	chunk    *finished;
+	int       parent;
+
+	submit_current_chunk(r);
+
+	pthread_mutex_lock(&a->lock);
+	while (a->pending > 0) {
+		pthread_cond_wait(&a->chunk_done, &a->lock);
+	}
+	finished = a->finished;
+	a->finished = NULL;
+	pthread_mutex_unlock(&a->lock);
+
+	parent = a->split_level - 1;
+	while (finished) {
+		chunk *next = finished->next;
+
+		if (parent >= 0 && r->shallow[parent].function) {
+			r->shallow[parent].nested_time   += finished->top_time;
+			r->shallow[parent].nested_memory += finished->top_memory;
+		}
+		chunk_free(finished);
+		finished = next;
+	}
+}
+
+static void process_shallow_line(reader *r, trace_line *parsed)
+{
+	shallow_frame *frame = &r->shallow[parsed->level];
+
+	if (parsed->type == 'S') {
+		if (parsed->level > 0 && r->shallow[parsed->level - 1].function) {
+			r->shallow[parsed->level - 1].nested_time += parsed->summary_time;
+		}
+		add_summary_to_function(
+			function_table_find(&r->functions, parsed->name, parsed->name_len),
+			parsed->summary_calls, parsed->summary_time
+		);
+		return;
+	}
+
+	if (parsed->type == '0') {
+		if (frame->function) {
+			frame->function->on_stack--;
+		}
+		frame->function      = function_table_find(&r->functions, parsed->name, parsed->name_len);
+		frame->time          = parsed->time;
+		frame->memory        = parsed->memory;
+		frame->nested_time   = 0;
+		frame->nested_memory = 0;
+		frame->function->on_stack++;
+		return;
+	}
+
+	if (!frame->function) {
+		return;
+	}
+
+	if (parsed->level > 0 && r->shallow[parsed->level - 1].function) {
+		r->shallow[parsed->level - 1].nested_time   += parsed->time - frame->time;
+		r->shallow[parsed->level - 1].nested_memory += parsed->memory - frame->memory;
+	}
+
+	add_to_function(
+		frame->function, parsed->time - frame->time, parsed->memory - frame->memory,
+		frame->nested_time, frame->nested_memory
+	);
+	frame->function = NULL;
+}
+
+/* Copies the fields up to and including the function name of entry lines
+ * into the chunk; the arguments are not needed and can be very large */
+static void append_line(reader *r, const char *line, const char *line_end, char type)
+{
+	chunk      *c = r->current;
+	const char *name = type == '0' ? find_field(line, line_end, NAME_FIELD) : NULL;
+	size_t      len;
+
+	if (name) {
+		const char *name_end = memchr(name, '\t', line_end - name);
+
+		if (name_end) {
+			line_end = name_end;
+		}
+	}
+	len = line_end - line;
+
+	if (c->len + len + 1 > c->size) {
+		c->size = (c->len + len + 1) * 2;
+		c->data = xrealloc(c->data, c->size);
+	}
+	memcpy(c->data + c->len, line, len);
+	c->len += len;
+	c->data[c->len++] = '\n';
+}
+
+/* Only the level and the line type are needed to decide where a line goes,
+ * the rest is parsed by whoever processes the line */
+static int peek_line(const char *line, const char *end, int *level, char *type)
+{
+	const char *p = line;
+	int         value = 0;
+
+	if (p == end || *p < '0' || *p > '9') {
+		return 0;
+	}
+	while (p < end && *p >= '0' && *p <= '9') {
+		value = value * 10 + (*p - '0');
+		p++;
+	}
+
+	p = find_field(p, end, 2);
+	if (!p || p == end || !IS_LINE_TYPE(*p)) {
+		return 0;
+	}
+
+	*level = value;
+	*type  = *p;
+
+	return 1;
+}
+
+static void handle_line(reader *r, const char *line, const char *line_end)
+{
+	analyser  *a = r->analyser;
+	trace_line parsed;
+	int        level;
+	char       type;
+
+	if (!peek_line(line, line_end, &level, &type)) {
+		return;
+	}
+
+	/* The split level is determined by the first entry: the children of
+	 * {main}, or the first traced call itself when tracing was started from
+	 * inside a function */
+	if (a->split_level < 0) {
+		if (type != '0' || !parse_line(line, line_end, &parsed)) {
+			return;
+		}
+		a->split_level = parsed.level;
+		if (parsed.name_len == 6 && strncmp(parsed.name, "{main}", 6) == 0) {
+			a->split_level++;
+		}
+		if (a->split_level >= MAX_STACK_DEPTH) {
+			a->split_level = MAX_STACK_DEPTH - 1;
+		}
+		r->shallow = xcalloc(a->split_level + 1, sizeof(shallow_frame));
+	}
+
+	if (level < a->split_level) {
+		if (parse_line(line, line_end, &parsed)) {
+			wait_for_chunks(r);
+			process_shallow_line(r, &parsed);
+		}
+		return;
+	}
+
+	if (level == a->split_level && type == '0' && r->current && r->current->len >= CHUNK_SIZE) {
+		submit_current_chunk(r);
+	}
+
+	if (!r->current) {
+		r->current = chunk_new(r);
+	}
+	append_line(r, line, line_end, type);
+}
+
+static int check_header(gzFile file, char *buffer, size_t *buffer_len)
+{
+	char   *second_line;
+	int     read;
+
+	read = gzread(file, buffer, READ_BLOCK_SIZE);
+	if (read <= 0) {
+		return 0;
+	}
+	*buffer_len = read;
+
+	if (read < 10 || strncmp(buffer, "Version: ", 9) != 0 || (buffer[9] != '2' && buffer[9] != '3')) {
+		return 0;
+	}
+
+	second_line = memchr(buffer, '\n', read);
+	if (!second_line) {
+		return 0;
+	}
+	second_line++;
+
+	if (
+		(size_t) (buffer + read - second_line) < 14 ||
+		strncmp(second_line, "File format: ", 13) != 0 ||
+		second_line[13] < '2' || second_line[13] > '4'
+	) {
+		return 0;
+	}
+
+	return 1;
+}
+
+static int parse_file(gzFile file, reader *r)
+{
+	char   *buffer = xmalloc(READ_BLOCK_SIZE);
+	size_t  buffer_size = READ_BLOCK_SIZE;
+	size_t  buffer_len = 0;
+	size_t  start = 0;
+
+	if (!check_header(file, buffer, &buffer_len)) {
+		free(buffer);
+		return 0;
+	}
+
+	for (;;) {
+		char  *line_end;
+		int    read;
+
+		while ((line_end = memchr(buffer + start, '\n', buffer_len - start)) != NULL) {
+			handle_line(r, buffer + start, line_end);
+			start = line_end - buffer + 1;
+		}
+
+		/* Move the incomplete last line to the start, and grow the buffer
+		 * when a single line does not fit */
+		memmove(buffer, buffer + start, buffer_len - start);
+		buffer_len -= start;
+		start = 0;
+
+		if (buffer_size - buffer_len < READ_BLOCK_SIZE / 2) {
+			buffer_size *= 2;
+			buffer = xrealloc(buffer, buffer_size);
+		}
+
+		read = gzread(file, buffer + buffer_len, buffer_size - buffer_len);
+		if (read < 0) {
+			int         errnum;
+			const char *message = gzerror(file, &errnum);
+
+			fprintf(stderr, "Error reading trace file: %s\n", errnum == Z_ERRNO ? strerror(errno) : message);
+			free(buffer);
+			return -1;
+		}
+		if (read == 0) {
+			break;
+		}
+		buffer_len += read;
+	}
+
+	if (buffer_len > 0) {
+		handle_line(r, buffer, buffer + buffer_len);
+	}
+
+	free(buffer);
+	return 1;
+}
+
+/* Output */
+static int sort_key;
+
+static double sort_value(const function_stats *f)
+{
+	switch (sort_key) {
+		case 0: return (double) f->calls;
+		case 1: return f->time_inclusive;
+		case 2: return (double) f->memory_inclusive;
+		case 3: return f->time_inclusive - f->time_children;
+		case 4: return (double) (f->memory_inclusive - f->memory_children);
+	}
+	return 0;
+}
+
+static int compare_functions(const void *a, const void *b)
+{
+	double value_a = sort_value(*(const function_stats **) a);
+	double value_b = sort_value(*(const function_stats **) b);
+
+	return value_a > value_b ? -1 : (value_a < value_b ? 1 : 0);
+}
+
+static void show_results(function_table *table, int elements)
+{
+	function_stats **functions = xmalloc(sizeof(function_stats *) * (table->used + 1));
+	size_t           count = 0;
+	size_t           max_len = 8;
+	size_t           i;
+
+	for (i = 0; i < table->size; i++) {
+		if (table->slots[i] && table->slots[i]->calls > 0) {
+			functions[count++] = table->slots[i];
+			if (strlen(table->slots[i]->name) > max_len) {
+				max_len = strlen(table->slots[i]->name);
+			}
+		}
+	}
+
+	qsort(functions, count, sizeof(function_stats *), compare_functions);
+
+	printf("Showing the %d most costly calls sorted by '%s'.\n\n", elements, sort_keys[sort_key]);
+
+	printf("        %*s        Inclusive        Own\n", (int) (max_len - 8), "");
+	printf("function%*s#calls  time     memory  time     memory\n", (int) (max_len - 8), "");
+	printf("--------");
+	for (i = 8; i < max_len; i++) {
+		putchar('-');
+	}
+	printf("----------------------------------------\n");
+
+	for (i = 0; i < count && (int) i < elements; i++) {
+		function_stats *f = functions[i];
+
+		printf(
+			"%-*s %5lld  %3.4f %8lld  %3.4f %8lld\n",
+			(int) max_len, f->name, f->calls,
+			f->time_inclusive, f->memory_inclusive,
+			f->time_inclusive - f->time_children, f->memory_inclusive - f->memory_children
+		);
+	}
+
+	free(functions);
+}
+
+int main(int argc, char *argv[])
+{
+	analyser  a;
+	reader    r;
+	worker   *workers;
+	gzFile    file;
+	long      threads = sysconf(_SC_NPROCESSORS_ONLN);
+	int       elements = 25;
+	int       opt;
+	int       i;
+	int       result;
+
+	while ((opt = getopt(argc, argv, "j:")) != -1) {
+		switch (opt) {
+			case 'j':
+				threads = atol(optarg);
+				break;
+			default:
+				show_usage();
+		}
+	}
+	if (threads < 1) {
+		threads = 1;
+	}
+	if (threads > MAX_THREADS) {
+		threads = MAX_THREADS;
+	}
+
+	if (argc - optind < 1 || argc - optind > 3) {
+		show_usage();
+	}
+
+	sort_key = 3;
+	if (argc - optind > 1) {
+		for (sort_key = 0; sort_keys[sort_key]; sort_key++) {
+			if (strcmp(sort_keys[sort_key], argv[optind + 1]) == 0) {
+				break;
+			}
+		}
+		if (!sort_keys[sort_key]) {
+			show_usage();
+		}
+	}
+	if (argc - optind > 2) {
+		elements = atoi(argv[optind + 2]);
+	}
+
+	file = gzopen(argv[optind], "rb");
+	if (!file) {
+		fprintf(stderr, "Can't open '%s'\n", argv[optind]);
+		return 1;
+	}
+	gzbuffer(file, READ_BLOCK_SIZE);
+
+	memset(&a, 0, sizeof(a));
+	a.split_level    = -1;
+	a.queue_capacity = threads * 2;
+	pthread_mutex_init(&a.lock, NULL);
+	pthread_cond_init(&a.queue_changed, NULL);
+	pthread_cond_init(&a.chunk_done, NULL);
+
+	memset(&r, 0, sizeof(r));
+	r.analyser = &a;
+	function_table_init(&r.functions);
+
+	workers = xcalloc(threads, sizeof(worker));
+	for (i = 0; i < threads; i++) {
+		workers[i].analyser = &a;
+		workers[i].stack    = xcalloc(MAX_STACK_DEPTH, sizeof(stack_frame));
+		function_table_init(&workers[i].functions);
+		if (pthread_create(&workers[i].thread, NULL, worker_run, &workers[i]) != 0) {
+			fprintf(stderr, "Can't create worker thread\n");
+			return 2;
+		}
+	}
+
+	result = parse_file(file, &r);
+	if (result > 0) {
+		wait_for_chunks(&r);
+	} else if (r.current) {
+		chunk_free(r.current);
+		r.current = NULL;
+	}
+	gzclose(file);
+
+	pthread_mutex_lock(&a.lock);
+	a.shutdown = 1;
+	pthread_cond_broadcast(&a.queue_changed);
+	pthread_mutex_unlock(&a.lock);
+
+	for (i = 0; i < threads; i++) {
+		pthread_join(workers[i].thread, NULL);
+		function_table_merge(&r.functions, &workers[i].functions);
+		function_table_destroy(&workers[i].functions);
+		free(workers[i].stack);
+	}
+	free(workers);
+
+	while (a.finished) {
+		chunk *next = a.finished->next;
+
+		chunk_free(a.finished);
+		a.finished = next;
+	}
+
+	if (result == 0) {
+		printf("\nThis file is not an Xdebug trace file made with format option '1' and version 2 to 4.\n");
+		show_usage();
+	}
+	if (result < 0) {
+		return 1;
+	}
+
+	show_results(&r.functions, elements);
+
+	function_table_destroy(&r.functions);
+	free(r.shallow);
+
+	return 0;
+}
@@ -55,6 +55,11 @@ function xdebug_debug_zval_stdout(string ...$varname) {}
 
 /* -----------------------------------------------------------------------*/
 
+/* Writes code coverage information to a file */
+function xdebug_dump_code_coverage(string $file, int $format = XDEBUG_CC_DUMP_BINARY): bool {}
+
+/* -----------------------------------------------------------------------*/
+
 /* Displays information about super globals */
 /** @return void */
 function xdebug_dump_superglobals() {}
@@ -66,6 +71,21 @@ function xdebug_get_code_coverage(): array {}
 
 /* -----------------------------------------------------------------------*/
 
+/* Returns which coverage context IDs executed each line */
+function xdebug_get_code_coverage_contexts(): array {}
+
+/* -----------------------------------------------------------------------*/
+
+/* Returns the code coverage information that changed since the last call */
+function xdebug_get_code_coverage_delta(): array {}
+
+/* -----------------------------------------------------------------------*/
+
+/* Returns line, branch, and path counts for each file and in total */
+function xdebug_get_code_coverage_summary(): array {}
+
+/* -----------------------------------------------------------------------*/
+
 /* Returns all collected error messages */
 /** @return void */
 function xdebug_get_collected_errors(bool $emptyList = false) {}
@@ -103,6 +123,11 @@ function xdebug_get_headers(): array {}
 
 /* -----------------------------------------------------------------------*/
 
+/* Returns the compile and execution costs of each included file */
+function xdebug_get_include_stats(): array {}
+
+/* -----------------------------------------------------------------------*/
+
 /* Returns information about monitored functions */
 function xdebug_get_monitored_functions(): array {}
 
@@ -119,6 +144,11 @@ function xdebug_get_stack_depth(): int {}
 
 /* -----------------------------------------------------------------------*/
 
+/* Returns the time spent in each category of internal and user functions */
+function xdebug_get_time_breakdown(): array {}
+
+/* -----------------------------------------------------------------------*/
+
 /* Returns the name of the function trace file */
 /** @return mixed */
 function xdebug_get_tracefile_name() {}
@@ -157,12 +187,27 @@ function xdebug_print_function_stack(string $message = "user triggered", int $op
 
 /* -----------------------------------------------------------------------*/
 
+/* Sets the ID that executed lines are attributed to */
+function xdebug_set_coverage_context(int $id): void {}
+
+/* -----------------------------------------------------------------------*/
+
 /* Set filter */
 /** @return void */
 function xdebug_set_filter(int $group, int $listType, array $configuration) {}
 
 /* -----------------------------------------------------------------------*/
 
+/* Begins a span in the function trace and profile */
+function xdebug_span_begin(string $label, array $attributes = []): void {}
+
+/* -----------------------------------------------------------------------*/
+
+/* Ends the last span begun by the calling function */
+function xdebug_span_end(): void {}
+
+/* -----------------------------------------------------------------------*/
+
 /* Starts code coverage */
 /** @return void */
 function xdebug_start_code_coverage(int $options = 0) {}
@@ -227,6 +272,11 @@ function xdebug_time_index(): float {}
 
 /* -----------------------------------------------------------------------*/
 
+/* Writes a marker into the function trace and profile */
+function xdebug_trace_marker(string $label, array $attributes = []): void {}
+
+/* -----------------------------------------------------------------------*/
+
 /* Displays detailed information about a variable */
 /** @return void */
 function xdebug_var_dump(mixed ...$variable) {}
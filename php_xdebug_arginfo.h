@@ -1,5 +1,5 @@
 /* This is a generated file, edit the .stub.php file instead.
- * Stub hash: abb3d6c16210384b6ac37292e3e46713125c8b18 */
+ * Stub hash: 4fcc1cf4f0609b5552326c595dadecfda4cf59f4 */
 
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_xdebug_break, 0, 0, _IS_BOOL, 0)
 ZEND_END_ARG_INFO()
@@ -24,12 +24,23 @@ ZEND_END_ARG_INFO()
 
 #define arginfo_xdebug_debug_zval_stdout arginfo_xdebug_debug_zval
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_xdebug_dump_code_coverage, 0, 1, _IS_BOOL, 0)
+	ZEND_ARG_TYPE_INFO(0, file, IS_STRING, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, format, IS_LONG, 0, "XDEBUG_CC_DUMP_BINARY")
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_xdebug_dump_superglobals, 0, 0, 0)
 ZEND_END_ARG_INFO()
 
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_xdebug_get_code_coverage, 0, 0, IS_ARRAY, 0)
 ZEND_END_ARG_INFO()
 
+#define arginfo_xdebug_get_code_coverage_contexts arginfo_xdebug_get_code_coverage
+
+#define arginfo_xdebug_get_code_coverage_delta arginfo_xdebug_get_code_coverage
+
+#define arginfo_xdebug_get_code_coverage_summary arginfo_xdebug_get_code_coverage
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_xdebug_get_collected_errors, 0, 0, 0)
 	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, emptyList, _IS_BOOL, 0, "false")
 ZEND_END_ARG_INFO()
@@ -49,12 +60,16 @@ ZEND_END_ARG_INFO()
 
 #define arginfo_xdebug_get_headers arginfo_xdebug_get_code_coverage
 
+#define arginfo_xdebug_get_include_stats arginfo_xdebug_get_code_coverage
+
 #define arginfo_xdebug_get_monitored_functions arginfo_xdebug_get_code_coverage
 
 #define arginfo_xdebug_get_profiler_filename arginfo_xdebug_dump_superglobals
 
 #define arginfo_xdebug_get_stack_depth arginfo_xdebug_get_function_count
 
+#define arginfo_xdebug_get_time_breakdown arginfo_xdebug_get_code_coverage
+
 #define arginfo_xdebug_get_tracefile_name arginfo_xdebug_dump_superglobals
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_xdebug_info, 0, 0, 0)
@@ -76,6 +91,10 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_xdebug_print_function_stack, 0, 0, 0)
 	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, options, IS_LONG, 0, "0")
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_xdebug_set_coverage_context, 0, 1, IS_VOID, 0)
+	ZEND_ARG_TYPE_INFO(0, id, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_xdebug_set_filter, 0, 0, 3)
 	ZEND_ARG_TYPE_INFO(0, group, IS_LONG, 0)
 	ZEND_ARG_TYPE_INFO(0, listType, IS_LONG, 0)
@@ -86,6 +105,14 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_xdebug_start_code_coverage, 0, 0, 0)
 	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, options, IS_LONG, 0, "0")
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_xdebug_span_begin, 0, 1, IS_VOID, 0)
+	ZEND_ARG_TYPE_INFO(0, label, IS_STRING, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, attributes, IS_ARRAY, 0, "[]")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_xdebug_span_end, 0, 0, IS_VOID, 0)
+ZEND_END_ARG_INFO()
+
 #define arginfo_xdebug_start_error_collection arginfo_xdebug_dump_superglobals
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_xdebug_start_function_monitor, 0, 0, 1)
@@ -116,6 +143,8 @@ ZEND_END_ARG_INFO()
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_xdebug_time_index, 0, 0, IS_DOUBLE, 0)
 ZEND_END_ARG_INFO()
 
+#define arginfo_xdebug_trace_marker arginfo_xdebug_span_begin
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_xdebug_var_dump, 0, 0, 0)
 	ZEND_ARG_VARIADIC_TYPE_INFO(0, variable, IS_MIXED, 0)
 ZEND_END_ARG_INFO()
@@ -130,8 +159,12 @@ ZEND_FUNCTION(xdebug_code_coverage_started);
 ZEND_FUNCTION(xdebug_connect_to_client);
 ZEND_FUNCTION(xdebug_debug_zval);
 ZEND_FUNCTION(xdebug_debug_zval_stdout);
+ZEND_FUNCTION(xdebug_dump_code_coverage);
 ZEND_FUNCTION(xdebug_dump_superglobals);
 ZEND_FUNCTION(xdebug_get_code_coverage);
+ZEND_FUNCTION(xdebug_get_code_coverage_contexts);
+ZEND_FUNCTION(xdebug_get_code_coverage_delta);
+ZEND_FUNCTION(xdebug_get_code_coverage_summary);
 ZEND_FUNCTION(xdebug_get_collected_errors);
 ZEND_FUNCTION(xdebug_get_function_count);
 ZEND_FUNCTION(xdebug_get_function_stack);
@@ -139,9 +172,11 @@ ZEND_FUNCTION(xdebug_get_gc_run_count);
 ZEND_FUNCTION(xdebug_get_gc_total_collected_roots);
 ZEND_FUNCTION(xdebug_get_gcstats_filename);
 ZEND_FUNCTION(xdebug_get_headers);
+ZEND_FUNCTION(xdebug_get_include_stats);
 ZEND_FUNCTION(xdebug_get_monitored_functions);
 ZEND_FUNCTION(xdebug_get_profiler_filename);
 ZEND_FUNCTION(xdebug_get_stack_depth);
+ZEND_FUNCTION(xdebug_get_time_breakdown);
 ZEND_FUNCTION(xdebug_get_tracefile_name);
 ZEND_FUNCTION(xdebug_info);
 ZEND_FUNCTION(xdebug_is_debugger_active);
@@ -149,7 +184,10 @@ ZEND_FUNCTION(xdebug_memory_usage);
 ZEND_FUNCTION(xdebug_notify);
 ZEND_FUNCTION(xdebug_peak_memory_usage);
 ZEND_FUNCTION(xdebug_print_function_stack);
+ZEND_FUNCTION(xdebug_set_coverage_context);
 ZEND_FUNCTION(xdebug_set_filter);
+ZEND_FUNCTION(xdebug_span_begin);
+ZEND_FUNCTION(xdebug_span_end);
 ZEND_FUNCTION(xdebug_start_code_coverage);
 ZEND_FUNCTION(xdebug_start_error_collection);
 ZEND_FUNCTION(xdebug_start_function_monitor);
@@ -161,6 +199,7 @@ ZEND_FUNCTION(xdebug_stop_function_monitor);
 ZEND_FUNCTION(xdebug_stop_gcstats);
 ZEND_FUNCTION(xdebug_stop_trace);
 ZEND_FUNCTION(xdebug_time_index);
+ZEND_FUNCTION(xdebug_trace_marker);
 ZEND_FUNCTION(xdebug_var_dump);
 
 
@@ -174,8 +213,12 @@ static const zend_function_entry ext_functions[] = {
 	ZEND_FE(xdebug_connect_to_client, arginfo_xdebug_connect_to_client)
 	ZEND_FE(xdebug_debug_zval, arginfo_xdebug_debug_zval)
 	ZEND_FE(xdebug_debug_zval_stdout, arginfo_xdebug_debug_zval_stdout)
+	ZEND_FE(xdebug_dump_code_coverage, arginfo_xdebug_dump_code_coverage)
 	ZEND_FE(xdebug_dump_superglobals, arginfo_xdebug_dump_superglobals)
 	ZEND_FE(xdebug_get_code_coverage, arginfo_xdebug_get_code_coverage)
+	ZEND_FE(xdebug_get_code_coverage_contexts, arginfo_xdebug_get_code_coverage_contexts)
+	ZEND_FE(xdebug_get_code_coverage_delta, arginfo_xdebug_get_code_coverage_delta)
+	ZEND_FE(xdebug_get_code_coverage_summary, arginfo_xdebug_get_code_coverage_summary)
 	ZEND_FE(xdebug_get_collected_errors, arginfo_xdebug_get_collected_errors)
 	ZEND_FE(xdebug_get_function_count, arginfo_xdebug_get_function_count)
 	ZEND_FE(xdebug_get_function_stack, arginfo_xdebug_get_function_stack)
@@ -183,9 +226,11 @@ static const zend_function_entry ext_functions[] = {
 	ZEND_FE(xdebug_get_gc_total_collected_roots, arginfo_xdebug_get_gc_total_collected_roots)
 	ZEND_FE(xdebug_get_gcstats_filename, arginfo_xdebug_get_gcstats_filename)
 	ZEND_FE(xdebug_get_headers, arginfo_xdebug_get_headers)
+	ZEND_FE(xdebug_get_include_stats, arginfo_xdebug_get_include_stats)
 	ZEND_FE(xdebug_get_monitored_functions, arginfo_xdebug_get_monitored_functions)
 	ZEND_FE(xdebug_get_profiler_filename, arginfo_xdebug_get_profiler_filename)
 	ZEND_FE(xdebug_get_stack_depth, arginfo_xdebug_get_stack_depth)
+	ZEND_FE(xdebug_get_time_breakdown, arginfo_xdebug_get_time_breakdown)
 	ZEND_FE(xdebug_get_tracefile_name, arginfo_xdebug_get_tracefile_name)
 	ZEND_FE(xdebug_info, arginfo_xdebug_info)
 	ZEND_FE(xdebug_is_debugger_active, arginfo_xdebug_is_debugger_active)
@@ -193,7 +238,10 @@ static const zend_function_entry ext_functions[] = {
 	ZEND_FE(xdebug_notify, arginfo_xdebug_notify)
 	ZEND_FE(xdebug_peak_memory_usage, arginfo_xdebug_peak_memory_usage)
 	ZEND_FE(xdebug_print_function_stack, arginfo_xdebug_print_function_stack)
+	ZEND_FE(xdebug_set_coverage_context, arginfo_xdebug_set_coverage_context)
 	ZEND_FE(xdebug_set_filter, arginfo_xdebug_set_filter)
+	ZEND_FE(xdebug_span_begin, arginfo_xdebug_span_begin)
+	ZEND_FE(xdebug_span_end, arginfo_xdebug_span_end)
 	ZEND_FE(xdebug_start_code_coverage, arginfo_xdebug_start_code_coverage)
 	ZEND_FE(xdebug_start_error_collection, arginfo_xdebug_start_error_collection)
 	ZEND_FE(xdebug_start_function_monitor, arginfo_xdebug_start_function_monitor)
@@ -205,6 +253,7 @@ static const zend_function_entry ext_functions[] = {
 	ZEND_FE(xdebug_stop_gcstats, arginfo_xdebug_stop_gcstats)
 	ZEND_FE(xdebug_stop_trace, arginfo_xdebug_stop_trace)
 	ZEND_FE(xdebug_time_index, arginfo_xdebug_time_index)
+	ZEND_FE(xdebug_trace_marker, arginfo_xdebug_trace_marker)
 	ZEND_FE(xdebug_var_dump, arginfo_xdebug_var_dump)
 	ZEND_FE_END
 };
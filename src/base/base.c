@@ -36,6 +36,7 @@
 
 #include "base.h"
 #include "filter.h"
+#include "span.h"
 #include "develop/develop.h"
 #include "develop/stack.h"
 #include "gcstats/gc_stats.h"
@@ -43,6 +44,7 @@
 #include "lib/log.h"
 #include "lib/var_export_line.h"
 #include "lib/var.h"
+#include "profiler/include_stats.h"
 #include "profiler/profiler.h"
 
 ZEND_EXTERN_MODULE_GLOBALS(xdebug)
@@ -59,6 +61,13 @@ static void xdebug_error_cb(int orig_type, const char *error_filename, const uin
 
 /* execution redirection functions */
 zend_op_array* (*old_compile_file)(zend_file_handle* file_handle, int type);
+#if PHP_VERSION_ID >= 80200
+zend_op_array* (*old_compile_string)(zend_string *source_string, const char *filename, zend_compile_position position);
+#elif PHP_VERSION_ID >= 80100
+zend_op_array* (*old_compile_string)(zend_string *source_string, const char *filename);
+#else
+zend_op_array* (*old_compile_string)(zval *source_string, char *filename);
+#endif
 static void (*xdebug_old_execute_ex)(zend_execute_data *execute_data);
 static void (*xdebug_old_execute_internal)(zend_execute_data *current_execute_data, zval *return_value);
 
@@ -79,6 +88,11 @@ PHP_FUNCTION(xdebug_pcntl_fork);
 static zend_op_array *xdebug_compile_file(zend_file_handle *file_handle, int type)
 {
 	zend_op_array *op_array;
+	uint64_t       compile_start = 0;
+
+	if (XDEBUG_MODE_IS(XDEBUG_MODE_PROFILING)) {
+		compile_start = xdebug_get_nanotime();
+	}
 
 	op_array = old_compile_file(file_handle, type);
 
@@ -86,6 +100,9 @@ static zend_op_array *xdebug_compile_file(zend_file_handle *file_handle, int typ
 		return NULL;
 	}
 
+	if (XDEBUG_MODE_IS(XDEBUG_MODE_PROFILING)) {
+		xdebug_profiler_compile_file(op_array, xdebug_get_nanotime() - compile_start);
+	}
 	xdebug_coverage_compile_file(op_array);
 	xdebug_debugger_compile_file(op_array);
 
@@ -93,6 +110,34 @@ static zend_op_array *xdebug_compile_file(zend_file_handle *file_handle, int typ
 }
 /* }}} */
 
+/* {{{ zend_op_array xdebug_compile_string (source_string, filename)
+ *    Eval'd code does not go through zend_compile_file */
+#if PHP_VERSION_ID >= 80200
+static zend_op_array *xdebug_compile_string(zend_string *source_string, const char *filename, zend_compile_position position)
+#elif PHP_VERSION_ID >= 80100
+static zend_op_array *xdebug_compile_string(zend_string *source_string, const char *filename)
+#else
+static zend_op_array *xdebug_compile_string(zval *source_string, char *filename)
+#endif
+{
+	zend_op_array *op_array;
+
+#if PHP_VERSION_ID >= 80200
+	op_array = old_compile_string(source_string, filename, position);
+#else
+	op_array = old_compile_string(source_string, filename);
+#endif
+
+	if (!op_array) {
+		return NULL;
+	}
+
+	xdebug_coverage_compile_file(op_array);
+
+	return op_array;
+}
+/* }}} */
+
 /* I don't like this API, but the function_stack_entry does not keep this as a
  * pointer, and hence we need two APIs for freeing :-S */
 void xdebug_func_dtor_by_ref(xdebug_func *elem)
@@ -121,6 +166,10 @@ static void function_stack_entry_dtor(void *elem)
 
 	xdebug_func_dtor_by_ref(&e->function);
 
+	if (e->function_name) {
+		xdfree(e->function_name);
+	}
+
 	if (e->filename) {
 		zend_string_release(e->filename);
 	}
@@ -148,6 +197,11 @@ static void function_stack_entry_dtor(void *elem)
 		xdebug_llist_destroy(e->profile.call_list, NULL);
 		e->profile.call_list = NULL;
 	}
+
+	if (e->trace_call_counts) {
+		xdebug_trace_call_counts_dtor(e->trace_call_counts);
+		e->trace_call_counts = NULL;
+	}
 }
 
 int xdebug_include_or_eval_handler(XDEBUG_OPCODE_HANDLER_ARGS)
@@ -654,10 +708,9 @@ function_stack_entry *xdebug_add_stack_frame(zend_execute_data *zdata, zend_op_a
 	tmp->memory = zend_memory_usage(0);
 	XG_BASE(prev_memory) = tmp->memory;
 
-	/* Only get the time when it is actually going to be used. Profiling is not
-	 * included, because it has its own points when it reads the current time.
-	 * */
-	if (XDEBUG_MODE_IS(XDEBUG_MODE_TRACING) || XDEBUG_MODE_IS(XDEBUG_MODE_DEVELOP)) {
+	/* Only get the time when it is actually going to be used. The profiler
+	 * uses the same start time as the trace handlers. */
+	if (XDEBUG_MODE_IS(XDEBUG_MODE_TRACING) || XDEBUG_MODE_IS(XDEBUG_MODE_DEVELOP) || XDEBUG_MODE_IS(XDEBUG_MODE_PROFILING)) {
 		tmp->nanotime = xdebug_get_nanotime();
 	} else {
 		tmp->nanotime = 0;
@@ -709,6 +762,16 @@ function_stack_entry *xdebug_add_stack_frame(zend_execute_data *zdata, zend_op_a
 
 /** Function interceptors and dispatchers to modules ***********************/
 
+/* Reads the clock and memory usage once when a frame ends, for all of the
+ * profiler and the trace handlers */
+static void xdebug_fse_set_end(function_stack_entry *fse)
+{
+	if (XDEBUG_MODE_IS(XDEBUG_MODE_TRACING) || XDEBUG_MODE_IS(XDEBUG_MODE_PROFILING)) {
+		fse->nanotime_end = xdebug_get_nanotime();
+		fse->memory_end   = zend_memory_usage(0);
+	}
+}
+
 static void xdebug_execute_user_code_begin(zend_execute_data *execute_data)
 {
 	zend_op_array     *op_array = &(execute_data->func->op_array);
@@ -809,6 +872,11 @@ static void xdebug_execute_user_code_end(zend_execute_data *execute_data, zval *
 	function_stack_entry *fse;
 
 	fse = XDEBUG_VECTOR_TAIL(XG_BASE(stack));
+	xdebug_fse_set_end(fse);
+
+	if (XG_BASE(spans) && XDEBUG_LLIST_COUNT(XG_BASE(spans))) {
+		xdebug_span_frame_end(fse);
+	}
 
 	if (XDEBUG_MODE_IS(XDEBUG_MODE_PROFILING)) {
 		xdebug_profiler_execute_ex_end(fse);
@@ -987,6 +1055,11 @@ static void xdebug_execute_internal_end(zend_execute_data *current_execute_data,
 	/* Re-acquire the tail as nested calls through
 	 * xdebug_old_execute_internal() might have reallocated the vector */
 	fse = XDEBUG_VECTOR_TAIL(XG_BASE(stack));
+	xdebug_fse_set_end(fse);
+
+	if (XG_BASE(spans) && XDEBUG_LLIST_COUNT(XG_BASE(spans))) {
+		xdebug_span_frame_end(fse);
+	}
 
 	if (XDEBUG_MODE_IS(XDEBUG_MODE_PROFILING)) {
 		xdebug_profiler_execute_internal_end(fse);
@@ -1241,6 +1314,10 @@ static void xdebug_fiber_switch_observer(zend_fiber_context *from, zend_fiber_co
 	xdebug_vector *current_stack;
 
 	if (from->status == ZEND_FIBER_STATUS_DEAD) {
+		if (XDEBUG_MODE_IS(XDEBUG_MODE_TRACING)) {
+			xdebug_tracing_fiber_destroyed(from);
+		}
+
 		if (XG_DBG(context).next_stack == find_stack_for_fiber(from)) {
 			XG_DBG(context).next_stack = NULL;
 		}
@@ -1369,6 +1446,7 @@ void xdebug_base_mshutdown()
 {
 	/* Reset compile, execute and error callbacks */
 	zend_compile_file = old_compile_file;
+	zend_compile_string = old_compile_string;
 	zend_execute_ex = xdebug_old_execute_ex;
 	zend_execute_internal = xdebug_old_execute_internal;
 	zend_error_cb = xdebug_old_error_cb;
@@ -1384,6 +1462,9 @@ void xdebug_base_post_startup()
 {
 	old_compile_file = zend_compile_file;
 	zend_compile_file = xdebug_compile_file;
+
+	old_compile_string = zend_compile_string;
+	zend_compile_string = xdebug_compile_string;
 }
 
 void xdebug_base_rinit()
@@ -1428,9 +1509,10 @@ void xdebug_base_rinit()
 	XG_BASE(filter_type_code_coverage) = XDEBUG_FILTER_NONE;
 	XG_BASE(filter_type_stack)         = XDEBUG_FILTER_NONE;
 	XG_BASE(filter_type_tracing)       = XDEBUG_FILTER_NONE;
-	XG_BASE(filters_code_coverage)     = xdebug_llist_alloc(xdebug_llist_string_dtor);
-	XG_BASE(filters_stack)             = xdebug_llist_alloc(xdebug_llist_string_dtor);
-	XG_BASE(filters_tracing)           = xdebug_llist_alloc(xdebug_llist_string_dtor);
+	XG_BASE(filters_code_coverage)     = xdebug_filter_trie_alloc();
+	XG_BASE(filters_stack)             = xdebug_filter_trie_alloc();
+	XG_BASE(filters_tracing)           = xdebug_filter_trie_alloc();
+	XG_BASE(filter_cache)              = xdcalloc(XDEBUG_FILTER_CACHE_SIZE, sizeof(xdebug_filter_cache_entry));
 
 	xdebug_base_overloaded_functions_setup();
 
@@ -1459,13 +1541,21 @@ void xdebug_base_post_deactivate()
 		xdfree(XG_BASE(last_exception_trace));
 		XG_BASE(last_exception_trace) = NULL;
 	}
+	if (XG_BASE(spans)) {
+		xdebug_llist_destroy(XG_BASE(spans), NULL);
+		XG_BASE(spans) = NULL;
+	}
+	XG_BASE(last_span_id) = 0;
 
 	/* filters */
-	xdebug_llist_destroy(XG_BASE(filters_code_coverage), NULL);
-	xdebug_llist_destroy(XG_BASE(filters_stack), NULL);
-	xdebug_llist_destroy(XG_BASE(filters_tracing), NULL);
+	xdebug_filter_trie_free(XG_BASE(filters_code_coverage));
+	xdebug_filter_trie_free(XG_BASE(filters_stack));
+	xdebug_filter_trie_free(XG_BASE(filters_tracing));
 	XG_BASE(filters_tracing) = NULL;
+	XG_BASE(filters_stack) = NULL;
 	XG_BASE(filters_code_coverage) = NULL;
+	xdfree(XG_BASE(filter_cache));
+	XG_BASE(filter_cache) = NULL;
 
 	xdebug_base_overloaded_functions_restore();
 }
@@ -26,6 +26,18 @@
 typedef void (WINAPI *WIN_PRECISE_TIME_FUNC)(LPFILETIME);
 #endif
 
+/* Compiled filter list, see filter.c */
+typedef struct _xdebug_filter_trie xdebug_filter_trie;
+
+#define XDEBUG_FILTER_CACHE_SIZE 256
+
+typedef struct _xdebug_filter_cache_entry {
+	zend_string   *filename;
+	zend_string   *object_class;
+	unsigned char  filtered_stack;
+	unsigned char  filtered_tracing;
+} xdebug_filter_cache_entry;
+
 typedef struct _xdebug_nanotime_context {
 	uint64_t start_abs;
 	uint64_t last_abs;
@@ -61,6 +73,10 @@ typedef struct _xdebug_base_globals_t {
 	zend_string  *last_eval_statement;
 	char         *last_exception_trace;
 
+	/* Open spans, see xdebug_span_begin() */
+	xdebug_llist *spans;
+	unsigned int  last_span_id;
+
 	/* in-execution checking */
 	zend_bool  in_execution;
 	zend_bool  in_var_serialisation;
@@ -72,9 +88,10 @@ typedef struct _xdebug_base_globals_t {
 	zend_long     filter_type_code_coverage;
 	zend_long     filter_type_stack;
 	zend_long     filter_type_tracing;
-	xdebug_llist *filters_code_coverage;
-	xdebug_llist *filters_stack;
-	xdebug_llist *filters_tracing;
+	xdebug_filter_trie *filters_code_coverage;
+	xdebug_filter_trie *filters_stack;
+	xdebug_filter_trie *filters_tracing;
+	xdebug_filter_cache_entry *filter_cache;
 
 	/* PHP versions */
 	const char   *php_version_compile_time;
@@ -58,117 +58,200 @@ void xdebug_filter_register_constants(INIT_FUNC_ARGS)
 	REGISTER_LONG_CONSTANT("XDEBUG_NAMESPACE_EXCLUDE", XDEBUG_NAMESPACE_EXCLUDE, CONST_CS | CONST_PERSISTENT);
 }
 
-static int xdebug_filter_match_path_include(function_stack_entry *fse, unsigned char *filtered_flag, char *filter)
+/* Filter lists are compiled into a trie of lower cased characters, so that
+ * finding out whether any of the filters is a prefix of a file or class name
+ * only needs a single walk over that name, however many filters there are. */
+typedef struct _xdebug_filter_trie_node {
+	unsigned char                    c;
+	unsigned char                    terminal;
+	struct _xdebug_filter_trie_node *children;
+	struct _xdebug_filter_trie_node *next_sibling;
+} xdebug_filter_trie_node;
+
+struct _xdebug_filter_trie {
+	xdebug_filter_trie_node root;          /* root.terminal means "an empty filter" */
+	int                     match_no_class; /* empty namespace filter, matches functions without a class */
+};
+
+static void filter_trie_node_free(xdebug_filter_trie_node *node)
 {
-	if (fse->filename && strncasecmp(filter, ZSTR_VAL(fse->filename), strlen(filter)) == 0) {
-		*filtered_flag = 0;
-		return 1;
+	xdebug_filter_trie_node *next;
+
+	while (node) {
+		next = node->next_sibling;
+		filter_trie_node_free(node->children);
+		xdfree(node);
+		node = next;
 	}
-	return 0;
 }
 
-static int xdebug_filter_match_path_exclude(function_stack_entry *fse, unsigned char *filtered_flag, char *filter)
+xdebug_filter_trie *xdebug_filter_trie_alloc(void)
 {
-	if (fse->filename && strncasecmp(filter, ZSTR_VAL(fse->filename), strlen(filter)) == 0) {
-		*filtered_flag = 1;
-		return 1;
-	}
-	return 0;
+	return xdcalloc(1, sizeof(xdebug_filter_trie));
 }
 
-static int xdebug_filter_match_namespace_include(function_stack_entry *fse, unsigned char *filtered_flag, char *filter)
+static void filter_trie_empty(xdebug_filter_trie *trie)
 {
-	if (!fse->function.object_class && filter[0] == '\0') {
-		*filtered_flag = 0;
-		return 1;
-	}
-	if (fse->function.object_class && filter[0] != '\0' && strncasecmp(filter, ZSTR_VAL(fse->function.object_class), strlen(filter)) == 0) {
-		*filtered_flag = 0;
-		return 1;
+	filter_trie_node_free(trie->root.children);
+	memset(trie, 0, sizeof(xdebug_filter_trie));
+}
+
+void xdebug_filter_trie_free(xdebug_filter_trie *trie)
+{
+	if (!trie) {
+		return;
 	}
-	return 0;
+
+	filter_trie_empty(trie);
+	xdfree(trie);
 }
 
-static int xdebug_filter_match_namespace_exclude(function_stack_entry *fse, unsigned char *filtered_flag, char *filter)
+static void filter_trie_add(xdebug_filter_trie *trie, const char *filter, size_t filter_len)
 {
-	if (!fse->function.object_class && filter[0] == '\0') {
-		*filtered_flag = 1;
-		return 1;
+	xdebug_filter_trie_node *node = &trie->root;
+	size_t                   i;
+
+	for (i = 0; i < filter_len; i++) {
+		unsigned char            c = zend_tolower_ascii((unsigned char) filter[i]);
+		xdebug_filter_trie_node *child;
+
+		for (child = node->children; child; child = child->next_sibling) {
+			if (child->c == c) {
+				break;
+			}
+		}
+
+		if (!child) {
+			child = xdcalloc(1, sizeof(xdebug_filter_trie_node));
+			child->c = c;
+			child->next_sibling = node->children;
+			node->children = child;
+		}
+
+		node = child;
 	}
-	if (fse->function.object_class && filter[0] != '\0' && strncasecmp(filter, ZSTR_VAL(fse->function.object_class), strlen(filter)) == 0) {
-		*filtered_flag = 1;
-		return 1;
+
+	node->terminal = 1;
+}
+
+/* Returns whether one of the filters is a (case insensitive) prefix of 'name' */
+static int filter_trie_match_prefix(xdebug_filter_trie *trie, zend_string *name)
+{
+	xdebug_filter_trie_node *node = &trie->root;
+	size_t                   i;
+
+	for (i = 0; !node->terminal; i++) {
+		unsigned char c;
+
+		if (i == ZSTR_LEN(name)) {
+			return 0;
+		}
+
+		c = zend_tolower_ascii((unsigned char) ZSTR_VAL(name)[i]);
+		node = node->children;
+		while (node && node->c != c) {
+			node = node->next_sibling;
+		}
+
+		if (!node) {
+			return 0;
+		}
 	}
-	return 0;
+
+	return 1;
 }
 
+static int filter_trie_match_namespace(xdebug_filter_trie *trie, function_stack_entry *fse)
+{
+	/* An empty namespace filter only matches functions without a class */
+	if (!fse->function.object_class) {
+		return trie->match_no_class;
+	}
+
+	return filter_trie_match_prefix(trie, fse->function.object_class);
+}
 
-void xdebug_filter_run_internal(function_stack_entry *fse, int group, unsigned char *filtered_flag, int type, xdebug_llist *filters)
+void xdebug_filter_run_internal(function_stack_entry *fse, int group, unsigned char *filtered_flag, int type, xdebug_filter_trie *filters)
 {
-	xdebug_llist_element *le;
-	unsigned int          k;
-	function_stack_entry  tmp_fse;
-	int (*filter_to_run)(function_stack_entry *fse, unsigned char *filtered_flag, char *filter);
+	zend_string *filename = fse->filename;
 
-	le = XDEBUG_LLIST_HEAD(filters);
+	if (group == XDEBUG_FILTER_CODE_COVERAGE && fse->function.type & XFUNC_INCLUDES) {
+		filename = fse->include_filename;
+	}
 
 	switch (type) {
 		case XDEBUG_PATH_INCLUDE:
-			*filtered_flag = 1;
-			if (group == XDEBUG_FILTER_CODE_COVERAGE && fse->function.type & XFUNC_INCLUDES) {
-				tmp_fse.filename = fse->include_filename;
-				fse = &tmp_fse;
-			}
-
-			filter_to_run = xdebug_filter_match_path_include;
+			*filtered_flag = !(filename && filter_trie_match_prefix(filters, filename));
 			break;
 
 		case XDEBUG_PATH_EXCLUDE:
-			*filtered_flag = 0;
-			if (group == XDEBUG_FILTER_CODE_COVERAGE && fse->function.type & XFUNC_INCLUDES) {
-				tmp_fse.filename = fse->include_filename;
-				fse = &tmp_fse;
-			}
-
-			filter_to_run = xdebug_filter_match_path_exclude;
+			*filtered_flag = !!(filename && filter_trie_match_prefix(filters, filename));
 			break;
 
 		case XDEBUG_NAMESPACE_INCLUDE:
-			*filtered_flag = 1;
-			filter_to_run = xdebug_filter_match_namespace_include;
+			*filtered_flag = !filter_trie_match_namespace(filters, fse);
 			break;
 
 		case XDEBUG_NAMESPACE_EXCLUDE:
-			*filtered_flag = 0;
-			filter_to_run = xdebug_filter_match_namespace_exclude;
+			*filtered_flag = !!filter_trie_match_namespace(filters, fse);
 			break;
 
 		default:
 			/* Logically can't happen, but compilers can't detect that */
 			return;
 	}
+}
 
-	for (k = 0; k < filters->size; k++, le = XDEBUG_LLIST_NEXT(le)) {
-		char *filter = XDEBUG_LLIST_VALP(le);
+/* The stack and tracing verdicts only depend on the file name and class, so
+ * they are cached for each pair. Only interned strings are used as keys, as
+ * these can not be freed, and their address reused, during the request. */
+static xdebug_filter_cache_entry *filter_cache_find_slot(function_stack_entry *fse)
+{
+	zend_ulong slot;
 
-		/* If the filter matched once, we're done */
-		if (filter_to_run(fse, filtered_flag, filter)) {
-			break;
-		}
+	if (!XG_BASE(filter_cache) || !fse->filename || !ZSTR_IS_INTERNED(fse->filename)) {
+		return NULL;
 	}
+	if (fse->function.object_class && !ZSTR_IS_INTERNED(fse->function.object_class)) {
+		return NULL;
+	}
+
+	slot = (((zend_uintptr_t) fse->filename) >> 3) ^ (((zend_uintptr_t) fse->function.object_class) >> 5);
+
+	return &XG_BASE(filter_cache)[slot % XDEBUG_FILTER_CACHE_SIZE];
 }
 
 void xdebug_filter_run(function_stack_entry *fse)
 {
+	xdebug_filter_cache_entry *cache_entry;
+
 	fse->filtered_stack   = 0;
 	fse->filtered_tracing = 0;
 
+	if (XG_BASE(filter_type_stack) == XDEBUG_FILTER_NONE && XG_BASE(filter_type_tracing) == XDEBUG_FILTER_NONE) {
+		return;
+	}
+
+	cache_entry = filter_cache_find_slot(fse);
+	if (cache_entry && cache_entry->filename == fse->filename && cache_entry->object_class == fse->function.object_class) {
+		fse->filtered_stack   = cache_entry->filtered_stack;
+		fse->filtered_tracing = cache_entry->filtered_tracing;
+		return;
+	}
+
 	if (XG_BASE(filter_type_stack) != XDEBUG_FILTER_NONE) {
 		xdebug_filter_run_internal(fse, XDEBUG_FILTER_STACK, &fse->filtered_stack, XG_BASE(filter_type_stack), XG_BASE(filters_stack));
 	}
 	if (XG_BASE(filter_type_tracing) != XDEBUG_FILTER_NONE) {
 		xdebug_filter_run_internal(fse, XDEBUG_FILTER_TRACING, &fse->filtered_tracing, XG_BASE(filter_type_tracing), XG_BASE(filters_tracing));
 	}
+
+	if (cache_entry) {
+		cache_entry->filename         = fse->filename;
+		cache_entry->object_class     = fse->function.object_class;
+		cache_entry->filtered_stack   = fse->filtered_stack;
+		cache_entry->filtered_tracing = fse->filtered_tracing;
+	}
 }
 
 /* {{{ proto void xdebug_set_filter(int group, int type, array filters)
@@ -177,7 +260,7 @@ PHP_FUNCTION(xdebug_set_filter)
 {
 	zend_long      filter_group;
 	zend_long      filter_type;
-	xdebug_llist **filter_list;
+	xdebug_filter_trie *filter_list;
 	zval          *filters, *item;
 
 	if (zend_parse_parameters(ZEND_NUM_ARGS(), "lla", &filter_group, &filter_type, &filters) == FAILURE) {
@@ -191,7 +274,7 @@ PHP_FUNCTION(xdebug_set_filter)
 				return;
 			}
 
-			filter_list = &XG_BASE(filters_code_coverage);
+			filter_list = XG_BASE(filters_code_coverage);
 			XG_BASE(filter_type_code_coverage) = XDEBUG_FILTER_NONE;
 			if (filter_type == XDEBUG_NAMESPACE_INCLUDE || filter_type == XDEBUG_NAMESPACE_EXCLUDE) {
 				php_error(E_WARNING, "The code coverage filter (XDEBUG_FILTER_CODE_COVERAGE) only supports the XDEBUG_PATH_INCLUDE, XDEBUG_PATH_EXCLUDE, and XDEBUG_FILTER_NONE filter types");
@@ -205,7 +288,7 @@ PHP_FUNCTION(xdebug_set_filter)
 				return;
 			}
 
-			filter_list = &XG_BASE(filters_stack);
+			filter_list = XG_BASE(filters_stack);
 			XG_BASE(filter_type_stack) = XDEBUG_FILTER_NONE;
 			break;
 
@@ -215,7 +298,7 @@ PHP_FUNCTION(xdebug_set_filter)
 				return;
 			}
 
-			filter_list = &XG_BASE(filters_tracing);
+			filter_list = XG_BASE(filters_tracing);
 			XG_BASE(filter_type_tracing) = XDEBUG_FILTER_NONE;
 			break;
 
@@ -249,7 +332,12 @@ PHP_FUNCTION(xdebug_set_filter)
 		return;
 	}
 
-	xdebug_llist_empty(*filter_list, NULL);
+	filter_trie_empty(filter_list);
+
+	/* Cached verdicts are no longer valid */
+	if (XG_BASE(filter_cache)) {
+		memset(XG_BASE(filter_cache), 0, XDEBUG_FILTER_CACHE_SIZE * sizeof(xdebug_filter_cache_entry));
+	}
 
 	if (filter_type == XDEBUG_FILTER_NONE) {
 		return;
@@ -257,11 +345,21 @@ PHP_FUNCTION(xdebug_set_filter)
 
 	ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(filters), item) {
 		zend_string *str = zval_get_string(item);
-		char *filter = ZSTR_VAL(str);
+		char        *filter = ZSTR_VAL(str);
+		size_t       filter_len = ZSTR_LEN(str);
 
 		/* If we are a namespace filter, and the filter name starts with \, we
 		 * need to strip the \ from the matcher */
-		xdebug_llist_insert_next(*filter_list, XDEBUG_LLIST_TAIL(*filter_list), xdstrdup(filter[0] == '\\' ? &filter[1] : filter));
+		if (filter[0] == '\\') {
+			filter++;
+			filter_len--;
+		}
+
+		if (filter_len == 0 && (filter_type == XDEBUG_NAMESPACE_INCLUDE || filter_type == XDEBUG_NAMESPACE_EXCLUDE)) {
+			filter_list->match_no_class = 1;
+		} else {
+			filter_trie_add(filter_list, filter, filter_len);
+		}
 
 		zend_string_release(str);
 	} ZEND_HASH_FOREACH_END();
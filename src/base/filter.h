@@ -24,7 +24,10 @@ int xdebug_is_top_stack_frame_filtered(int filter_type);
 void xdebug_filter_register_constants(INIT_FUNC_ARGS);
 void xdebug_filter_run(function_stack_entry *fse);
 void xdebug_filter_run_code_coverage(zend_op_array *op_array);
-void xdebug_filter_run_internal(function_stack_entry *fse, int group, unsigned char *filtered_flag, int type, xdebug_llist *filters);
+void xdebug_filter_run_internal(function_stack_entry *fse, int group, unsigned char *filtered_flag, int type, xdebug_filter_trie *filters);
+
+xdebug_filter_trie *xdebug_filter_trie_alloc(void);
+void xdebug_filter_trie_free(xdebug_filter_trie *trie);
 
 #define XDEBUG_FILTER_NONE           0x000
 #define XDEBUG_FILTER_CODE_COVERAGE  0x100
@@ -0,0 +1,206 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#include "php_xdebug.h"
+
+#include "span.h"
+
+#include "lib/lib.h"
+#include "lib/mm.h"
+#include "profiler/profiler.h"
+#include "tracing/tracing.h"
+
+ZEND_EXTERN_MODULE_GLOBALS(xdebug)
+
+/* Markers and spans only do something while a trace file or profile is being
+ * written, and return before parsing their arguments otherwise */
+static bool span_output_active(void)
+{
+	return xdebug_get_trace_filename() != NULL || xdebug_get_profiler_filename() != NULL;
+}
+
+void xdebug_span_dtor(void *dummy, void *elem)
+{
+	xdebug_span *span = (xdebug_span*) elem;
+
+	zend_string_release(span->label);
+	zend_string_release(span->filename);
+	if (span->profile_call_list) {
+		xdebug_llist_destroy(span->profile_call_list, NULL);
+	}
+	xdfree(span);
+}
+
+static void span_end(function_stack_entry *owner, xdebug_llist_element *le)
+{
+	xdebug_span *span = XDEBUG_LLIST_VALP(le);
+
+	if (span->traced) {
+		xdebug_trace_marker marker;
+
+		marker.type           = XDEBUG_TRACE_SPAN_END;
+		marker.id             = span->id;
+		marker.label          = span->label;
+		marker.attributes     = NULL;
+		marker.nanotime       = xdebug_get_nanotime();
+		marker.nanotime_begin = span->nanotime;
+
+		xdebug_tracing_marker(owner, &marker);
+	}
+
+	if (span->profiled) {
+		xdebug_profiler_span_end(owner, span);
+	}
+
+	xdebug_llist_remove(XG_BASE(spans), le, NULL);
+}
+
+/* Ends the spans that the frame 'fse' left open, innermost first */
+void xdebug_span_frame_end(function_stack_entry *fse)
+{
+	xdebug_llist_element *le, *prev;
+
+	for (le = XDEBUG_LLIST_TAIL(XG_BASE(spans)); le != NULL; le = prev) {
+		xdebug_span *span = XDEBUG_LLIST_VALP(le);
+
+		prev = XDEBUG_LLIST_PREV(le);
+
+		if (span->owner_function_nr == fse->function_nr) {
+			span_end(fse, le);
+		}
+	}
+}
+
+PHP_FUNCTION(xdebug_trace_marker)
+{
+	zend_string          *label;
+	HashTable            *attributes = NULL;
+	zval                  attributes_zv;
+	function_stack_entry *fse, *owner;
+	xdebug_trace_marker   marker;
+
+	if (!span_output_active()) {
+		return;
+	}
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "S|h", &label, &attributes) == FAILURE) {
+		return;
+	}
+
+	/* Frame 0 is this function itself, with the location of the call */
+	fse = xdebug_get_stack_frame(0);
+	owner = xdebug_get_stack_frame(1);
+	if (!fse || !owner) {
+		return;
+	}
+
+	marker.type           = XDEBUG_TRACE_MARKER;
+	marker.id             = 0;
+	marker.label          = label;
+	marker.attributes     = NULL;
+	marker.nanotime       = xdebug_get_nanotime();
+	marker.nanotime_begin = 0;
+
+	if (attributes && zend_hash_num_elements(attributes) > 0) {
+		ZVAL_ARR(&attributes_zv, attributes);
+		marker.attributes = &attributes_zv;
+	}
+
+	xdebug_tracing_marker(owner, &marker);
+	xdebug_profiler_marker(owner, label, fse->filename, fse->lineno);
+}
+
+PHP_FUNCTION(xdebug_span_begin)
+{
+	zend_string          *label;
+	HashTable            *attributes = NULL;
+	zval                  attributes_zv;
+	function_stack_entry *fse, *owner;
+	xdebug_span          *span;
+	xdebug_trace_marker   marker;
+
+	if (!span_output_active()) {
+		return;
+	}
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "S|h", &label, &attributes) == FAILURE) {
+		return;
+	}
+
+	fse = xdebug_get_stack_frame(0);
+	owner = xdebug_get_stack_frame(1);
+	if (!fse || !owner) {
+		return;
+	}
+
+	if (!XG_BASE(spans)) {
+		XG_BASE(spans) = xdebug_llist_alloc(xdebug_span_dtor);
+	}
+
+	span = xdcalloc(1, sizeof(xdebug_span));
+	span->label             = zend_string_copy(label);
+	span->id                = ++XG_BASE(last_span_id);
+	span->owner_function_nr = owner->function_nr;
+	span->filename          = zend_string_copy(fse->filename);
+	span->lineno            = fse->lineno;
+	span->nanotime          = xdebug_get_nanotime();
+	span->memory            = zend_memory_usage(0);
+
+	xdebug_llist_insert_next(XG_BASE(spans), XDEBUG_LLIST_TAIL(XG_BASE(spans)), span);
+
+	marker.type           = XDEBUG_TRACE_SPAN_BEGIN;
+	marker.id             = span->id;
+	marker.label          = label;
+	marker.attributes     = NULL;
+	marker.nanotime       = span->nanotime;
+	marker.nanotime_begin = span->nanotime;
+
+	if (attributes && zend_hash_num_elements(attributes) > 0) {
+		ZVAL_ARR(&attributes_zv, attributes);
+		marker.attributes = &attributes_zv;
+	}
+
+	span->traced = xdebug_tracing_marker(owner, &marker);
+	xdebug_profiler_span_begin(owner, span);
+}
+
+/* Ends the innermost span that was begun by the calling function */
+PHP_FUNCTION(xdebug_span_end)
+{
+	function_stack_entry *owner;
+	xdebug_llist_element *le;
+
+	if (!XG_BASE(spans)) {
+		return;
+	}
+
+	if (zend_parse_parameters_none() == FAILURE) {
+		return;
+	}
+
+	owner = xdebug_get_stack_frame(1);
+	if (!owner) {
+		return;
+	}
+
+	for (le = XDEBUG_LLIST_TAIL(XG_BASE(spans)); le != NULL; le = XDEBUG_LLIST_PREV(le)) {
+		xdebug_span *span = XDEBUG_LLIST_VALP(le);
+
+		if (span->owner_function_nr == owner->function_nr) {
+			span_end(owner, le);
+			return;
+		}
+	}
+}
@@ -0,0 +1,49 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#ifndef XDEBUG_SPAN_H
+#define XDEBUG_SPAN_H
+
+#include "lib/php-header.h"
+#include "php_xdebug.h"
+#include "lib/llist.h"
+
+/* A span begun with xdebug_span_begin(). Spans belong to the frame that
+ * began them, and are ended when that frame ends at the latest. */
+typedef struct _xdebug_span {
+	zend_string  *label;
+	unsigned int  id;
+	unsigned int  owner_function_nr;
+	zend_string  *filename;
+	int           lineno;
+	uint64_t      nanotime;
+	long          memory;
+
+	/* Whether the begin record went into the trace file */
+	bool          traced;
+
+	/* The owner's profiler call list while the span is open */
+	bool          profiled;
+	xdebug_llist *profile_call_list;
+} xdebug_span;
+
+void xdebug_span_dtor(void *dummy, void *elem);
+void xdebug_span_frame_end(function_stack_entry *fse);
+
+PHP_FUNCTION(xdebug_span_begin);
+PHP_FUNCTION(xdebug_span_end);
+PHP_FUNCTION(xdebug_trace_marker);
+
+#endif
@@ -0,0 +1,657 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#include "lib/php-header.h"
+
+#include "php_xdebug.h"
+#include "analysis_cache.h"
+#include "code_coverage_private.h"
+
+#include "lib/compat.h"
+#include "lib/hash.h"
+#include "lib/log.h"
+#include "lib/mm.h"
+#include "lib/str.h"
+
+ZEND_EXTERN_MODULE_GLOBALS(xdebug)
+
+/* Prefill results are cached per source file, in one file in
+ * xdebug.coverage_cache_dir for each combination of coverage options. A cache
+ * file is only used if it was written by the same PHP and Xdebug versions, for
+ * the same size and modification time of the source file. Within a file, each
+ * op_array is found by its name, its first line, and a checksum over its
+ * opcodes, as opcache can change the opcodes of otherwise identical code. */
+
+#define XDEBUG_COVERAGE_CACHE_MAGIC   "XDCC"
+#define XDEBUG_COVERAGE_CACHE_FORMAT  2
+
+#define XDEBUG_COVERAGE_CACHE_OPT_DEAD_CODE    1
+#define XDEBUG_COVERAGE_CACHE_OPT_BRANCH_CHECK 2
+
+typedef struct _xdebug_coverage_cache_record {
+	const char *data;
+	size_t      length;
+	bool        owned; /* Otherwise it points into the cache file's contents */
+} xdebug_coverage_cache_record;
+
+typedef struct _xdebug_coverage_cache_file {
+	zend_string *filename;
+	char        *cache_path;
+	uint64_t     mtime;
+	uint64_t     size;
+	bool         usable; /* Whether the source file exists on disk at all */
+	bool         dirty;
+	char        *contents;
+	xdebug_hash *records;
+} xdebug_coverage_cache_file;
+
+typedef struct _cache_reader {
+	const char *p;
+	const char *end;
+	bool        ok;
+} cache_reader;
+
+void xdebug_coverage_cache_lines_add(xdebug_coverage_cache_lines *lines, unsigned int lineno, int deadcode)
+{
+	if (lines->count == lines->size) {
+		lines->size = lines->size ? lines->size * 2 : 32;
+		lines->lines = xdrealloc(lines->lines, lines->size * sizeof(uint32_t));
+	}
+
+	lines->lines[lines->count++] = (lineno << 1) | (deadcode ? 1 : 0);
+}
+
+void xdebug_coverage_cache_lines_dtor(xdebug_coverage_cache_lines *lines)
+{
+	if (lines->lines) {
+		xdfree(lines->lines);
+	}
+	lines->lines = NULL;
+	lines->count = 0;
+	lines->size = 0;
+}
+
+bool xdebug_coverage_cache_enabled(void)
+{
+	return XINI_COV(cache_dir) && XINI_COV(cache_dir)[0] != '\0';
+}
+
+static uint32_t cache_options(void)
+{
+	uint32_t options = 0;
+
+	if (XG_COV(code_coverage_dead_code_analysis)) {
+		options |= XDEBUG_COVERAGE_CACHE_OPT_DEAD_CODE;
+	}
+	if (XG_COV(code_coverage_branch_check)) {
+		options |= XDEBUG_COVERAGE_CACHE_OPT_BRANCH_CHECK;
+	}
+
+	return options;
+}
+
+/* Writing and reading of the binary format, which is only ever read back by
+ * the same build, so numbers are stored in native byte order */
+static void put_u32(xdebug_str *out, uint32_t value)
+{
+	xdebug_str_addl(out, (char*) &value, sizeof(value), 0);
+}
+
+static void put_u64(xdebug_str *out, uint64_t value)
+{
+	xdebug_str_addl(out, (char*) &value, sizeof(value), 0);
+}
+
+static void put_bytes(xdebug_str *out, const char *data, size_t length)
+{
+	put_u32(out, (uint32_t) length);
+	xdebug_str_addl(out, data, length, 0);
+}
+
+static void read_raw(cache_reader *reader, void *dest, size_t length)
+{
+	if (!reader->ok || (size_t) (reader->end - reader->p) < length) {
+		reader->ok = false;
+		memset(dest, 0, length);
+		return;
+	}
+
+	memcpy(dest, reader->p, length);
+	reader->p += length;
+}
+
+static uint32_t read_u32(cache_reader *reader)
+{
+	uint32_t value;
+
+	read_raw(reader, &value, sizeof(value));
+	return value;
+}
+
+static uint64_t read_u64(cache_reader *reader)
+{
+	uint64_t value;
+
+	read_raw(reader, &value, sizeof(value));
+	return value;
+}
+
+static const char *read_bytes(cache_reader *reader, size_t *length)
+{
+	const char *data;
+
+	*length = read_u32(reader);
+	if (!reader->ok || (size_t) (reader->end - reader->p) < *length) {
+		reader->ok = false;
+		return NULL;
+	}
+
+	data = reader->p;
+	reader->p += *length;
+
+	return data;
+}
+
+static bool read_bytes_equal(cache_reader *reader, const char *expected, size_t expected_length)
+{
+	size_t      length;
+	const char *data = read_bytes(reader, &length);
+
+	return reader->ok && length == expected_length && memcmp(data, expected, length) == 0;
+}
+
+static void cache_record_dtor(void *elem)
+{
+	xdebug_coverage_cache_record *record = (xdebug_coverage_cache_record*) elem;
+
+	if (record->owned) {
+		xdfree((char*) record->data);
+	}
+	xdfree(record);
+}
+
+static void cache_file_dtor(void *elem)
+{
+	xdebug_coverage_cache_file *file = (xdebug_coverage_cache_file*) elem;
+
+	xdebug_hash_destroy(file->records);
+	if (file->contents) {
+		xdfree(file->contents);
+	}
+	if (file->cache_path) {
+		xdfree(file->cache_path);
+	}
+	zend_string_release(file->filename);
+	xdfree(file);
+}
+
+static void add_record(xdebug_coverage_cache_file *file, const char *key, size_t key_length, const char *data, size_t length, bool owned)
+{
+	xdebug_coverage_cache_record *record = xdmalloc(sizeof(xdebug_coverage_cache_record));
+
+	record->data = data;
+	record->length = length;
+	record->owned = owned;
+
+	xdebug_hash_update(file->records, key, key_length, record);
+}
+
+/* Reads the cache file, and keeps its contents if everything in its header
+ * matches. The records then point straight into the contents. */
+static void load_cache_file(xdebug_coverage_cache_file *file)
+{
+	FILE        *fp;
+	zend_stat_t  buf;
+	cache_reader reader;
+	uint32_t     count, i;
+
+	fp = VCWD_FOPEN(file->cache_path, "rb");
+	if (!fp) {
+		return;
+	}
+
+	if (zend_fstat(fileno(fp), &buf) != 0 || buf.st_size == 0) {
+		fclose(fp);
+		return;
+	}
+
+	file->contents = xdmalloc(buf.st_size);
+	if (fread(file->contents, 1, buf.st_size, fp) != (size_t) buf.st_size) {
+		fclose(fp);
+		xdfree(file->contents);
+		file->contents = NULL;
+		return;
+	}
+	fclose(fp);
+
+	reader.p = file->contents;
+	reader.end = file->contents + buf.st_size;
+	reader.ok = true;
+
+	if (
+		(size_t) buf.st_size < strlen(XDEBUG_COVERAGE_CACHE_MAGIC) ||
+		memcmp(reader.p, XDEBUG_COVERAGE_CACHE_MAGIC, strlen(XDEBUG_COVERAGE_CACHE_MAGIC)) != 0
+	) {
+		goto invalid;
+	}
+	reader.p += strlen(XDEBUG_COVERAGE_CACHE_MAGIC);
+
+	if (
+		read_u32(&reader) != XDEBUG_COVERAGE_CACHE_FORMAT ||
+		!read_bytes_equal(&reader, XDEBUG_VERSION, strlen(XDEBUG_VERSION)) ||
+		!read_bytes_equal(&reader, PHP_VERSION, strlen(PHP_VERSION)) ||
+		!read_bytes_equal(&reader, ZSTR_VAL(file->filename), ZSTR_LEN(file->filename)) ||
+		read_u64(&reader) != file->mtime ||
+		read_u64(&reader) != file->size ||
+		read_u32(&reader) != cache_options() ||
+		read_u64(&reader) != (uint64_t) XINI_COV(max_paths)
+	) {
+		goto invalid;
+	}
+
+	count = read_u32(&reader);
+	for (i = 0; i < count && reader.ok; i++) {
+		size_t      key_length, length;
+		const char *key = read_bytes(&reader, &key_length);
+		const char *data = read_bytes(&reader, &length);
+
+		if (reader.ok) {
+			add_record(file, key, key_length, data, length, false);
+		}
+	}
+
+	if (reader.ok) {
+		return;
+	}
+
+invalid:
+	/* Records could already point into the contents */
+	xdebug_hash_destroy(file->records);
+	file->records = xdebug_hash_alloc(64, cache_record_dtor);
+	xdfree(file->contents);
+	file->contents = NULL;
+}
+
+static xdebug_coverage_cache_file *find_cache_file(zend_string *filename)
+{
+	xdebug_coverage_cache_file *file;
+	zend_stat_t                 buf;
+
+	if (!XG_COV(analysis_cache)) {
+		XG_COV(analysis_cache) = xdebug_hash_alloc(64, cache_file_dtor);
+	}
+
+	if (xdebug_hash_find(XG_COV(analysis_cache), ZSTR_VAL(filename), ZSTR_LEN(filename), (void*) &file)) {
+		return file;
+	}
+
+	file = xdcalloc(1, sizeof(xdebug_coverage_cache_file));
+	file->filename = zend_string_copy(filename);
+	file->records = xdebug_hash_alloc(64, cache_record_dtor);
+
+	/* Code from eval() and friends has no file to check against */
+	if (VCWD_STAT(ZSTR_VAL(filename), &buf) == 0) {
+		file->usable = true;
+		file->mtime = (uint64_t) buf.st_mtime;
+		file->size = (uint64_t) buf.st_size;
+		file->cache_path = xdebug_sprintf(
+			"%s%cxdebug-cc-%016" PRIx64 "-%u.bin",
+			XINI_COV(cache_dir), DEFAULT_SLASH, (uint64_t) zend_inline_hash_func(ZSTR_VAL(filename), ZSTR_LEN(filename)), cache_options()
+		);
+
+		load_cache_file(file);
+	}
+
+	xdebug_hash_add(XG_COV(analysis_cache), ZSTR_VAL(filename), ZSTR_LEN(filename), file);
+
+	return file;
+}
+
+/* FNV-1a over the parts of each opcode that do not depend on where the
+ * engine's handlers or this process' memory happen to be */
+static uint64_t op_array_checksum(zend_op_array *op_array)
+{
+	uint64_t     hash = UINT64_C(0xcbf29ce484222325);
+	unsigned int i;
+
+#define XDEBUG_CHECKSUM_ADD(v) do { uint32_t _v = (uint32_t) (v); size_t _i; \
+		for (_i = 0; _i < sizeof(_v); _i++) { hash ^= (_v >> (_i * 8)) & 0xff; hash *= UINT64_C(0x100000001b3); } \
+	} while (0)
+
+	XDEBUG_CHECKSUM_ADD(op_array->last);
+	for (i = 0; i < op_array->last; i++) {
+		zend_op *opline = &op_array->opcodes[i];
+
+		XDEBUG_CHECKSUM_ADD(opline->opcode);
+		XDEBUG_CHECKSUM_ADD(opline->op1_type);
+		XDEBUG_CHECKSUM_ADD(opline->op2_type);
+		XDEBUG_CHECKSUM_ADD(opline->result_type);
+		XDEBUG_CHECKSUM_ADD(opline->extended_value);
+		XDEBUG_CHECKSUM_ADD(opline->lineno);
+		XDEBUG_CHECKSUM_ADD(opline->op1.num);
+		XDEBUG_CHECKSUM_ADD(opline->op2.num);
+	}
+
+#undef XDEBUG_CHECKSUM_ADD
+
+	return hash;
+}
+
+static char *record_key(zend_op_array *op_array, const char *function_name)
+{
+	return xdebug_sprintf("%s@%u:%016" PRIx64, function_name, op_array->line_start, op_array_checksum(op_array));
+}
+
+static void put_set(xdebug_str *out, xdebug_set *set)
+{
+	put_bytes(out, (char*) set->setinfo, (set->size + 7) / 8);
+}
+
+static void read_set(cache_reader *reader, xdebug_set *set)
+{
+	size_t      length;
+	const char *data = read_bytes(reader, &length);
+
+	if (!reader->ok || length != (set->size + 7) / 8) {
+		reader->ok = false;
+		return;
+	}
+
+	memcpy(set->setinfo, data, length);
+}
+
+static bool branch_is_empty(xdebug_branch *branch)
+{
+	return branch->start_lineno == 0 && branch->end_lineno == 0 && branch->end_op == 0 && branch->outs_count == 0;
+}
+
+/* Only the fields that the analysis sets are written, and not the hit
+ * information that is collected while running */
+static void put_branch(xdebug_str *out, xdebug_branch *branch)
+{
+	unsigned int i;
+
+	put_u32(out, branch->start_lineno);
+	put_u32(out, branch->end_lineno);
+	put_u32(out, branch->end_op);
+	put_u32(out, branch->outs_count);
+	for (i = 0; i < branch->outs_count; i++) {
+		put_u32(out, (uint32_t) branch->outs[i]);
+	}
+}
+
+/* The cache directory can be shared, so everything that is later used as an
+ * index into the branches is checked against the number of opcodes */
+static void read_branch(cache_reader *reader, xdebug_branch *branch, uint32_t size)
+{
+	unsigned int i;
+
+	branch->start_lineno = read_u32(reader);
+	branch->end_lineno = read_u32(reader);
+	branch->end_op = read_u32(reader);
+	branch->outs_count = read_u32(reader);
+
+	if (!reader->ok || branch->end_op >= size || branch->outs_count > XDEBUG_BRANCH_MAX_OUTS) {
+		reader->ok = false;
+		return;
+	}
+
+	for (i = 0; i < branch->outs_count && reader->ok; i++) {
+		uint32_t out = read_u32(reader);
+
+		if (out >= size && out != XDEBUG_JMP_EXIT) {
+			reader->ok = false;
+			return;
+		}
+		branch->outs[i] = (int) out;
+	}
+}
+
+static void put_branch_info(xdebug_str *out, xdebug_branch_info *branch_info)
+{
+	unsigned int i, j, count = 0;
+
+	put_u32(out, branch_info->size);
+	put_set(out, branch_info->entry_points);
+	put_set(out, branch_info->starts);
+	put_set(out, branch_info->ends);
+
+	/* Only few opcodes start a branch, so the rest of the entries are empty */
+	for (i = 0; i < branch_info->size; i++) {
+		if (!branch_is_empty(&branch_info->branches[i])) {
+			count++;
+		}
+	}
+	put_u32(out, count);
+	for (i = 0; i < branch_info->size; i++) {
+		if (!branch_is_empty(&branch_info->branches[i])) {
+			put_u32(out, i);
+			put_branch(out, &branch_info->branches[i]);
+		}
+	}
+
+	put_u32(out, branch_info->path_info.truncated);
+	put_u32(out, branch_info->path_info.paths_count);
+	for (i = 0; i < branch_info->path_info.paths_count; i++) {
+		xdebug_path *path = branch_info->path_info.paths[i];
+
+		put_u32(out, path->elements_count);
+		for (j = 0; j < path->elements_count; j++) {
+			put_u32(out, path->elements[j]);
+		}
+	}
+}
+
+static xdebug_branch_info *read_branch_info(cache_reader *reader)
+{
+	xdebug_branch_info *branch_info;
+	uint32_t            size, count, i, j;
+
+	size = read_u32(reader);
+	if (!reader->ok) {
+		return NULL;
+	}
+
+	branch_info = xdebug_branch_info_create(size);
+	read_set(reader, branch_info->entry_points);
+	read_set(reader, branch_info->starts);
+	read_set(reader, branch_info->ends);
+
+	count = read_u32(reader);
+	for (i = 0; i < count && reader->ok; i++) {
+		uint32_t nr = read_u32(reader);
+
+		if (nr >= size) {
+			reader->ok = false;
+			break;
+		}
+		read_branch(reader, &branch_info->branches[nr], size);
+	}
+
+	branch_info->path_info.truncated = read_u32(reader) ? 1 : 0;
+	count = read_u32(reader);
+	for (i = 0; i < count && reader->ok; i++) {
+		xdebug_path *path = xdebug_path_new(NULL);
+		uint32_t     elements_count = read_u32(reader);
+
+		for (j = 0; j < elements_count && reader->ok; j++) {
+			uint32_t element = read_u32(reader);
+
+			if (element >= size) {
+				reader->ok = false;
+				break;
+			}
+			xdebug_path_add(path, element);
+		}
+		xdebug_path_info_add_path(&branch_info->path_info, path);
+	}
+
+	if (!reader->ok) {
+		xdebug_branch_info_free(branch_info);
+		return NULL;
+	}
+
+	xdebug_branch_info_build_path_hash(branch_info);
+
+	return branch_info;
+}
+
+/* Returns the cached prefill results for 'op_array', with 'lines' and
+ * 'branch_info' for the caller to own */
+bool xdebug_coverage_cache_find(zend_op_array *op_array, const char *function_name, xdebug_coverage_cache_lines *lines, xdebug_branch_info **branch_info)
+{
+	xdebug_coverage_cache_file   *file = find_cache_file(op_array->filename);
+	xdebug_coverage_cache_record *record;
+	cache_reader                  reader;
+	char                         *key;
+	uint32_t                      count, i;
+	bool                          found;
+
+	*branch_info = NULL;
+
+	if (!file->usable) {
+		return false;
+	}
+
+	key = record_key(op_array, function_name);
+	found = xdebug_hash_find(file->records, key, strlen(key), (void*) &record);
+	xdfree(key);
+
+	if (!found) {
+		return false;
+	}
+
+	reader.p = record->data;
+	reader.end = record->data + record->length;
+	reader.ok = true;
+
+	count = read_u32(&reader);
+	for (i = 0; i < count && reader.ok; i++) {
+		uint32_t line = read_u32(&reader);
+
+		xdebug_coverage_cache_lines_add(lines, line >> 1, line & 1);
+	}
+
+	if (read_u32(&reader) && reader.ok) {
+		*branch_info = read_branch_info(&reader);
+		if (!*branch_info) {
+			reader.ok = false;
+		}
+	}
+
+	if (!reader.ok) {
+		xdebug_coverage_cache_lines_dtor(lines);
+		return false;
+	}
+
+	return true;
+}
+
+void xdebug_coverage_cache_add(zend_op_array *op_array, const char *function_name, xdebug_coverage_cache_lines *lines, xdebug_branch_info *branch_info)
+{
+	xdebug_coverage_cache_file *file = find_cache_file(op_array->filename);
+	xdebug_str                  record = XDEBUG_STR_INITIALIZER;
+	char                       *key;
+	size_t                      i;
+
+	if (!file->usable) {
+		return;
+	}
+
+	put_u32(&record, lines->count);
+	for (i = 0; i < lines->count; i++) {
+		put_u32(&record, lines->lines[i]);
+	}
+
+	put_u32(&record, branch_info ? 1 : 0);
+	if (branch_info) {
+		put_branch_info(&record, branch_info);
+	}
+
+	key = record_key(op_array, function_name);
+	add_record(file, key, strlen(key), record.d, record.l, true);
+	xdfree(key);
+
+	file->dirty = true;
+}
+
+static void put_record(void *user, xdebug_hash_element *he)
+{
+	xdebug_str                   *out = (xdebug_str*) user;
+	xdebug_coverage_cache_record *record = (xdebug_coverage_cache_record*) he->ptr;
+
+	put_bytes(out, he->key.value.str.val, he->key.value.str.len);
+	put_bytes(out, record->data, record->length);
+}
+
+/* Writes to a temporary file first, so that other processes never read a
+ * cache file that is only partially written */
+static void write_cache_file(void *user, xdebug_hash_element *he)
+{
+	xdebug_coverage_cache_file *file = (xdebug_coverage_cache_file*) he->ptr;
+	xdebug_str                  out = XDEBUG_STR_INITIALIZER;
+	char                       *tmp_path;
+	FILE                       *fp;
+	bool                        written;
+
+	if (!file->usable || !file->dirty) {
+		return;
+	}
+
+	xdebug_str_addl(&out, XDEBUG_COVERAGE_CACHE_MAGIC, strlen(XDEBUG_COVERAGE_CACHE_MAGIC), 0);
+	put_u32(&out, XDEBUG_COVERAGE_CACHE_FORMAT);
+	put_bytes(&out, XDEBUG_VERSION, strlen(XDEBUG_VERSION));
+	put_bytes(&out, PHP_VERSION, strlen(PHP_VERSION));
+	put_bytes(&out, ZSTR_VAL(file->filename), ZSTR_LEN(file->filename));
+	put_u64(&out, file->mtime);
+	put_u64(&out, file->size);
+	put_u32(&out, cache_options());
+	put_u64(&out, (uint64_t) XINI_COV(max_paths));
+	put_u32(&out, file->records->size);
+	xdebug_hash_apply(file->records, (void*) &out, put_record);
+
+	tmp_path = xdebug_sprintf("%s.%ld.tmp", file->cache_path, (long) xdebug_get_pid());
+
+	fp = VCWD_FOPEN(tmp_path, "wb");
+	if (!fp) {
+		xdebug_log_ex(XLOG_CHAN_COVERAGE, XLOG_WARN, "CACHE", "Can not write coverage analysis cache file '%s': %s.", tmp_path, strerror(errno));
+		xdfree(tmp_path);
+		xdebug_str_destroy(&out);
+		return;
+	}
+
+	written = fwrite(out.d, 1, out.l, fp) == out.l;
+	written = fclose(fp) == 0 && written;
+
+	if (!written || VCWD_RENAME(tmp_path, file->cache_path) != 0) {
+		VCWD_UNLINK(tmp_path);
+	}
+
+	xdfree(tmp_path);
+	xdebug_str_destroy(&out);
+}
+
+/* Writes all the cache files that got new records, and forgets about them */
+void xdebug_coverage_cache_flush(void)
+{
+	if (!XG_COV(analysis_cache)) {
+		return;
+	}
+
+	xdebug_hash_apply(XG_COV(analysis_cache), NULL, write_cache_file);
+
+	xdebug_hash_destroy(XG_COV(analysis_cache));
+	XG_COV(analysis_cache) = NULL;
+}
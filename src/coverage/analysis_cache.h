@@ -0,0 +1,41 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#ifndef __XDEBUG_COVERAGE_ANALYSIS_CACHE_H__
+#define __XDEBUG_COVERAGE_ANALYSIS_CACHE_H__
+
+#include "lib/php-header.h"
+
+#include "branch_info.h"
+
+/* The executable lines that prefill found in one op_array. Each entry is the
+ * line number shifted left by one, with the lowest bit set for dead code. */
+typedef struct _xdebug_coverage_cache_lines {
+	size_t    count;
+	size_t    size;
+	uint32_t *lines;
+} xdebug_coverage_cache_lines;
+
+#define XDEBUG_COVERAGE_CACHE_LINES_INITIALIZER { 0, 0, NULL }
+
+void xdebug_coverage_cache_lines_add(xdebug_coverage_cache_lines *lines, unsigned int lineno, int deadcode);
+void xdebug_coverage_cache_lines_dtor(xdebug_coverage_cache_lines *lines);
+
+bool xdebug_coverage_cache_enabled(void);
+bool xdebug_coverage_cache_find(zend_op_array *op_array, const char *function_name, xdebug_coverage_cache_lines *lines, xdebug_branch_info **branch_info);
+void xdebug_coverage_cache_add(zend_op_array *op_array, const char *function_name, xdebug_coverage_cache_lines *lines, xdebug_branch_info *branch_info);
+void xdebug_coverage_cache_flush(void);
+
+#endif
@@ -33,6 +33,8 @@ xdebug_branch_info *xdebug_branch_info_create(unsigned int size)
 	tmp->path_info.paths_count = 0;
 	tmp->path_info.paths_size  = 0;
 	tmp->path_info.paths = NULL;
+	tmp->path_info.path_hash = NULL;
+	tmp->path_info.truncated = 0;
 
 	return tmp;
 }
@@ -46,7 +48,9 @@ void xdebug_branch_info_free(xdebug_branch_info *branch_info)
 		free(branch_info->path_info.paths[i]);
 	}
 	free(branch_info->path_info.paths);
-	xdebug_hash_destroy(branch_info->path_info.path_hash);
+	if (branch_info->path_info.path_hash) {
+		xdebug_hash_destroy(branch_info->path_info.path_hash);
+	}
 	free(branch_info->branches);
 	xdebug_set_free(branch_info->entry_points);
 	xdebug_set_free(branch_info->starts);
@@ -147,7 +151,7 @@ void xdebug_branch_post_process(zend_op_array *opa, xdebug_branch_info *branch_i
 	}
 }
 
-static void xdebug_path_add(xdebug_path *path, unsigned int nr)
+void xdebug_path_add(xdebug_path *path, unsigned int nr)
 {
 	if (!path) {
 		return;
@@ -160,7 +164,7 @@ static void xdebug_path_add(xdebug_path *path, unsigned int nr)
 	path->elements_count++;
 }
 
-static void xdebug_path_info_add_path(xdebug_path_info *path_info, xdebug_path *path)
+void xdebug_path_info_add_path(xdebug_path_info *path_info, xdebug_path *path)
 {
 	if (path_info->paths_count == path_info->paths_size) {
 		path_info->paths_size += 32;
@@ -249,7 +253,10 @@ static void xdebug_branch_find_path(unsigned int nr, xdebug_branch_info *branch_
 	int found = 0;
 	size_t i = 0;
 
-	if (branch_info->path_info.paths_count > 4095) {
+	/* Each sequential branch doubles the number of paths, so stop looking
+	 * once the configured maximum has been found */
+	if (XINI_COV(max_paths) > 0 && branch_info->path_info.paths_count >= (unsigned int) XINI_COV(max_paths)) {
+		branch_info->path_info.truncated = 1;
 		return;
 	}
 
@@ -283,6 +290,7 @@ xdebug_path_info *xdebug_path_info_ctor(void)
 	tmp->paths_size = 0;
 	tmp->paths = NULL;
 	tmp->path_hash = NULL;
+	tmp->truncated = 0;
 
 	return tmp;
 }
@@ -325,6 +333,13 @@ void xdebug_branch_find_paths(xdebug_branch_info *branch_info)
 		}
 	}
 
+	xdebug_branch_info_build_path_hash(branch_info);
+}
+
+void xdebug_branch_info_build_path_hash(xdebug_branch_info *branch_info)
+{
+	unsigned int i;
+
 	branch_info->path_info.path_hash = xdebug_hash_alloc(128, NULL);
 
 	for (i = 0; i < branch_info->path_info.paths_count; i++) {
@@ -335,6 +350,99 @@ void xdebug_branch_find_paths(xdebug_branch_info *branch_info)
 	}
 }
 
+#define XDEBUG_VISITED_BRANCHES_INITIAL_SIZE 2048
+
+xdebug_visited_branches *xdebug_visited_branches_ctor(void)
+{
+	xdebug_visited_branches *visited = xdmalloc(sizeof(xdebug_visited_branches));
+
+	visited->count = 0;
+	visited->size = XDEBUG_VISITED_BRANCHES_INITIAL_SIZE;
+	visited->entries = xdcalloc(visited->size, sizeof(xdebug_visited_branch));
+
+	return visited;
+}
+
+void xdebug_visited_branches_dtor(xdebug_visited_branches *visited)
+{
+	if (!visited) {
+		return;
+	}
+
+	xdfree(visited->entries);
+	xdfree(visited);
+}
+
+static size_t visited_branch_slot(uint64_t branches, unsigned int function_nr, size_t size)
+{
+	uint64_t h = branches ^ ((uint64_t) function_nr * 0x9E3779B97F4A7C15ULL);
+
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= h >> 33;
+
+	return (size_t) h & (size - 1);
+}
+
+static void visited_branches_grow(xdebug_visited_branches *visited)
+{
+	xdebug_visited_branch *old_entries = visited->entries;
+	size_t                 old_size = visited->size;
+	size_t                 i;
+
+	visited->size *= 2;
+	visited->entries = xdcalloc(visited->size, sizeof(xdebug_visited_branch));
+
+	for (i = 0; i < old_size; i++) {
+		size_t slot;
+
+		if (!old_entries[i].branches) {
+			continue;
+		}
+
+		slot = visited_branch_slot(old_entries[i].branches, old_entries[i].function_nr, visited->size);
+		while (visited->entries[slot].branches) {
+			slot = (slot + 1) & (visited->size - 1);
+		}
+		visited->entries[slot] = old_entries[i];
+	}
+
+	xdfree(old_entries);
+}
+
+/* Adds the tuple to the set, and returns whether it was not in there yet */
+static bool visited_branches_add(xdebug_visited_branches *visited, long opcode_nr, int last_branch_nr, unsigned int function_nr)
+{
+	/* The top bit marks the slot as used, as both numbers can be 0 */
+	uint64_t branches = (UINT64_C(1) << 63) | ((uint64_t) (uint32_t) opcode_nr << 32) | (uint32_t) (last_branch_nr + 1);
+	size_t   slot;
+
+	slot = visited_branch_slot(branches, function_nr, visited->size);
+	while (visited->entries[slot].branches) {
+		if (visited->entries[slot].branches == branches && visited->entries[slot].function_nr == function_nr) {
+			return false;
+		}
+		slot = (slot + 1) & (visited->size - 1);
+	}
+
+	visited->entries[slot].branches = branches;
+	visited->entries[slot].function_nr = function_nr;
+	visited->count++;
+
+	/* Keep the load factor under a half, so that probe sequences stay short */
+	if (visited->count * 2 > visited->size) {
+		visited_branches_grow(visited);
+	}
+
+	return true;
+}
+
+static void mark_function_dirty(xdebug_coverage_file *file, xdebug_coverage_function *function)
+{
+	function->dirty = 1;
+	xdebug_coverage_file_mark_dirty(file);
+}
+
 void xdebug_branch_info_mark_reached(zend_string *filename, char *function_name, zend_op_array *op_array, long opcode_nr)
 {
 	xdebug_coverage_file *file;
@@ -372,30 +480,31 @@ void xdebug_branch_info_mark_reached(zend_string *filename, char *function_name,
 	}
 
 	if (xdebug_set_in(branch_info->starts, opcode_nr)) {
-		char *key;
-		void *dummy;
 		function_stack_entry *tail_fse = XDEBUG_VECTOR_TAIL(XG_BASE(stack));
 
 		/* Mark out for previous branch, if one is set */
 		if (XG_COV(branches).last_branch_nr[XDEBUG_VECTOR_COUNT(XG_BASE(stack))] != -1) {
-			size_t i = 0;
-
-			for (i = 0; i < branch_info->branches[XG_COV(branches).last_branch_nr[XDEBUG_VECTOR_COUNT(XG_BASE(stack))]].outs_count; i++) {
-				if (branch_info->branches[XG_COV(branches).last_branch_nr[XDEBUG_VECTOR_COUNT(XG_BASE(stack))]].outs[i] == opcode_nr) {
-					branch_info->branches[XG_COV(branches).last_branch_nr[XDEBUG_VECTOR_COUNT(XG_BASE(stack))]].outs_hit[i] = 1;
+			xdebug_branch *last_branch = &branch_info->branches[XG_COV(branches).last_branch_nr[XDEBUG_VECTOR_COUNT(XG_BASE(stack))]];
+			size_t         i = 0;
+
+			for (i = 0; i < last_branch->outs_count; i++) {
+				if (last_branch->outs[i] == opcode_nr && !last_branch->outs_hit[i]) {
+					last_branch->outs_hit[i] = 1;
+					last_branch->dirty = 1;
+					mark_function_dirty(file, function);
 				}
 			}
 		}
 
-		key = xdebug_sprintf("%d:%d:%d", opcode_nr, XG_COV(branches).last_branch_nr[XDEBUG_VECTOR_COUNT(XG_BASE(stack))], tail_fse->function_nr);
-
-		if (!xdebug_hash_find(XG_COV(visited_branches), key, strlen(key), (void*) &dummy)) {
+		if (visited_branches_add(XG_COV(visited_branches), opcode_nr, XG_COV(branches).last_branch_nr[XDEBUG_VECTOR_COUNT(XG_BASE(stack))], tail_fse->function_nr)) {
 			xdebug_path_add(XG_COV(paths_stack)->paths[XDEBUG_VECTOR_COUNT(XG_BASE(stack))], opcode_nr);
-			xdebug_hash_add(XG_COV(visited_branches), key, strlen(key), NULL);
 		}
-		xdfree(key);
 
-		branch_info->branches[opcode_nr].hit = 1;
+		if (!branch_info->branches[opcode_nr].hit) {
+			branch_info->branches[opcode_nr].hit = 1;
+			branch_info->branches[opcode_nr].dirty = 1;
+			mark_function_dirty(file, function);
+		}
 
 		XG_COV(branches).last_branch_nr[XDEBUG_VECTOR_COUNT(XG_BASE(stack))] = opcode_nr;
 	}
@@ -434,7 +543,11 @@ void xdebug_branch_info_mark_end_of_function_reached(zend_string *filename, char
 	if (!xdebug_hash_find(branch_info->path_info.path_hash, key, key_len, (void *) &path)) {
 		return;
 	}
-	path->hit = 1;
+	if (!path->hit) {
+		path->hit = 1;
+		path->dirty = 1;
+		mark_function_dirty(file, function);
+	}
 }
 
 void xdebug_branch_info_add_branches_and_paths(zend_string *filename, char *function_name, xdebug_branch_info *branch_info)
@@ -467,6 +580,7 @@ void xdebug_branch_info_add_branches_and_paths(zend_string *filename, char *func
 
 	if (branch_info) {
 		file->has_branch_info = 1;
+		mark_function_dirty(file, function);
 	}
 	function->branch_info = branch_info;
 }
@@ -39,6 +39,7 @@ typedef struct _xdebug_branch {
 	unsigned int  end_lineno;
 	unsigned int  end_op;
 	unsigned char hit;
+	unsigned char dirty; /* Whether hit or outs_hit changed since the last delta */
 	unsigned int  outs_count;
 	int           outs[XDEBUG_BRANCH_MAX_OUTS];
 	unsigned char outs_hit[XDEBUG_BRANCH_MAX_OUTS];
@@ -49,6 +50,7 @@ typedef struct _xdebug_path {
 	unsigned int elements_size;
 	unsigned int *elements;
 	unsigned char hit;
+	unsigned char dirty; /* Whether hit changed since the last delta */
 } xdebug_path;
 
 /* Contains information for paths that belong to a set of branches (as stored in xdebug_branch_info) */
@@ -57,6 +59,7 @@ typedef struct _xdebug_path_info {
 	unsigned int     paths_size;  /* The amount of slots allocated for storing paths */
 	xdebug_path    **paths;       /* An array of possible paths */
 	xdebug_hash     *path_hash;   /* A hash where each path's key is the sequence of followed branches, pointing to a path in the paths array */
+	unsigned char    truncated;   /* Whether more paths exist than xdebug.coverage_max_paths allows for */
 } xdebug_path_info;
 
 /* Contains all the branch information for a specific function */
@@ -70,22 +73,41 @@ typedef struct _xdebug_branch_info {
 	xdebug_path_info path_info; /* The paths that can be created out of these branches */
 } xdebug_branch_info;
 
+/* An open addressing set of (function call, branch, previous branch) tuples,
+ * so that a branch is only added once to a function call's path */
+typedef struct _xdebug_visited_branch {
+	uint64_t     branches;    /* Packed opcode nr and previous branch nr, 0 for an empty slot */
+	unsigned int function_nr;
+} xdebug_visited_branch;
+
+typedef struct _xdebug_visited_branches {
+	size_t                 count;
+	size_t                 size; /* Always a power of two */
+	xdebug_visited_branch *entries;
+} xdebug_visited_branches;
+
+xdebug_visited_branches *xdebug_visited_branches_ctor(void);
+void xdebug_visited_branches_dtor(xdebug_visited_branches *visited);
+
 xdebug_branch_info *xdebug_branch_info_create(unsigned int size);
 
 void xdebug_branch_info_update(xdebug_branch_info *branch_info, unsigned int pos, unsigned int lineno, unsigned int outidx, unsigned int jump_pos);
 void xdebug_branch_post_process(zend_op_array *opa, xdebug_branch_info *branch_info);
 void xdebug_branch_find_paths(xdebug_branch_info *branch_info);
+void xdebug_branch_info_build_path_hash(xdebug_branch_info *branch_info);
 
 void xdebug_branch_info_dump(zend_op_array *opa, xdebug_branch_info *branch_info);
 void xdebug_branch_info_add_branches_and_paths(zend_string *filename, char *function_name, xdebug_branch_info *branch_info);
 void xdebug_branch_info_free(xdebug_branch_info *branch_info);
 
 xdebug_path *xdebug_path_new(xdebug_path *old_path);
+void xdebug_path_add(xdebug_path *path, unsigned int nr);
 void xdebug_path_free(xdebug_path *path);
 
 xdebug_path_info *xdebug_path_info_ctor(void);
 void xdebug_path_info_dtor(xdebug_path_info *path_info);
 
+void xdebug_path_info_add_path(xdebug_path_info *path_info, xdebug_path *path);
 void xdebug_path_info_add_path_for_level(xdebug_path_info *path_info, xdebug_path *path, unsigned int level);
 xdebug_path *xdebug_path_info_get_path_for_level(xdebug_path_info *path_info, unsigned int level);
 
@@ -17,8 +17,10 @@
 #include "php_xdebug.h"
 #include "zend_extensions.h"
 
+#include "analysis_cache.h"
 #include "branch_info.h"
 #include "code_coverage_private.h"
+#include "shared.h"
 
 #include "base/base.h"
 #include "base/filter.h"
@@ -30,25 +32,32 @@
 /* True globals */
 int zend_xdebug_filter_offset = -1;
 int zend_xdebug_cc_run_offset = -1;
+int zend_xdebug_cc_file_offset = -1;
 
 extern ZEND_DECLARE_MODULE_GLOBALS(xdebug);
 
-static void xdebug_coverage_line_dtor(void *data)
-{
-	xdebug_coverage_line *line = (xdebug_coverage_line *) data;
-
-	xdfree(line);
-}
-
 xdebug_coverage_file *xdebug_coverage_file_ctor(zend_string *filename)
 {
 	xdebug_coverage_file *file;
 
 	file = xdmalloc(sizeof(xdebug_coverage_file));
 	file->name = zend_string_copy(filename);
-	file->lines = xdebug_hash_alloc(128, xdebug_coverage_line_dtor);
+	file->lines = NULL;
+	file->lines_start = 0;
+	file->lines_size = 0;
 	file->functions = xdebug_hash_alloc(128, xdebug_coverage_function_dtor);
 	file->has_branch_info = 0;
+	file->dirty = 0;
+	file->dirty_first = 0;
+	file->dirty_last = -1;
+
+	/* Register the file so that op_arrays can refer to it by slot number */
+	if (XG_COV(file_slots).count == XG_COV(file_slots).size) {
+		XG_COV(file_slots).size = XG_COV(file_slots).size ? XG_COV(file_slots).size * 2 : 32;
+		XG_COV(file_slots).files = xdrealloc(XG_COV(file_slots).files, XG_COV(file_slots).size * sizeof(xdebug_coverage_file*));
+	}
+	XG_COV(file_slots).files[XG_COV(file_slots).count] = file;
+	file->slot = ++XG_COV(file_slots).count;
 
 	return file;
 }
@@ -56,13 +65,172 @@ xdebug_coverage_file *xdebug_coverage_file_ctor(zend_string *filename)
 static void xdebug_coverage_file_dtor(void *data)
 {
 	xdebug_coverage_file *file = (xdebug_coverage_file *) data;
+	int                   i;
 
-	xdebug_hash_destroy(file->lines);
+	if (file->lines) {
+		for (i = 0; i < file->lines_size; i++) {
+			if (file->lines[i].contexts) {
+				xdebug_coverage_contexts_free(file->lines[i].contexts);
+			}
+		}
+		xdfree(file->lines);
+	}
 	xdebug_hash_destroy(file->functions);
 	zend_string_release(file->name);
 	xdfree(file);
 }
 
+/* Makes sure that the line counters for 'first' up to and including 'last'
+ * exist. The array grows with some room to spare, as the remaining functions
+ * of a file are usually found one by one. */
+static void xdebug_coverage_file_reserve_lines(xdebug_coverage_file *file, int first, int last)
+{
+	int                   old_end = file->lines_start + file->lines_size;
+	int                   new_start, new_end;
+	xdebug_coverage_line *new_lines;
+
+	if (first < 0) {
+		first = 0;
+	}
+	if (last < first) {
+		last = first;
+	}
+
+	if (file->lines_size == 0) {
+		new_start = first;
+		new_end = last + 1;
+	} else {
+		if (first >= file->lines_start && last < old_end) {
+			return;
+		}
+
+		new_start = file->lines_start;
+		new_end = old_end;
+
+		if (first < file->lines_start) {
+			new_start = MIN(first, file->lines_start - file->lines_size / 2);
+			if (new_start < 0) {
+				new_start = 0;
+			}
+		}
+		if (last >= old_end) {
+			new_end = MAX(last + 1, old_end + file->lines_size / 2);
+		}
+	}
+
+	new_lines = xdcalloc(new_end - new_start, sizeof(xdebug_coverage_line));
+	if (file->lines) {
+		memcpy(new_lines + (file->lines_start - new_start), file->lines, file->lines_size * sizeof(xdebug_coverage_line));
+		xdfree(file->lines);
+	}
+
+	file->lines = new_lines;
+	file->lines_start = new_start;
+	file->lines_size = new_end - new_start;
+}
+
+/* Puts the file on the list of files that xdebug_get_code_coverage_delta()
+ * looks at, so that it does not have to scan all files */
+void xdebug_coverage_file_mark_dirty(xdebug_coverage_file *file)
+{
+	if (file->dirty) {
+		return;
+	}
+
+	if (XG_COV(dirty_files).count == XG_COV(dirty_files).size) {
+		XG_COV(dirty_files).size = XG_COV(dirty_files).size ? XG_COV(dirty_files).size * 2 : 32;
+		XG_COV(dirty_files).files = xdrealloc(XG_COV(dirty_files).files, XG_COV(dirty_files).size * sizeof(xdebug_coverage_file*));
+	}
+	XG_COV(dirty_files).files[XG_COV(dirty_files).count++] = file;
+	file->dirty = 1;
+}
+
+static void xdebug_coverage_mark_line_dirty(xdebug_coverage_file *file, xdebug_coverage_line *line, int lineno)
+{
+	line->dirty = 1;
+
+	if (file->dirty_first > file->dirty_last) {
+		file->dirty_first = file->dirty_last = lineno;
+	} else if (lineno < file->dirty_first) {
+		file->dirty_first = lineno;
+	} else if (lineno > file->dirty_last) {
+		file->dirty_last = lineno;
+	}
+
+	xdebug_coverage_file_mark_dirty(file);
+}
+
+static xdebug_coverage_file *xdebug_coverage_find_file(zend_string *filename)
+{
+	xdebug_coverage_file *file;
+
+	if (XG_COV(previous_filename) && zend_string_equals(XG_COV(previous_filename), filename)) {
+		return XG_COV(previous_file);
+	}
+
+	/* Check if the file already exists in the hash */
+	if (!xdebug_hash_find(XG_COV(code_coverage_info), ZSTR_VAL(filename), ZSTR_LEN(filename), (void *) &file)) {
+		/* The file does not exist, so we add it to the hash */
+		file = xdebug_coverage_file_ctor(filename);
+
+		xdebug_hash_add(XG_COV(code_coverage_info), ZSTR_VAL(filename), ZSTR_LEN(filename), file);
+	}
+	if (XG_COV(previous_filename)) {
+		zend_string_release(XG_COV(previous_filename));
+	}
+	XG_COV(previous_filename) = zend_string_copy(file->name);
+	XG_COV(previous_file) = file;
+
+	return file;
+}
+
+/* Both lists point into code_coverage_info, so they are reset whenever that is destroyed */
+static void xdebug_coverage_file_slots_reset(void)
+{
+	if (XG_COV(file_slots).files) {
+		xdfree(XG_COV(file_slots).files);
+	}
+	XG_COV(file_slots).files = NULL;
+	XG_COV(file_slots).count = 0;
+	XG_COV(file_slots).size = 0;
+
+	if (XG_COV(dirty_files).files) {
+		xdfree(XG_COV(dirty_files).files);
+	}
+	XG_COV(dirty_files).files = NULL;
+	XG_COV(dirty_files).count = 0;
+	XG_COV(dirty_files).size = 0;
+}
+
+/* Returns the coverage file that the op_array's lines are counted in. The
+ * op_array remembers the file's slot number in a reserved slot, so that only
+ * the first call needs to look the file up by name. As op_arrays can outlive
+ * the request (or come from opcache's shared memory), the slot is only
+ * trusted if the file it refers to has the op_array's (interned) filename. */
+static xdebug_coverage_file *xdebug_coverage_file_for_oparray(zend_op_array *op_array)
+{
+	xdebug_coverage_file *file;
+	size_t                slot;
+
+	if (zend_xdebug_cc_file_offset < 0) {
+		return xdebug_coverage_find_file(op_array->filename);
+	}
+
+	slot = (size_t) op_array->reserved[zend_xdebug_cc_file_offset];
+	if (slot && slot <= XG_COV(file_slots).count) {
+		file = XG_COV(file_slots).files[slot - 1];
+
+		if (file->name == op_array->filename) {
+			return file;
+		}
+	}
+
+	file = xdebug_coverage_find_file(op_array->filename);
+	op_array->reserved[zend_xdebug_cc_file_offset] = (void*) file->slot;
+
+	return file;
+}
+
 xdebug_coverage_function *xdebug_coverage_function_ctor(char *function_name)
 {
 	xdebug_coverage_function *function;
@@ -70,6 +238,8 @@ xdebug_coverage_function *xdebug_coverage_function_ctor(char *function_name)
 	function = xdmalloc(sizeof(xdebug_coverage_function));
 	function->name = xdstrdup(function_name);
 	function->branch_info = NULL;
+	function->dirty = 0;
+	function->reported = 0;
 
 	return function;
 }
@@ -149,6 +319,9 @@ static void xdebug_build_fname_from_oparray(xdebug_func *tmp, zend_op_array *opa
 	}
 }
 
+/* Marks the branch that starts at the current opcode as reached. This
+ * formats the function's name for every opcode, so it is only done when
+ * branch coverage was asked for. */
 static void xdebug_print_opcode_info(zend_execute_data *execute_data, const zend_op *cur_opcode)
 {
 	zend_op_array *op_array = &execute_data->func->op_array;
@@ -156,6 +329,10 @@ static void xdebug_print_opcode_info(zend_execute_data *execute_data, const zend
 	char function_name[1024];
 	long opnr = execute_data->opline - execute_data->func->op_array.opcodes;
 
+	if (!XG_COV(code_coverage_branch_check)) {
+		return;
+	}
+
 	xdebug_build_fname_from_oparray(&func_info, op_array);
 	xdebug_func_format(function_name, sizeof(function_name), &func_info);
 	if (func_info.object_class) {
@@ -176,43 +353,25 @@ static int xdebug_check_branch_entry_handler(XDEBUG_OPCODE_HANDLER_ARGS)
 	zend_op_array *op_array = &execute_data->func->op_array;
 	const zend_op *cur_opcode = execute_data->opline;
 
-	if (!op_array->reserved[XG_COV(code_coverage_filter_offset)] && XG_COV(code_coverage_active)) {
+	if (XG_COV(code_coverage_branch_check) && XG_COV(code_coverage_active) && !op_array->reserved[XG_COV(code_coverage_filter_offset)]) {
 		xdebug_print_opcode_info(execute_data, cur_opcode);
 	}
 
 	return xdebug_call_original_opcode_handler_if_set(cur_opcode->opcode, XDEBUG_OPCODE_HANDLER_ARGS_PASSTHRU);
 }
 
-static void xdebug_count_line(zend_string *filename, int lineno, int executable, int deadcode)
+static void xdebug_count_line_in_file(xdebug_coverage_file *file, int lineno, int executable, int deadcode)
 {
-	xdebug_coverage_file *file;
 	xdebug_coverage_line *line;
 
-	if (XG_COV(previous_filename) && zend_string_equals(XG_COV(previous_filename), filename)) {
-		file = XG_COV(previous_file);
-	} else {
-		/* Check if the file already exists in the hash */
-		if (!xdebug_hash_find(XG_COV(code_coverage_info), ZSTR_VAL(filename), ZSTR_LEN(filename), (void *) &file)) {
-			/* The file does not exist, so we add it to the hash */
-			file = xdebug_coverage_file_ctor(filename);
-
-			xdebug_hash_add(XG_COV(code_coverage_info), ZSTR_VAL(filename), ZSTR_LEN(filename), file);
-		}
-		if (XG_COV(previous_filename)) {
-			zend_string_release(XG_COV(previous_filename));
-		}
-		XG_COV(previous_filename) = zend_string_copy(file->name);
-		XG_COV(previous_file) = file;
+	if (lineno < file->lines_start || lineno >= file->lines_start + file->lines_size) {
+		xdebug_coverage_file_reserve_lines(file, lineno, lineno);
 	}
+	line = &file->lines[lineno - file->lines_start];
+	line->seen = 1;
 
-	/* Check if the line already exists in the hash */
-	if (!xdebug_hash_index_find(file->lines, lineno, (void *) &line)) {
-		line = xdmalloc(sizeof(xdebug_coverage_line));
-		line->lineno = lineno;
-		line->count = 0;
-		line->executable = 0;
-
-		xdebug_hash_index_add(file->lines, lineno, line);
+	if (!line->dirty) {
+		xdebug_coverage_mark_line_dirty(file, line, lineno);
 	}
 
 	if (executable) {
@@ -223,9 +382,18 @@ static void xdebug_count_line(zend_string *filename, int lineno, int executable,
 		}
 	} else {
 		line->count++;
+
+		if (XG_COV(context_id) >= 0 && (!line->contexts || line->contexts->last_added != XG_COV(context_id))) {
+			xdebug_coverage_contexts_add(&line->contexts, (uint32_t) XG_COV(context_id));
+		}
 	}
 }
 
+static void xdebug_count_line(zend_string *filename, int lineno, int executable, int deadcode)
+{
+	xdebug_count_line_in_file(xdebug_coverage_find_file(filename), lineno, executable, deadcode);
+}
+
 static int xdebug_common_override_handler(XDEBUG_OPCODE_HANDLER_ARGS)
 {
 	zend_op_array *op_array = &execute_data->func->op_array;
@@ -237,7 +405,7 @@ static int xdebug_common_override_handler(XDEBUG_OPCODE_HANDLER_ARGS)
 		lineno = cur_opcode->lineno;
 
 		xdebug_print_opcode_info(execute_data, cur_opcode);
-		xdebug_count_line(op_array->filename, lineno, 0, 0);
+		xdebug_count_line_in_file(xdebug_coverage_file_for_oparray(op_array), lineno, 0, 0);
 	}
 
 	return xdebug_call_original_opcode_handler_if_set(cur_opcode->opcode, XDEBUG_OPCODE_HANDLER_ARGS_PASSTHRU);
@@ -253,7 +421,7 @@ static int xdebug_coverage_include_or_eval_handler(XDEBUG_OPCODE_HANDLER_ARGS)
 	return xdebug_call_original_opcode_handler_if_set(opline->opcode, XDEBUG_OPCODE_HANDLER_ARGS_PASSTHRU);
 }
 
-static void prefill_from_opcode(zend_string *filename, zend_op opcode, int deadcode)
+static void prefill_from_opcode(zend_string *filename, zend_op opcode, int deadcode, xdebug_coverage_cache_lines *cache_lines)
 {
 	if (
 		opcode.opcode != ZEND_NOP &&
@@ -266,6 +434,9 @@ static void prefill_from_opcode(zend_string *filename, zend_op opcode, int deadc
 		&& opcode.opcode != ZEND_RECV_VARIADIC
 	) {
 		xdebug_count_line(filename, opcode.lineno, 1, deadcode);
+		if (cache_lines) {
+			xdebug_coverage_cache_lines_add(cache_lines, opcode.lineno, deadcode);
+		}
 	}
 }
 
@@ -489,11 +660,46 @@ static void xdebug_analyse_oparray(zend_op_array *opa, xdebug_set *set, xdebug_b
 	}
 }
 
+static void function_name_from_oparray(char *buffer, size_t buffer_size, zend_op_array *op_array)
+{
+	xdebug_func func_info;
+
+	xdebug_build_fname_from_oparray(&func_info, op_array);
+	xdebug_func_format(buffer, buffer_size, &func_info);
+
+	if (func_info.object_class) {
+		zend_string_release(func_info.object_class);
+	}
+	if (func_info.scope_class) {
+		zend_string_release(func_info.scope_class);
+	}
+	if (func_info.function) {
+		xdfree(func_info.function);
+	}
+}
+
+/* Counts the lines that a cached analysis found, and takes over its branch info */
+static void prefill_from_cache(zend_string *filename, char *function_name, xdebug_coverage_cache_lines *cache_lines, xdebug_branch_info *branch_info)
+{
+	size_t i;
+
+	for (i = 0; i < cache_lines->count; i++) {
+		xdebug_count_line(filename, cache_lines->lines[i] >> 1, 1, cache_lines->lines[i] & 1);
+	}
+
+	if (branch_info) {
+		xdebug_branch_info_add_branches_and_paths(filename, function_name, branch_info);
+	}
+}
+
 static void prefill_from_oparray(zend_string *filename, zend_op_array *op_array)
 {
 	unsigned int i;
 	xdebug_set *set = NULL;
 	xdebug_branch_info *branch_info = NULL;
+	char function_name[1024];
+	bool use_cache = false;
+	xdebug_coverage_cache_lines cache_lines = XDEBUG_COVERAGE_CACHE_LINES_INITIALIZER;
 
 	op_array->reserved[XG_COV(dead_code_analysis_tracker_offset)] = (void*) XG_COV(dead_code_last_start_id);
 
@@ -518,6 +724,20 @@ static void prefill_from_oparray(zend_string *filename, zend_op_array *op_array)
 		}
 	}
 
+	/* Size the file's line counters for the whole function up front */
+	xdebug_coverage_file_reserve_lines(xdebug_coverage_file_for_oparray(op_array), op_array->line_start, op_array->line_end);
+
+	if (xdebug_coverage_cache_enabled() && (op_array->fn_flags & ZEND_ACC_DONE_PASS_TWO)) {
+		use_cache = true;
+		function_name_from_oparray(function_name, sizeof(function_name), op_array);
+
+		if (xdebug_coverage_cache_find(op_array, function_name, &cache_lines, &branch_info)) {
+			prefill_from_cache(filename, function_name, &cache_lines, branch_info);
+			xdebug_coverage_cache_lines_dtor(&cache_lines);
+			goto dynamic_func_defs;
+		}
+	}
+
 	/* Run dead code analysis if requested */
 	if (XG_COV(code_coverage_dead_code_analysis) && (op_array->fn_flags & ZEND_ACC_DONE_PASS_TWO)) {
 		set = xdebug_set_create(op_array->last);
@@ -531,34 +751,29 @@ static void prefill_from_oparray(zend_string *filename, zend_op_array *op_array)
 	/* The normal loop then finally */
 	for (i = 0; i < op_array->last; i++) {
 		zend_op opcode = op_array->opcodes[i];
-		prefill_from_opcode(filename, opcode, set ? !xdebug_set_in(set, i) : 0);
+		prefill_from_opcode(filename, opcode, set ? !xdebug_set_in(set, i) : 0, use_cache ? &cache_lines : NULL);
 	}
 
 	if (set) {
 		xdebug_set_free(set);
 	}
 	if (branch_info) {
-		char function_name[1024];
-		xdebug_func func_info;
-
-		xdebug_build_fname_from_oparray(&func_info, op_array);
-		xdebug_func_format(function_name, sizeof(function_name), &func_info);
-
-		if (func_info.object_class) {
-			zend_string_release(func_info.object_class);
-		}
-		if (func_info.scope_class) {
-			zend_string_release(func_info.scope_class);
-		}
-		if (func_info.function) {
-			xdfree(func_info.function);
+		if (!use_cache) {
+			function_name_from_oparray(function_name, sizeof(function_name), op_array);
 		}
 
 		xdebug_branch_post_process(op_array, branch_info);
 		xdebug_branch_find_paths(branch_info);
+	}
+	if (use_cache) {
+		xdebug_coverage_cache_add(op_array, function_name, &cache_lines, branch_info);
+		xdebug_coverage_cache_lines_dtor(&cache_lines);
+	}
+	if (branch_info) {
 		xdebug_branch_info_add_branches_and_paths(filename, (char*) function_name, branch_info);
 	}
 
+dynamic_func_defs:
 #if PHP_VERSION_ID >= 80100
 	if (!op_array->num_dynamic_func_defs) {
 		return;
@@ -568,6 +783,7 @@ static void prefill_from_oparray(zend_string *filename, zend_op_array *op_array)
 		prefill_from_oparray(filename, op_array->dynamic_func_defs[i]);
 	}
 #endif
+	return;
 }
 
 static int prefill_from_function_table(zend_op_array *opa)
@@ -603,17 +819,18 @@ static int prefill_from_class_table(zend_class_entry *ce)
 	return ZEND_HASH_APPLY_KEEP;
 }
 
-static void xdebug_prefill_code_coverage(zend_op_array *op_array)
+/* Prefills the functions and classes that were declared since the last call.
+ * The counts are reset when stopping code coverage discards what was
+ * prefilled, so that everything is prefilled again when it restarts. */
+static void prefill_from_tables(void)
 {
 	zend_op_array    *function_op_array;
 	zend_class_entry *class_entry;
-
-	if ((long) op_array->reserved[XG_COV(dead_code_analysis_tracker_offset)] < XG_COV(dead_code_last_start_id)) {
-		prefill_from_oparray(op_array->filename, op_array);
-	}
+	uint32_t          function_count = XG_COV(prefill_function_count);
+	uint32_t          class_count = XG_COV(prefill_class_count);
 
 	ZEND_HASH_REVERSE_FOREACH_PTR(CG(function_table), function_op_array) {
-		if (_idx == XG_COV(prefill_function_count)) {
+		if (_idx == function_count) {
 			break;
 		}
 		prefill_from_function_table(function_op_array);
@@ -621,7 +838,7 @@ static void xdebug_prefill_code_coverage(zend_op_array *op_array)
 	XG_COV(prefill_function_count) = CG(function_table)->nNumUsed;
 
 	ZEND_HASH_REVERSE_FOREACH_PTR(CG(class_table), class_entry) {
-		if (_idx == XG_COV(prefill_class_count)) {
+		if (_idx == class_count) {
 			break;
 		}
 		prefill_from_class_table(class_entry);
@@ -629,12 +846,26 @@ static void xdebug_prefill_code_coverage(zend_op_array *op_array)
 	XG_COV(prefill_class_count) = CG(class_table)->nNumUsed;
 }
 
+static void xdebug_prefill_code_coverage(zend_op_array *op_array)
+{
+	if ((long) op_array->reserved[XG_COV(dead_code_analysis_tracker_offset)] < XG_COV(dead_code_last_start_id)) {
+		prefill_from_oparray(op_array->filename, op_array);
+	}
+
+	prefill_from_tables();
+}
+
 void xdebug_code_coverage_start_of_function(zend_op_array *op_array, char *function_name)
 {
 	xdebug_path *path = xdebug_path_new(NULL);
 	int orig_size = XG_COV(branches).size;
 
-	xdebug_prefill_code_coverage(op_array);
+	/* Functions are prefilled when their file or eval'd code is compiled, or
+	 * when coverage starts. Only op_arrays that neither saw, such as closures
+	 * in files that were compiled before coverage started, are left for here. */
+	if ((long) op_array->reserved[XG_COV(dead_code_analysis_tracker_offset)] < XG_COV(dead_code_last_start_id)) {
+		prefill_from_oparray(op_array->filename, op_array);
+	}
 	xdebug_path_info_add_path_for_level(XG_COV(paths_stack), path, XDEBUG_VECTOR_COUNT(XG_BASE(stack)));
 
 	if (orig_size == 0 || XDEBUG_VECTOR_COUNT(XG_BASE(stack)) >= orig_size) {
@@ -683,11 +914,26 @@ PHP_FUNCTION(xdebug_start_code_coverage)
 		return;
 	}
 
+	/* Cached analysis results belong to the options they were made with */
+	xdebug_coverage_cache_flush();
+
 	XG_COV(code_coverage_unused) = (options & XDEBUG_CC_OPTION_UNUSED);
 	XG_COV(code_coverage_dead_code_analysis) = (options & XDEBUG_CC_OPTION_DEAD_CODE);
 	XG_COV(code_coverage_branch_check) = (options & XDEBUG_CC_OPTION_BRANCH_CHECK);
 
+	if (XG_COV(code_coverage_branch_check) && XINI_COV(line_only)) {
+		php_error(E_WARNING, "Branch and path coverage needs 'xdebug.coverage_line_only' to be turned off, only collecting line coverage");
+		XG_COV(code_coverage_branch_check) = 0;
+	}
+
 	XG_COV(code_coverage_active) = 1;
+
+	/* Everything that was compiled while coverage was not running is prefilled
+	 * now, and later files as they are compiled */
+	if (XG_COV(code_coverage_unused)) {
+		prefill_from_tables();
+	}
+
 	RETURN_TRUE;
 }
 
@@ -706,7 +952,11 @@ PHP_FUNCTION(xdebug_stop_code_coverage)
 		RETURN_FALSE;
 	}
 
+	xdebug_coverage_cache_flush();
+
 	if (cleanup) {
+		xdebug_coverage_shared_merge();
+
 		if (XG_COV(previous_filename)) {
 			zend_string_release(XG_COV(previous_filename));
 		}
@@ -719,7 +969,10 @@ PHP_FUNCTION(xdebug_stop_code_coverage)
 		XG_COV(previous_mark_file) = NULL;
 		xdebug_hash_destroy(XG_COV(code_coverage_info));
 		XG_COV(code_coverage_info) = xdebug_hash_alloc(32, xdebug_coverage_file_dtor);
+		xdebug_coverage_file_slots_reset();
 		XG_COV(dead_code_last_start_id)++;
+		XG_COV(prefill_function_count) = 0;
+		XG_COV(prefill_class_count) = 0;
 		xdebug_path_info_dtor(XG_COV(paths_stack));
 		XG_COV(paths_stack) = xdebug_path_info_ctor();
 	}
@@ -729,31 +982,46 @@ PHP_FUNCTION(xdebug_stop_code_coverage)
 	RETURN_TRUE;
 }
 
-static int xdebug_lineno_cmp(Bucket *f, Bucket *s)
+static void add_line(zval *retval, xdebug_coverage_line *line, int lineno)
 {
-	if (f->h < s->h) {
-		return -1;
-	} else if (f->h > s->h) {
-		return 1;
+	if (line->executable && (line->count == 0)) {
+		add_index_long(retval, lineno, -line->executable);
 	} else {
-		return 0;
+		add_index_long(retval, lineno, 1);
 	}
 }
 
+static void add_lines(zval *retval, xdebug_coverage_file *file)
+{
+	int i;
+
+	/* The counters are kept in line number order already */
+	for (i = 0; i < file->lines_size; i++) {
+		if (file->lines[i].seen) {
+			add_line(retval, &file->lines[i], file->lines_start + i);
+		}
+	}
+}
 
-static void add_line(void *ret, xdebug_hash_element *e)
+static void add_dirty_lines(zval *retval, xdebug_coverage_file *file)
 {
-	xdebug_coverage_line *line = (xdebug_coverage_line*) e->ptr;
-	zval                 *retval = (zval*) ret;
+	int lineno;
 
-	if (line->executable && (line->count == 0)) {
-		add_index_long(retval, line->lineno, -line->executable);
-	} else {
-		add_index_long(retval, line->lineno, 1);
+	for (lineno = file->dirty_first; lineno <= file->dirty_last; lineno++) {
+		xdebug_coverage_line *line = &file->lines[lineno - file->lines_start];
+
+		if (line->dirty) {
+			add_line(retval, line, lineno);
+			line->dirty = 0;
+		}
 	}
+
+	file->dirty_first = 0;
+	file->dirty_last = -1;
 }
 
-static void add_branches(zval *retval, xdebug_branch_info *branch_info)
+/* With 'only_dirty', only the branches that changed since the last delta are added */
+static void add_branches(zval *retval, xdebug_branch_info *branch_info, bool only_dirty)
 {
 	zval *branches, *branch, *out, *out_hit;
 	unsigned int i;
@@ -765,6 +1033,10 @@ static void add_branches(zval *retval, xdebug_branch_info *branch_info)
 		if (xdebug_set_in(branch_info->starts, i)) {
 			size_t j = 0;
 
+			if (only_dirty && !branch_info->branches[i].dirty) {
+				continue;
+			}
+
 			XDEBUG_MAKE_STD_ZVAL(branch);
 			array_init(branch);
 			add_assoc_long(branch, "op_start", i);
@@ -804,7 +1076,7 @@ static void add_branches(zval *retval, xdebug_branch_info *branch_info)
 	efree(branches);
 }
 
-static void add_paths(zval *retval, xdebug_branch_info *branch_info)
+static void add_paths(zval *retval, xdebug_branch_info *branch_info, bool only_dirty)
 {
 	zval *paths, *path, *path_container;
 	unsigned int i, j;
@@ -813,6 +1085,10 @@ static void add_paths(zval *retval, xdebug_branch_info *branch_info)
 	array_init(paths);
 
 	for (i = 0; i < branch_info->path_info.paths_count; i++) {
+		if (only_dirty && !branch_info->path_info.paths[i]->dirty) {
+			continue;
+		}
+
 		XDEBUG_MAKE_STD_ZVAL(path);
 		array_init(path);
 
@@ -826,13 +1102,17 @@ static void add_paths(zval *retval, xdebug_branch_info *branch_info)
 		add_assoc_zval(path_container, "path", path);
 		add_assoc_long(path_container, "hit", branch_info->path_info.paths[i]->hit);
 
-		add_next_index_zval(paths, path_container);
+		/* Keyed by path number, so that the paths in a delta can be matched up */
+		add_index_zval(paths, i, path_container);
 
 		efree(path_container);
 		efree(path);
 	}
 
 	add_assoc_zval_ex(retval, "paths", HASH_KEY_SIZEOF("paths"), paths);
+	if (branch_info->path_info.truncated) {
+		add_assoc_bool_ex(retval, "paths_truncated", HASH_KEY_SIZEOF("paths_truncated"), 1);
+	}
 
 	efree(paths);
 }
@@ -847,8 +1127,8 @@ static void add_cc_function(void *ret, xdebug_hash_element *e)
 	array_init(function_info);
 
 	if (function->branch_info) {
-		add_branches(function_info, function->branch_info);
-		add_paths(function_info, function->branch_info);
+		add_branches(function_info, function->branch_info, false);
+		add_paths(function_info, function->branch_info, false);
 	}
 
 	add_assoc_zval_ex(retval, function->name, HASH_KEY_STRLEN(function->name), function_info);
@@ -856,22 +1136,57 @@ static void add_cc_function(void *ret, xdebug_hash_element *e)
 	efree(function_info);
 }
 
-static void add_file(void *ret, xdebug_hash_element *e)
+static void clear_dirty_branch_info(xdebug_branch_info *branch_info)
+{
+	unsigned int i;
+
+	for (i = 0; i < branch_info->size; i++) {
+		branch_info->branches[i].dirty = 0;
+	}
+	for (i = 0; i < branch_info->path_info.paths_count; i++) {
+		branch_info->path_info.paths[i]->dirty = 0;
+	}
+}
+
+/* Functions that a delta has not included before are added in full */
+static void add_cc_function_delta(void *ret, xdebug_hash_element *e)
 {
-	xdebug_coverage_file *file = (xdebug_coverage_file*) e->ptr;
-	zval                 *retval = (zval*) ret;
-	zval                 *lines, *functions, *file_info;
-	HashTable            *target_hash;
+	xdebug_coverage_function *function = (xdebug_coverage_function*) e->ptr;
+	zval                     *retval = (zval*) ret;
+	zval                     *function_info;
+
+	if (!function->branch_info || !function->dirty) {
+		return;
+	}
+
+	XDEBUG_MAKE_STD_ZVAL(function_info);
+	array_init(function_info);
+
+	add_branches(function_info, function->branch_info, function->reported);
+	add_paths(function_info, function->branch_info, function->reported);
+
+	clear_dirty_branch_info(function->branch_info);
+	function->dirty = 0;
+	function->reported = 1;
+
+	add_assoc_zval_ex(retval, function->name, HASH_KEY_STRLEN(function->name), function_info);
+
+	efree(function_info);
+}
+
+static void add_file_info(zval *retval, xdebug_coverage_file *file, bool only_dirty)
+{
+	zval *lines, *functions, *file_info;
 
 	/* Add all the lines */
 	XDEBUG_MAKE_STD_ZVAL(lines);
 	array_init(lines);
 
-	xdebug_hash_apply(file->lines, (void *) lines, add_line);
-
-	/* Sort on linenumber */
-	target_hash = HASH_OF(lines);
-	zend_hash_sort(target_hash, xdebug_lineno_cmp, 0);
+	if (only_dirty) {
+		add_dirty_lines(lines, file);
+	} else {
+		add_lines(lines, file);
+	}
 
 	/* Add the branch and path info */
 	if (XG_COV(code_coverage_branch_check)) {
@@ -881,7 +1196,7 @@ static void add_file(void *ret, xdebug_hash_element *e)
 		XDEBUG_MAKE_STD_ZVAL(functions);
 		array_init(functions);
 
-		xdebug_hash_apply(file->functions, (void *) functions, add_cc_function);
+		xdebug_hash_apply(file->functions, (void *) functions, only_dirty ? add_cc_function_delta : add_cc_function);
 
 		add_assoc_zval_ex(file_info, "lines", HASH_KEY_SIZEOF("lines"), lines);
 		add_assoc_zval_ex(file_info, "functions", HASH_KEY_SIZEOF("functions"), functions);
@@ -896,6 +1211,11 @@ static void add_file(void *ret, xdebug_hash_element *e)
 	efree(lines);
 }
 
+static void add_file(void *ret, xdebug_hash_element *e)
+{
+	add_file_info((zval*) ret, (xdebug_coverage_file*) e->ptr, false);
+}
+
 PHP_FUNCTION(xdebug_get_code_coverage)
 {
 	array_init(return_value);
@@ -907,6 +1227,172 @@ PHP_FUNCTION(xdebug_get_code_coverage)
 	xdebug_hash_apply(XG_COV(code_coverage_info), (void *) return_value, add_file);
 }
 
+/* {{{ proto array xdebug_get_code_coverage_delta()
+   Returns the lines, branches, and paths that changed since the last call */
+PHP_FUNCTION(xdebug_get_code_coverage_delta)
+{
+	size_t i;
+
+	array_init(return_value);
+
+	if (!XG_COV(code_coverage_info)) {
+		return;
+	}
+
+	for (i = 0; i < XG_COV(dirty_files).count; i++) {
+		xdebug_coverage_file *file = XG_COV(dirty_files).files[i];
+
+		add_file_info(return_value, file, true);
+		file->dirty = 0;
+	}
+
+	XG_COV(dirty_files).count = 0;
+}
+/* }}} */
+
+typedef struct _coverage_summary {
+	zend_long lines_executable;
+	zend_long lines_executed;
+	zend_long lines_dead;
+	zend_long branches;
+	zend_long branches_hit;
+	zend_long paths;
+	zend_long paths_hit;
+} coverage_summary;
+
+typedef struct _coverage_summary_context {
+	zval             *files;
+	coverage_summary *totals;
+} coverage_summary_context;
+
+static void summarise_function(void *ret, xdebug_hash_element *e)
+{
+	xdebug_coverage_function *function = (xdebug_coverage_function*) e->ptr;
+	coverage_summary         *summary = (coverage_summary*) ret;
+	xdebug_branch_info       *branch_info = function->branch_info;
+	unsigned int              i;
+
+	if (!branch_info) {
+		return;
+	}
+
+	summary->branches += xdebug_set_count(branch_info->starts);
+	for (i = 0; i < branch_info->starts->size; i++) {
+		if (branch_info->branches[i].hit && xdebug_set_in(branch_info->starts, i)) {
+			summary->branches_hit++;
+		}
+	}
+
+	summary->paths += branch_info->path_info.paths_count;
+	for (i = 0; i < branch_info->path_info.paths_count; i++) {
+		if (branch_info->path_info.paths[i]->hit) {
+			summary->paths_hit++;
+		}
+	}
+}
+
+static void summarise_file(xdebug_coverage_file *file, coverage_summary *summary)
+{
+	int i;
+
+	for (i = 0; i < file->lines_size; i++) {
+		xdebug_coverage_line *line = &file->lines[i];
+
+		if (!line->seen) {
+			continue;
+		}
+
+		/* The same classification as add_lines() makes */
+		if (line->executable && line->count == 0) {
+			if (line->executable == 2) {
+				summary->lines_dead++;
+			} else {
+				summary->lines_executable++;
+			}
+		} else {
+			summary->lines_executable++;
+			summary->lines_executed++;
+		}
+	}
+
+	if (file->has_branch_info) {
+		xdebug_hash_apply(file->functions, (void *) summary, summarise_function);
+	}
+}
+
+static void add_summary(zval *retval, coverage_summary *summary)
+{
+	zval lines, branches, paths;
+
+	array_init(&lines);
+	add_assoc_long(&lines, "executable", summary->lines_executable);
+	add_assoc_long(&lines, "executed", summary->lines_executed);
+	add_assoc_long(&lines, "dead", summary->lines_dead);
+	add_assoc_zval(retval, "lines", &lines);
+
+	array_init(&branches);
+	add_assoc_long(&branches, "total", summary->branches);
+	add_assoc_long(&branches, "hit", summary->branches_hit);
+	add_assoc_zval(retval, "branches", &branches);
+
+	array_init(&paths);
+	add_assoc_long(&paths, "total", summary->paths);
+	add_assoc_long(&paths, "hit", summary->paths_hit);
+	add_assoc_zval(retval, "paths", &paths);
+}
+
+static void add_file_summary(void *ret, xdebug_hash_element *e)
+{
+	xdebug_coverage_file     *file = (xdebug_coverage_file*) e->ptr;
+	coverage_summary_context *context = (coverage_summary_context*) ret;
+	coverage_summary         *totals = context->totals;
+	coverage_summary          summary;
+	zval                      file_summary;
+
+	memset(&summary, 0, sizeof(coverage_summary));
+	summarise_file(file, &summary);
+
+	array_init(&file_summary);
+	add_summary(&file_summary, &summary);
+	add_assoc_zval_ex(context->files, ZSTR_VAL(file->name), ZSTR_LEN(file->name), &file_summary);
+
+	totals->lines_executable += summary.lines_executable;
+	totals->lines_executed += summary.lines_executed;
+	totals->lines_dead += summary.lines_dead;
+	totals->branches += summary.branches;
+	totals->branches_hit += summary.branches_hit;
+	totals->paths += summary.paths;
+	totals->paths_hit += summary.paths_hit;
+}
+
+/* {{{ proto array xdebug_get_code_coverage_summary()
+   Returns, per file and in total, how many lines are executable, executed,
+   and dead, and how many branches and paths exist and were hit. Executable
+   lines include the executed ones, but not the dead ones. */
+PHP_FUNCTION(xdebug_get_code_coverage_summary)
+{
+	coverage_summary         totals;
+	coverage_summary_context context;
+	zval                     files, total;
+
+	memset(&totals, 0, sizeof(coverage_summary));
+	array_init(&files);
+
+	if (XG_COV(code_coverage_info)) {
+		context.files = &files;
+		context.totals = &totals;
+		xdebug_hash_apply(XG_COV(code_coverage_info), (void *) &context, add_file_summary);
+	}
+
+	array_init(return_value);
+	add_assoc_zval(return_value, "files", &files);
+
+	array_init(&total);
+	add_summary(&total, &totals);
+	add_assoc_zval(return_value, "total", &total);
+}
+/* }}} */
+
 PHP_FUNCTION(xdebug_get_function_count)
 {
 	RETURN_LONG(XG_BASE(function_count));
@@ -923,10 +1409,20 @@ void xdebug_init_coverage_globals(xdebug_coverage_globals_t *xg)
 	xg->previous_file        = NULL;
 	xg->previous_mark_filename = NULL;
 	xg->previous_mark_file     = NULL;
+	xg->file_slots.files = NULL;
+	xg->file_slots.count = 0;
+	xg->file_slots.size  = 0;
+	xg->dirty_files.files = NULL;
+	xg->dirty_files.count = 0;
+	xg->dirty_files.size  = 0;
 	xg->paths_stack = NULL;
 	xg->branches.size        = 0;
 	xg->branches.last_branch_nr = NULL;
 	xg->code_coverage_active = 0;
+	xg->context_id = -1;
+	xg->shared_collecting = 0;
+	xg->shared_request_count = 0;
+	xg->shared_index = NULL;
 
 	/* Get reserved offset */
 	xg->dead_code_analysis_tracker_offset = zend_xdebug_cc_run_offset;
@@ -937,7 +1433,11 @@ void xdebug_init_coverage_globals(xdebug_coverage_globals_t *xg)
 void xdebug_coverage_count_line_if_active(zend_op_array *op_array, zend_string *file, int lineno)
 {
 	if (XG_COV(code_coverage_active) && !op_array->reserved[XG_COV(code_coverage_filter_offset)]) {
-		xdebug_count_line(file, lineno, 0, 0);
+		if (file == op_array->filename) {
+			xdebug_count_line_in_file(xdebug_coverage_file_for_oparray(op_array), lineno, 0, 0);
+		} else {
+			xdebug_count_line(file, lineno, 0, 0);
+		}
 	}
 }
 
@@ -1037,6 +1537,9 @@ void xdebug_coverage_minit(INIT_FUNC_ARGS)
 	/* Get reserved offsets */
 	zend_xdebug_cc_run_offset = zend_get_resource_handle(XDEBUG_NAME);
 	zend_xdebug_filter_offset = zend_get_resource_handle(XDEBUG_NAME);
+	zend_xdebug_cc_file_offset = zend_get_resource_handle(XDEBUG_NAME);
+
+	xdebug_coverage_shared_minit();
 
 	xdebug_register_with_opcode_multi_handler(ZEND_ASSIGN, xdebug_common_override_handler);
 	xdebug_register_with_opcode_multi_handler(ZEND_ASSIGN_DIM, xdebug_common_override_handler);
@@ -1116,7 +1619,12 @@ void xdebug_coverage_minit(INIT_FUNC_ARGS)
 	xdebug_set_opcode_handler(ZEND_SWITCH_LONG, xdebug_switch_handler);
 
 	/* Override all the other opcodes so that we can mark when we hit a branch
-	 * start one */
+	 * start one. Without these, every opcode that does not carry a line runs
+	 * without going through Xdebug, but branch coverage is not possible. */
+	if (XINI_COV(line_only)) {
+		return;
+	}
+
 	for (i = 0; i < 256; i++) {
 		if (i == ZEND_HANDLE_EXCEPTION) {
 			continue;
@@ -1132,6 +1640,10 @@ void xdebug_coverage_register_constants(INIT_FUNC_ARGS)
 	REGISTER_LONG_CONSTANT("XDEBUG_CC_UNUSED", XDEBUG_CC_OPTION_UNUSED, CONST_CS | CONST_PERSISTENT);
 	REGISTER_LONG_CONSTANT("XDEBUG_CC_DEAD_CODE", XDEBUG_CC_OPTION_DEAD_CODE, CONST_CS | CONST_PERSISTENT);
 	REGISTER_LONG_CONSTANT("XDEBUG_CC_BRANCH_CHECK", XDEBUG_CC_OPTION_BRANCH_CHECK, CONST_CS | CONST_PERSISTENT);
+
+	REGISTER_LONG_CONSTANT("XDEBUG_CC_DUMP_BINARY", XDEBUG_CC_DUMP_BINARY, CONST_CS | CONST_PERSISTENT);
+	REGISTER_LONG_CONSTANT("XDEBUG_CC_DUMP_LCOV", XDEBUG_CC_DUMP_LCOV, CONST_CS | CONST_PERSISTENT);
+	REGISTER_LONG_CONSTANT("XDEBUG_CC_DUMP_CLOVER", XDEBUG_CC_DUMP_CLOVER, CONST_CS | CONST_PERSISTENT);
 }
 
 void xdebug_coverage_rinit(void)
@@ -1143,25 +1655,45 @@ void xdebug_coverage_rinit(void)
 	XG_COV(code_coverage_filter_offset) = zend_xdebug_filter_offset;
 	XG_COV(previous_filename) = NULL;
 	XG_COV(previous_file) = NULL;
+	XG_COV(file_slots).files = NULL;
+	XG_COV(file_slots).count = 0;
+	XG_COV(file_slots).size = 0;
+	XG_COV(dirty_files).files = NULL;
+	XG_COV(dirty_files).count = 0;
+	XG_COV(dirty_files).size = 0;
 	XG_COV(prefill_function_count) = 0;
 	XG_COV(prefill_class_count) = 0;
 
+	XG_COV(analysis_cache) = NULL;
+	XG_COV(context_id) = -1;
+
 	/* Initialize visited classes and branches hash */
-	XG_COV(visited_branches) = xdebug_hash_alloc(2048, NULL);
+	XG_COV(visited_branches) = xdebug_visited_branches_ctor();
 
 	XG_COV(paths_stack) = xdebug_path_info_ctor();
 	XG_COV(branches).size = 0;
 	XG_COV(branches).last_branch_nr = NULL;
+
+	xdebug_coverage_shared_rinit();
+}
+
+void xdebug_coverage_mshutdown(void)
+{
+	xdebug_coverage_shared_mshutdown();
 }
 
 void xdebug_coverage_post_deactivate(void)
 {
 	XG_COV(code_coverage_active) = 0;
 
+	xdebug_coverage_cache_flush();
+	xdebug_coverage_shared_merge();
+
 	xdebug_hash_destroy(XG_COV(code_coverage_info));
 	XG_COV(code_coverage_info) = NULL;
+	xdebug_coverage_file_slots_reset();
 
-	xdebug_hash_destroy(XG_COV(visited_branches));
+	xdebug_visited_branches_dtor(XG_COV(visited_branches));
 	XG_COV(visited_branches) = NULL;
 
 	/* Clean up path coverage array */
@@ -21,9 +21,15 @@
 
 typedef struct xdebug_coverage_file {
 	zend_string        *name;
-	xdebug_hash        *lines;
+	struct xdebug_coverage_line *lines; /* Indexed by line number minus lines_start */
+	int                 lines_start;
+	int                 lines_size;
 	xdebug_hash        *functions; /* Used for branch coverage */
 	int                 has_branch_info;
+	size_t              slot; /* Position in file_slots, plus one */
+	int                 dirty; /* Whether the file is on the dirty_files list */
+	int                 dirty_first; /* The range of lines that changed since the last delta */
+	int                 dirty_last;
 } xdebug_coverage_file;
 
 typedef struct _xdebug_coverage_globals_t {
@@ -41,8 +47,23 @@ typedef struct _xdebug_coverage_globals_t {
 	xdebug_coverage_file *previous_file;
 	zend_string          *previous_mark_filename;
 	xdebug_coverage_file *previous_mark_file;
+	struct {
+		xdebug_coverage_file **files;
+		size_t                 count;
+		size_t                 size;
+	} file_slots;
+	struct {
+		xdebug_coverage_file **files;
+		size_t                 count;
+		size_t                 size;
+	} dirty_files; /* Files that changed since the last xdebug_get_code_coverage_delta() */
 	xdebug_path_info     *paths_stack;
-	xdebug_hash          *visited_branches;
+	xdebug_visited_branches *visited_branches;
+	xdebug_hash          *analysis_cache; /* Per source file prefill results, see analysis_cache.c */
+	zend_long             context_id; /* Set with xdebug_set_coverage_context(), -1 if not set */
+	zend_bool             shared_collecting;    /* Whether this request's lines go to xdebug.coverage_shared_file */
+	zend_long             shared_request_count; /* The number of requests this process handled */
+	xdebug_hash          *shared_index;         /* The positions of files in the shared file table, lives as long as the process */
 	struct {
 		unsigned int  size;
 		int *last_branch_nr;
@@ -50,7 +71,11 @@ typedef struct _xdebug_coverage_globals_t {
 } xdebug_coverage_globals_t;
 
 typedef struct _xdebug_coverage_settings_t {
-	int dummy;
+	zend_long max_paths;
+	char     *cache_dir;
+	zend_bool line_only;
+	char     *shared_file;
+	zend_long shared_sample;
 } xdebug_coverage_settings_t;
 
 void xdebug_init_coverage_globals(xdebug_coverage_globals_t *xg);
@@ -72,6 +97,8 @@ void xdebug_coverage_register_constants(INIT_FUNC_ARGS);
 PHP_FUNCTION(xdebug_start_code_coverage);
 PHP_FUNCTION(xdebug_stop_code_coverage);
 PHP_FUNCTION(xdebug_get_code_coverage);
+PHP_FUNCTION(xdebug_get_code_coverage_delta);
+PHP_FUNCTION(xdebug_get_code_coverage_summary);
 PHP_FUNCTION(xdebug_code_coverage_started);
 
 PHP_FUNCTION(xdebug_get_function_count);
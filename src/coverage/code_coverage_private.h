@@ -21,26 +21,32 @@
 
 #include "branch_info.h"
 #include "code_coverage.h"
+#include "contexts.h"
 
 #include "lib/compat.h"
 #include "lib/hash.h"
 #include "lib/mm.h"
 
 typedef struct xdebug_coverage_line {
-	int lineno;
-	int count;
-	int executable;
+	int       count;
+	int       executable;
+	zend_bool seen; /* Whether the line was counted or prefilled at all */
+	zend_bool dirty; /* Whether the line changed since the last delta */
+	xdebug_coverage_contexts *contexts; /* The context IDs that executed the line, if any were set */
 } xdebug_coverage_line;
 
 typedef struct xdebug_coverage_function {
 	char               *name;
 	xdebug_branch_info *branch_info;
+	zend_bool           dirty;    /* Whether branches or paths changed since the last delta */
+	zend_bool           reported; /* Whether a delta included this function before */
 } xdebug_coverage_function;
 
 #define XG_COV(v)      (XG(globals.coverage.v))
 #define XINI_COV(v)    (XG(settings.coverage.v))
 
 xdebug_coverage_file *xdebug_coverage_file_ctor(zend_string *filename);
+void xdebug_coverage_file_mark_dirty(xdebug_coverage_file *file);
 
 xdebug_coverage_function *xdebug_coverage_function_ctor(char *function_name);
 void xdebug_coverage_function_dtor(void *data);
@@ -50,6 +56,8 @@ void xdebug_code_coverage_end_of_function(zend_op_array *op_array, zend_string *
 PHP_FUNCTION(xdebug_start_code_coverage);
 PHP_FUNCTION(xdebug_stop_code_coverage);
 PHP_FUNCTION(xdebug_get_code_coverage);
+PHP_FUNCTION(xdebug_get_code_coverage_delta);
+PHP_FUNCTION(xdebug_get_code_coverage_summary);
 PHP_FUNCTION(xdebug_code_coverage_started);
 
 PHP_FUNCTION(xdebug_get_function_count);
@@ -0,0 +1,167 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#include "lib/php-header.h"
+
+#include "php_xdebug.h"
+#include "contexts.h"
+#include "code_coverage_private.h"
+
+#include "lib/lib.h"
+#include "lib/str.h"
+
+ZEND_EXTERN_MODULE_GLOBALS(xdebug)
+
+static void insert_run(xdebug_coverage_contexts *contexts, uint32_t position, uint32_t id)
+{
+	if (contexts->count == contexts->size) {
+		contexts->size = contexts->size ? contexts->size * 2 : 4;
+		contexts->runs = xdrealloc(contexts->runs, contexts->size * sizeof(xdebug_coverage_context_run));
+	}
+
+	memmove(&contexts->runs[position + 1], &contexts->runs[position], (contexts->count - position) * sizeof(xdebug_coverage_context_run));
+	contexts->runs[position].first = id;
+	contexts->runs[position].last = id;
+	contexts->count++;
+}
+
+void xdebug_coverage_contexts_add(xdebug_coverage_contexts **contexts_ptr, uint32_t id)
+{
+	xdebug_coverage_contexts    *contexts = *contexts_ptr;
+	xdebug_coverage_context_run *run;
+	uint32_t                     low, high;
+
+	if (!contexts) {
+		contexts = xdcalloc(1, sizeof(xdebug_coverage_contexts));
+		*contexts_ptr = contexts;
+	}
+	contexts->last_added = id;
+
+	/* Find the first run that ends at, or just before, the ID */
+	low = 0;
+	high = contexts->count;
+	while (low < high) {
+		uint32_t middle = low + (high - low) / 2;
+
+		if ((uint64_t) contexts->runs[middle].last + 1 < id) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	if (low == contexts->count || contexts->runs[low].first > (uint64_t) id + 1) {
+		insert_run(contexts, low, id);
+		return;
+	}
+
+	run = &contexts->runs[low];
+	if (id < run->first) {
+		run->first = id;
+	} else if (id > run->last) {
+		run->last = id;
+
+		/* Merge with the next run, if the ID closed the gap */
+		if (low + 1 < contexts->count && contexts->runs[low + 1].first == (uint64_t) id + 1) {
+			run->last = contexts->runs[low + 1].last;
+			memmove(&contexts->runs[low + 1], &contexts->runs[low + 2], (contexts->count - low - 2) * sizeof(xdebug_coverage_context_run));
+			contexts->count--;
+		}
+	}
+}
+
+void xdebug_coverage_contexts_free(xdebug_coverage_contexts *contexts)
+{
+	if (contexts->runs) {
+		xdfree(contexts->runs);
+	}
+	xdfree(contexts);
+}
+
+/* {{{ proto void xdebug_set_coverage_context(int id)
+   Sets the ID that lines are attributed to when they are executed, or stops attributing lines with a negative ID */
+PHP_FUNCTION(xdebug_set_coverage_context)
+{
+	zend_long id;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "l", &id) == FAILURE) {
+		return;
+	}
+
+	if (id >= 0 && (uint64_t) id > UINT32_MAX) {
+		php_error(E_WARNING, "The coverage context ID must be less than or equal to %u", UINT32_MAX);
+		return;
+	}
+
+	XG_COV(context_id) = id < 0 ? -1 : id;
+}
+/* }}} */
+
+static void add_contexts_string(zval *lines, int lineno, xdebug_coverage_contexts *contexts)
+{
+	xdebug_str ids = XDEBUG_STR_INITIALIZER;
+	uint32_t   i;
+
+	for (i = 0; i < contexts->count; i++) {
+		if (i) {
+			xdebug_str_addc(&ids, ',');
+		}
+		if (contexts->runs[i].first == contexts->runs[i].last) {
+			xdebug_str_add_fmt(&ids, "%u", contexts->runs[i].first);
+		} else {
+			xdebug_str_add_fmt(&ids, "%u-%u", contexts->runs[i].first, contexts->runs[i].last);
+		}
+	}
+
+	add_index_stringl(lines, lineno, ids.d, ids.l);
+	xdebug_str_destroy(&ids);
+}
+
+static void add_file_contexts(void *ret, xdebug_hash_element *e)
+{
+	xdebug_coverage_file *file = (xdebug_coverage_file*) e->ptr;
+	zval                 *retval = (zval*) ret;
+	zval                  lines;
+	int                   i;
+
+	array_init(&lines);
+
+	for (i = 0; i < file->lines_size; i++) {
+		if (file->lines[i].contexts) {
+			add_contexts_string(&lines, file->lines_start + i, file->lines[i].contexts);
+		}
+	}
+
+	if (zend_hash_num_elements(Z_ARRVAL(lines)) == 0) {
+		zval_ptr_dtor(&lines);
+		return;
+	}
+
+	add_assoc_zval_ex(retval, ZSTR_VAL(file->name), ZSTR_LEN(file->name), &lines);
+}
+
+/* {{{ proto array xdebug_get_code_coverage_contexts()
+   Returns, for each executed line, the context IDs that executed it as a list of ranges, such as "1-4,9" */
+PHP_FUNCTION(xdebug_get_code_coverage_contexts)
+{
+	array_init(return_value);
+
+	if (!XG_COV(code_coverage_info)) {
+		return;
+	}
+
+	xdebug_hash_apply(XG_COV(code_coverage_info), (void *) return_value, add_file_contexts);
+}
+/* }}} */
@@ -0,0 +1,42 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#ifndef __XDEBUG_COVERAGE_CONTEXTS_H__
+#define __XDEBUG_COVERAGE_CONTEXTS_H__
+
+#include "lib/php-header.h"
+
+typedef struct _xdebug_coverage_context_run {
+	uint32_t first;
+	uint32_t last;
+} xdebug_coverage_context_run;
+
+/* The context IDs (as set with xdebug_set_coverage_context()) that executed a
+ * line, stored as sorted runs of consecutive IDs. Test suites hand out IDs in
+ * order, so a line that many tests execute usually needs only a few runs. */
+typedef struct _xdebug_coverage_contexts {
+	uint32_t                     count;
+	uint32_t                     size;
+	zend_long                    last_added;
+	xdebug_coverage_context_run *runs;
+} xdebug_coverage_contexts;
+
+void xdebug_coverage_contexts_add(xdebug_coverage_contexts **contexts, uint32_t id);
+void xdebug_coverage_contexts_free(xdebug_coverage_contexts *contexts);
+
+PHP_FUNCTION(xdebug_set_coverage_context);
+PHP_FUNCTION(xdebug_get_code_coverage_contexts);
+
+#endif
@@ -0,0 +1,560 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#include "lib/php-header.h"
+
+#include "php_xdebug.h"
+#include "dump.h"
+#include "code_coverage_private.h"
+
+#include "lib/lib.h"
+#include "lib/str.h"
+#include "lib/var.h"
+
+ZEND_EXTERN_MODULE_GLOBALS(xdebug)
+
+/* xdebug_dump_code_coverage() writes the coverage data straight from the
+ * internal structures, without building the arrays that
+ * xdebug_get_code_coverage() returns.
+ *
+ * The binary format stores all numbers as little endian, and strings as a
+ * uint32 length followed by the bytes:
+ *
+ *   "XDCOVBIN", uint32 version, uint32 flags (1: has branch info), uint32 file count
+ *   per file:
+ *     string name, uint32 line count
+ *     per line: uint32 line number, int32 hits (-1: not executed, -2: dead code)
+ *     with branch info: uint32 function count
+ *     per function:
+ *       string name, uint32 branch count
+ *       per branch:
+ *         uint32 op_start, op_end, line_start, line_end, uint8 hit, uint32 out count
+ *         per out: uint32 index, uint32 op nr, uint8 hit
+ *       uint8 paths truncated, uint32 path count
+ *       per path: uint32 branch count, uint32 op_start per branch, uint8 hit
+ */
+
+#define XDEBUG_CC_DUMP_MAGIC   "XDCOVBIN"
+#define XDEBUG_CC_DUMP_VERSION 1
+
+#define XDEBUG_CC_DUMP_FLUSH_SIZE 65536
+
+typedef struct _dump_writer {
+	php_stream *stream;
+	xdebug_str  buffer;
+	bool        failed;
+} dump_writer;
+
+typedef struct _sorted_elements {
+	xdebug_hash_element **elements;
+	size_t                count;
+} sorted_elements;
+
+static void writer_flush(dump_writer *writer)
+{
+	if (writer->buffer.l && !writer->failed) {
+		if (php_stream_write(writer->stream, writer->buffer.d, writer->buffer.l) != writer->buffer.l) {
+			writer->failed = true;
+		}
+	}
+	writer->buffer.l = 0;
+}
+
+static void writer_check_flush(dump_writer *writer)
+{
+	if (writer->buffer.l >= XDEBUG_CC_DUMP_FLUSH_SIZE) {
+		writer_flush(writer);
+	}
+}
+
+static void write_u8(dump_writer *writer, uint8_t value)
+{
+	xdebug_str_addc(&writer->buffer, (char) value);
+}
+
+static void write_u32(dump_writer *writer, uint32_t value)
+{
+	char bytes[4];
+
+	bytes[0] = value & 0xff;
+	bytes[1] = (value >> 8) & 0xff;
+	bytes[2] = (value >> 16) & 0xff;
+	bytes[3] = (value >> 24) & 0xff;
+
+	xdebug_str_addl(&writer->buffer, bytes, 4, 0);
+}
+
+static void write_string(dump_writer *writer, const char *value, size_t length)
+{
+	write_u32(writer, (uint32_t) length);
+	xdebug_str_addl(&writer->buffer, value, length, 0);
+}
+
+static void collect_element(void *user, xdebug_hash_element *he)
+{
+	sorted_elements *list = (sorted_elements*) user;
+
+	list->elements[list->count++] = he;
+}
+
+static int compare_file_elements(const void *a, const void *b)
+{
+	xdebug_coverage_file *file_a = (xdebug_coverage_file*) (*(xdebug_hash_element**) a)->ptr;
+	xdebug_coverage_file *file_b = (xdebug_coverage_file*) (*(xdebug_hash_element**) b)->ptr;
+
+	return strcmp(ZSTR_VAL(file_a->name), ZSTR_VAL(file_b->name));
+}
+
+static int compare_function_elements(const void *a, const void *b)
+{
+	xdebug_coverage_function *function_a = (xdebug_coverage_function*) (*(xdebug_hash_element**) a)->ptr;
+	xdebug_coverage_function *function_b = (xdebug_coverage_function*) (*(xdebug_hash_element**) b)->ptr;
+
+	return strcmp(function_a->name, function_b->name);
+}
+
+/* Returns the hash's elements, sorted so that dumps are reproducible */
+static void sort_elements(xdebug_hash *hash, sorted_elements *list, int (*compare)(const void *, const void *))
+{
+	list->count = 0;
+	list->elements = xdmalloc((hash->size + 1) * sizeof(xdebug_hash_element*));
+
+	xdebug_hash_apply(hash, (void*) list, collect_element);
+	qsort(list->elements, list->count, sizeof(xdebug_hash_element*), compare);
+}
+
+/* The same values as in the lines array of xdebug_get_code_coverage(), but
+ * with the number of times each executed line was hit */
+static int line_hits(xdebug_coverage_line *line)
+{
+	if (line->executable && line->count == 0) {
+		return -line->executable;
+	}
+
+	return line->count > 0 ? line->count : 1;
+}
+
+static uint32_t count_seen_lines(xdebug_coverage_file *file)
+{
+	uint32_t count = 0;
+	int      i;
+
+	for (i = 0; i < file->lines_size; i++) {
+		if (file->lines[i].seen) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static void dump_binary_function(dump_writer *writer, xdebug_coverage_function *function)
+{
+	xdebug_branch_info *branch_info = function->branch_info;
+	unsigned int        i, j, branch_count = 0;
+
+	write_string(writer, function->name, strlen(function->name));
+
+	if (!branch_info) {
+		write_u32(writer, 0);
+		write_u8(writer, 0);
+		write_u32(writer, 0);
+		return;
+	}
+
+	for (i = 0; i < branch_info->starts->size; i++) {
+		if (xdebug_set_in(branch_info->starts, i)) {
+			branch_count++;
+		}
+	}
+
+	write_u32(writer, branch_count);
+	for (i = 0; i < branch_info->starts->size; i++) {
+		xdebug_branch *branch = &branch_info->branches[i];
+		uint32_t       outs_count = 0;
+
+		if (!xdebug_set_in(branch_info->starts, i)) {
+			continue;
+		}
+
+		write_u32(writer, i);
+		write_u32(writer, branch->end_op);
+		write_u32(writer, branch->start_lineno);
+		write_u32(writer, branch->end_lineno);
+		write_u8(writer, branch->hit);
+
+		for (j = 0; j < branch->outs_count; j++) {
+			if (branch->outs[j]) {
+				outs_count++;
+			}
+		}
+		write_u32(writer, outs_count);
+		for (j = 0; j < branch->outs_count; j++) {
+			if (branch->outs[j]) {
+				write_u32(writer, j);
+				write_u32(writer, branch->outs[j]);
+				write_u8(writer, branch->outs_hit[j]);
+			}
+		}
+		writer_check_flush(writer);
+	}
+
+	write_u8(writer, branch_info->path_info.truncated);
+	write_u32(writer, branch_info->path_info.paths_count);
+	for (i = 0; i < branch_info->path_info.paths_count; i++) {
+		xdebug_path *path = branch_info->path_info.paths[i];
+
+		write_u32(writer, path->elements_count);
+		for (j = 0; j < path->elements_count; j++) {
+			write_u32(writer, path->elements[j]);
+		}
+		write_u8(writer, path->hit);
+		writer_check_flush(writer);
+	}
+}
+
+static void dump_binary_file(dump_writer *writer, xdebug_coverage_file *file)
+{
+	int i;
+
+	write_string(writer, ZSTR_VAL(file->name), ZSTR_LEN(file->name));
+
+	write_u32(writer, count_seen_lines(file));
+	for (i = 0; i < file->lines_size; i++) {
+		if (file->lines[i].seen) {
+			write_u32(writer, file->lines_start + i);
+			write_u32(writer, (uint32_t) line_hits(&file->lines[i]));
+		}
+	}
+	writer_check_flush(writer);
+
+	if (XG_COV(code_coverage_branch_check)) {
+		sorted_elements functions;
+		size_t          j;
+
+		sort_elements(file->functions, &functions, compare_function_elements);
+
+		write_u32(writer, functions.count);
+		for (j = 0; j < functions.count; j++) {
+			dump_binary_function(writer, (xdebug_coverage_function*) functions.elements[j]->ptr);
+		}
+
+		xdfree(functions.elements);
+	}
+}
+
+/* Function line numbers and hits come from the function's entry branch, as
+ * that is the only place where they are known */
+static bool function_entry(xdebug_coverage_function *function, unsigned int *lineno, bool *hit)
+{
+	if (!function->branch_info || !function->branch_info->size || !xdebug_set_in(function->branch_info->starts, 0)) {
+		return false;
+	}
+
+	*lineno = function->branch_info->branches[0].start_lineno;
+	*hit = function->branch_info->branches[0].hit;
+
+	return true;
+}
+
+static void dump_lcov_branches(dump_writer *writer, xdebug_coverage_function *function, unsigned int *found, unsigned int *hit)
+{
+	xdebug_branch_info *branch_info = function->branch_info;
+	unsigned int        i, j;
+
+	if (!branch_info) {
+		return;
+	}
+
+	for (i = 0; i < branch_info->starts->size; i++) {
+		xdebug_branch *branch = &branch_info->branches[i];
+
+		/* Only branches with more than one way out are decisions */
+		if (!xdebug_set_in(branch_info->starts, i) || branch->outs_count < 2) {
+			continue;
+		}
+
+		for (j = 0; j < branch->outs_count; j++) {
+			if (!branch->outs[j]) {
+				continue;
+			}
+
+			(*found)++;
+			if (branch->outs_hit[j]) {
+				(*hit)++;
+			}
+
+			if (branch->hit) {
+				xdebug_str_add_fmt(&writer->buffer, "BRDA:%u,%u,%u,%d\n", branch->end_lineno, i, j, branch->outs_hit[j] ? 1 : 0);
+			} else {
+				xdebug_str_add_fmt(&writer->buffer, "BRDA:%u,%u,%u,-\n", branch->end_lineno, i, j);
+			}
+		}
+	}
+}
+
+static void dump_lcov_file(dump_writer *writer, xdebug_coverage_file *file)
+{
+	unsigned int lines_found = 0, lines_hit = 0;
+	int          i;
+
+	xdebug_str_add_literal(&writer->buffer, "TN:\n");
+	xdebug_str_add_literal(&writer->buffer, "SF:");
+	xdebug_str_add_zstr(&writer->buffer, file->name);
+	xdebug_str_addc(&writer->buffer, '\n');
+
+	if (XG_COV(code_coverage_branch_check)) {
+		sorted_elements functions;
+		unsigned int    functions_found = 0, functions_hit = 0, branches_found = 0, branches_hit = 0;
+		size_t          j;
+
+		sort_elements(file->functions, &functions, compare_function_elements);
+
+		for (j = 0; j < functions.count; j++) {
+			xdebug_coverage_function *function = (xdebug_coverage_function*) functions.elements[j]->ptr;
+			unsigned int              lineno;
+			bool                      hit;
+
+			if (function_entry(function, &lineno, &hit)) {
+				xdebug_str_add_fmt(&writer->buffer, "FN:%u,%s\n", lineno, function->name);
+			}
+		}
+		for (j = 0; j < functions.count; j++) {
+			xdebug_coverage_function *function = (xdebug_coverage_function*) functions.elements[j]->ptr;
+			unsigned int              lineno;
+			bool                      hit;
+
+			if (function_entry(function, &lineno, &hit)) {
+				xdebug_str_add_fmt(&writer->buffer, "FNDA:%d,%s\n", hit ? 1 : 0, function->name);
+				functions_found++;
+				if (hit) {
+					functions_hit++;
+				}
+			}
+		}
+		xdebug_str_add_fmt(&writer->buffer, "FNF:%u\nFNH:%u\n", functions_found, functions_hit);
+
+		for (j = 0; j < functions.count; j++) {
+			dump_lcov_branches(writer, (xdebug_coverage_function*) functions.elements[j]->ptr, &branches_found, &branches_hit);
+			writer_check_flush(writer);
+		}
+		xdebug_str_add_fmt(&writer->buffer, "BRF:%u\nBRH:%u\n", branches_found, branches_hit);
+
+		xdfree(functions.elements);
+	}
+
+	for (i = 0; i < file->lines_size; i++) {
+		int hits;
+
+		if (!file->lines[i].seen) {
+			continue;
+		}
+
+		hits = line_hits(&file->lines[i]);
+		if (hits == -2) {
+			continue;
+		}
+
+		lines_found++;
+		if (hits > 0) {
+			lines_hit++;
+		}
+		xdebug_str_add_fmt(&writer->buffer, "DA:%d,%d\n", file->lines_start + i, hits > 0 ? hits : 0);
+		writer_check_flush(writer);
+	}
+
+	xdebug_str_add_fmt(&writer->buffer, "LF:%u\nLH:%u\nend_of_record\n", lines_found, lines_hit);
+}
+
+typedef struct _clover_totals {
+	unsigned int statements;
+	unsigned int covered_statements;
+	unsigned int methods;
+	unsigned int covered_methods;
+} clover_totals;
+
+static void dump_clover_metrics(dump_writer *writer, const char *indent, clover_totals *totals, size_t files)
+{
+	xdebug_str_add_fmt(&writer->buffer, "%s<metrics", indent);
+	if (files) {
+		xdebug_str_add_fmt(&writer->buffer, " files=\"%zu\"", files);
+	}
+	xdebug_str_add_fmt(
+		&writer->buffer,
+		" methods=\"%u\" coveredmethods=\"%u\" statements=\"%u\" coveredstatements=\"%u\" elements=\"%u\" coveredelements=\"%u\"/>\n",
+		totals->methods, totals->covered_methods, totals->statements, totals->covered_statements,
+		totals->methods + totals->statements, totals->covered_methods + totals->covered_statements
+	);
+}
+
+static void dump_clover_file(dump_writer *writer, xdebug_coverage_file *file, clover_totals *project_totals)
+{
+	clover_totals totals = { 0, 0, 0, 0 };
+	char         *name;
+	size_t        name_len;
+	int           i;
+
+	name = xdebug_xmlize(ZSTR_VAL(file->name), ZSTR_LEN(file->name), &name_len);
+	xdebug_str_add_fmt(&writer->buffer, "    <file name=\"%s\">\n", name);
+	efree(name);
+
+	if (XG_COV(code_coverage_branch_check)) {
+		sorted_elements functions;
+		size_t          j;
+
+		sort_elements(file->functions, &functions, compare_function_elements);
+
+		for (j = 0; j < functions.count; j++) {
+			xdebug_coverage_function *function = (xdebug_coverage_function*) functions.elements[j]->ptr;
+			unsigned int              lineno;
+			bool                      hit;
+			char                     *function_name;
+
+			if (!function_entry(function, &lineno, &hit)) {
+				continue;
+			}
+
+			totals.methods++;
+			if (hit) {
+				totals.covered_methods++;
+			}
+
+			function_name = xdebug_xmlize(function->name, strlen(function->name), &name_len);
+			xdebug_str_add_fmt(&writer->buffer, "      <line num=\"%u\" type=\"method\" name=\"%s\" count=\"%d\"/>\n", lineno, function_name, hit ? 1 : 0);
+			efree(function_name);
+		}
+
+		xdfree(functions.elements);
+	}
+
+	for (i = 0; i < file->lines_size; i++) {
+		int hits;
+
+		if (!file->lines[i].seen) {
+			continue;
+		}
+
+		hits = line_hits(&file->lines[i]);
+		if (hits == -2) {
+			continue;
+		}
+
+		totals.statements++;
+		if (hits > 0) {
+			totals.covered_statements++;
+		}
+		xdebug_str_add_fmt(&writer->buffer, "      <line num=\"%d\" type=\"stmt\" count=\"%d\"/>\n", file->lines_start + i, hits > 0 ? hits : 0);
+		writer_check_flush(writer);
+	}
+
+	dump_clover_metrics(writer, "      ", &totals, 0);
+	xdebug_str_add_literal(&writer->buffer, "    </file>\n");
+
+	project_totals->statements += totals.statements;
+	project_totals->covered_statements += totals.covered_statements;
+	project_totals->methods += totals.methods;
+	project_totals->covered_methods += totals.covered_methods;
+}
+
+static void dump_coverage(dump_writer *writer, zend_long format)
+{
+	sorted_elements files;
+	clover_totals   project_totals = { 0, 0, 0, 0 };
+	size_t          i;
+	time_t          now = time(NULL);
+
+	sort_elements(XG_COV(code_coverage_info), &files, compare_file_elements);
+
+	switch (format) {
+		case XDEBUG_CC_DUMP_BINARY:
+			xdebug_str_addl(&writer->buffer, XDEBUG_CC_DUMP_MAGIC, strlen(XDEBUG_CC_DUMP_MAGIC), 0);
+			write_u32(writer, XDEBUG_CC_DUMP_VERSION);
+			write_u32(writer, XG_COV(code_coverage_branch_check) ? 1 : 0);
+			write_u32(writer, files.count);
+			break;
+
+		case XDEBUG_CC_DUMP_CLOVER:
+			xdebug_str_add_literal(&writer->buffer, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+			xdebug_str_add_fmt(&writer->buffer, "<coverage generated=\"%ld\">\n  <project timestamp=\"%ld\">\n", (long) now, (long) now);
+			break;
+	}
+
+	for (i = 0; i < files.count; i++) {
+		xdebug_coverage_file *file = (xdebug_coverage_file*) files.elements[i]->ptr;
+
+		switch (format) {
+			case XDEBUG_CC_DUMP_BINARY:
+				dump_binary_file(writer, file);
+				break;
+
+			case XDEBUG_CC_DUMP_LCOV:
+				dump_lcov_file(writer, file);
+				break;
+
+			case XDEBUG_CC_DUMP_CLOVER:
+				dump_clover_file(writer, file, &project_totals);
+				break;
+		}
+		writer_check_flush(writer);
+	}
+
+	if (format == XDEBUG_CC_DUMP_CLOVER) {
+		dump_clover_metrics(writer, "    ", &project_totals, files.count);
+		xdebug_str_add_literal(&writer->buffer, "  </project>\n</coverage>\n");
+	}
+
+	xdfree(files.elements);
+}
+
+/* {{{ proto bool xdebug_dump_code_coverage(string file [, int format])
+   Writes the collected code coverage to a file, in Xdebug's binary format, as LCOV, or as Clover XML */
+PHP_FUNCTION(xdebug_dump_code_coverage)
+{
+	char        *filename;
+	size_t       filename_len;
+	zend_long    format = XDEBUG_CC_DUMP_BINARY;
+	dump_writer  writer;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "p|l", &filename, &filename_len, &format) == FAILURE) {
+		return;
+	}
+
+	if (format != XDEBUG_CC_DUMP_BINARY && format != XDEBUG_CC_DUMP_LCOV && format != XDEBUG_CC_DUMP_CLOVER) {
+		php_error(E_WARNING, "The format must be one of XDEBUG_CC_DUMP_BINARY, XDEBUG_CC_DUMP_LCOV, or XDEBUG_CC_DUMP_CLOVER");
+		RETURN_FALSE;
+	}
+
+	if (!XG_COV(code_coverage_info)) {
+		RETURN_FALSE;
+	}
+
+	writer.stream = php_stream_open_wrapper(filename, "wb", REPORT_ERRORS, NULL);
+	if (!writer.stream) {
+		RETURN_FALSE;
+	}
+	writer.buffer.l = 0;
+	writer.buffer.a = 0;
+	writer.buffer.d = NULL;
+	writer.failed = false;
+
+	dump_coverage(&writer, format);
+	writer_flush(&writer);
+
+	xdebug_str_destroy(&writer.buffer);
+	php_stream_close(writer.stream);
+
+	RETURN_BOOL(!writer.failed);
+}
+/* }}} */
@@ -0,0 +1,494 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#include "lib/php-header.h"
+
+#include "php_xdebug.h"
+#include "shared.h"
+#include "code_coverage_private.h"
+
+#include "lib/hash.h"
+#include "lib/log.h"
+#include "lib/mm.h"
+
+#if !defined(PHP_WIN32) && !defined(ZTS)
+# include <errno.h>
+# include <fcntl.h>
+# include <sys/file.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# define XDEBUG_COVERAGE_SHARED_SUPPORTED 1
+#endif
+
+ZEND_EXTERN_MODULE_GLOBALS(xdebug)
+
+/* How often, in seconds, a process asks for the mapped file to be written out,
+ * and checks the files it has seen for changes */
+#define XDEBUG_COVERAGE_SHARED_SYNC_INTERVAL 60
+
+#ifdef XDEBUG_COVERAGE_SHARED_SUPPORTED
+/* The mapping is made before PHP-FPM (or any other pre-forking SAPI) forks
+ * its workers, so that they all share it.
+ *
+ * The workers also inherit 'fd', and with it a single open file description,
+ * on which flock() would not keep them out of each other's way. Each process
+ * therefore takes the lock on its own descriptor, 'lock_fd', which it opens
+ * the first time it needs the lock. */
+static struct {
+	int                            fd;
+	char                          *path;
+	int                            lock_fd;
+	pid_t                          lock_pid;
+	size_t                         size;
+	xdebug_coverage_shared_header *header;
+	xdebug_coverage_shared_entry  *entries;
+	uint64_t                      *bitmaps;
+	time_t                         last_sync;
+} shared = { -1, NULL, -1, 0, 0, NULL, NULL, NULL, 0 };
+
+static size_t mapping_size(uint32_t max_files, uint32_t max_words)
+{
+	return sizeof(xdebug_coverage_shared_header) + (size_t) max_files * XDEBUG_COVERAGE_SHARED_ENTRY_SIZE + (size_t) max_words * sizeof(uint64_t);
+}
+
+static bool open_shared_file(const char *path)
+{
+	xdebug_coverage_shared_header header;
+	struct stat                   st;
+	bool                          created = false;
+	void                         *map;
+
+	shared.fd = open(path, O_RDWR | O_CREAT, 0666);
+	if (shared.fd == -1) {
+		xdebug_log_ex(XLOG_CHAN_COVERAGE, XLOG_ERR, "SHARED", "Can not open shared coverage file '%s': %s.", path, strerror(errno));
+		return false;
+	}
+
+	/* Another process could be creating the file at the same time */
+	flock(shared.fd, LOCK_EX);
+
+	if (fstat(shared.fd, &st) == -1) {
+		goto failure;
+	}
+
+	if (st.st_size == 0) {
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, XDEBUG_COVERAGE_SHARED_MAGIC, sizeof(header.magic));
+		header.version = XDEBUG_COVERAGE_SHARED_VERSION;
+		header.max_files = XDEBUG_COVERAGE_SHARED_MAX_FILES;
+		header.max_words = XDEBUG_COVERAGE_SHARED_MAX_WORDS;
+		header.entry_size = XDEBUG_COVERAGE_SHARED_ENTRY_SIZE;
+
+		/* The file is sparse, so unused entries and bitmaps take no disk space */
+		if (ftruncate(shared.fd, mapping_size(header.max_files, header.max_words)) == -1) {
+			goto failure;
+		}
+		created = true;
+	} else if (
+		pread(shared.fd, &header, sizeof(header), 0) != sizeof(header) ||
+		memcmp(header.magic, XDEBUG_COVERAGE_SHARED_MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != XDEBUG_COVERAGE_SHARED_VERSION ||
+		header.entry_size != XDEBUG_COVERAGE_SHARED_ENTRY_SIZE ||
+		(size_t) st.st_size < mapping_size(header.max_files, header.max_words)
+	) {
+		xdebug_log_ex(XLOG_CHAN_COVERAGE, XLOG_ERR, "SHARED", "The file '%s' is not a shared coverage file of this version.", path);
+		goto close_file;
+	}
+
+	shared.size = mapping_size(header.max_files, header.max_words);
+	map = mmap(NULL, shared.size, PROT_READ | PROT_WRITE, MAP_SHARED, shared.fd, 0);
+	if (map == MAP_FAILED) {
+		goto failure;
+	}
+
+	shared.header = (xdebug_coverage_shared_header*) map;
+	shared.entries = (xdebug_coverage_shared_entry*) ((char*) map + sizeof(xdebug_coverage_shared_header));
+	shared.bitmaps = (uint64_t*) ((char*) shared.entries + (size_t) header.max_files * XDEBUG_COVERAGE_SHARED_ENTRY_SIZE);
+	shared.last_sync = time(NULL);
+	shared.path = strdup(path);
+	shared.lock_fd = shared.fd;
+	shared.lock_pid = getpid();
+
+	if (created) {
+		memcpy(shared.header, &header, sizeof(header));
+	}
+
+	flock(shared.fd, LOCK_UN);
+	return true;
+
+failure:
+	xdebug_log_ex(XLOG_CHAN_COVERAGE, XLOG_ERR, "SHARED", "Can not map shared coverage file '%s': %s.", path, strerror(errno));
+
+close_file:
+	flock(shared.fd, LOCK_UN);
+	close(shared.fd);
+	shared.fd = -1;
+	return false;
+}
+
+/* Counts the lines in the source file, so that its bitmap has room for lines
+ * that no request has executed yet */
+static uint32_t count_source_lines(const char *path)
+{
+	char     buffer[65536];
+	ssize_t  n, i;
+	uint32_t lines = 1;
+	int      fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		return 0;
+	}
+
+	while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+		for (i = 0; i < n; i++) {
+			if (buffer[i] == '\n') {
+				lines++;
+			}
+		}
+	}
+	close(fd);
+
+	return lines;
+}
+
+/* Opens a descriptor of this process' own when it is not the one that mapped
+ * the file, and makes sure that it still refers to the mapped file */
+static bool lock_shared_file(void)
+{
+	struct stat mapped_st, lock_st;
+
+	if (shared.lock_pid != getpid()) {
+		if (shared.lock_fd != -1 && shared.lock_fd != shared.fd) {
+			close(shared.lock_fd);
+		}
+		shared.lock_pid = getpid();
+		shared.lock_fd = open(shared.path, O_RDWR);
+
+		if (
+			shared.lock_fd != -1 && (
+				fstat(shared.fd, &mapped_st) == -1 ||
+				fstat(shared.lock_fd, &lock_st) == -1 ||
+				mapped_st.st_dev != lock_st.st_dev ||
+				mapped_st.st_ino != lock_st.st_ino
+			)
+		) {
+			close(shared.lock_fd);
+			shared.lock_fd = -1;
+			errno = ESTALE;
+		}
+
+		if (shared.lock_fd == -1) {
+			xdebug_log_ex(XLOG_CHAN_COVERAGE, XLOG_ERR, "SHARED", "Can not lock shared coverage file '%s': %s.", shared.path, strerror(errno));
+		}
+	}
+
+	if (shared.lock_fd == -1) {
+		return false;
+	}
+
+	while (flock(shared.lock_fd, LOCK_EX) == -1) {
+		if (errno != EINTR) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void unlock_shared_file(void)
+{
+	flock(shared.lock_fd, LOCK_UN);
+}
+
+/* Needs the lock */
+static xdebug_coverage_shared_entry *find_named_entry(zend_string *name)
+{
+	uint32_t i;
+
+	for (i = 0; i < shared.header->file_count; i++) {
+		if (
+			shared.entries[i].name_len == ZSTR_LEN(name) &&
+			memcmp(shared.entries[i].name, ZSTR_VAL(name), ZSTR_LEN(name)) == 0
+		) {
+			return &shared.entries[i];
+		}
+	}
+
+	return NULL;
+}
+
+static bool entry_is_current(xdebug_coverage_shared_entry *entry, uint64_t size, uint64_t mtime)
+{
+	return entry->source_size == size && entry->source_mtime == mtime;
+}
+
+/* Finds or adds the file's entry. When the source file has changed since its
+ * entry was made, the lines in its bitmap no longer mean anything, so the
+ * bitmap is cleared, or replaced by a new one if the file got too long for it. */
+static xdebug_coverage_shared_entry *register_file(xdebug_coverage_file *file)
+{
+	xdebug_coverage_shared_entry *entry;
+	struct stat                   st;
+	uint64_t                      size = 0, mtime = 0;
+	uint32_t                      line_count, words;
+
+	if (stat(ZSTR_VAL(file->name), &st) == 0) {
+		size = (uint64_t) st.st_size;
+		mtime = (uint64_t) st.st_mtime;
+	}
+
+	if (!lock_shared_file()) {
+		return NULL;
+	}
+	entry = find_named_entry(file->name);
+	unlock_shared_file();
+
+	if (entry && entry_is_current(entry, size, mtime)) {
+		return entry;
+	}
+
+	/* The source file is read without holding the lock that all processes
+	 * need. Bit 0 stands for line 0, so the bitmap needs one more bit than
+	 * there are lines. */
+	line_count = MAX(count_source_lines(ZSTR_VAL(file->name)), (uint32_t) (file->lines_start + file->lines_size)) + 1;
+	words = (line_count + 63) / 64;
+
+	if (!lock_shared_file()) {
+		return NULL;
+	}
+
+	/* Another process could have added or updated the entry in the meantime */
+	entry = find_named_entry(file->name);
+	if (entry && entry_is_current(entry, size, mtime)) {
+		goto done;
+	}
+
+	if (!entry) {
+		if (shared.header->file_count >= shared.header->max_files) {
+			goto done;
+		}
+		if (words > shared.header->max_words - shared.header->words_used) {
+			xdebug_log_ex(XLOG_CHAN_COVERAGE, XLOG_WARN, "SHARED", "The shared coverage file has no room left for '%s'.", ZSTR_VAL(file->name));
+			goto done;
+		}
+
+		entry = &shared.entries[shared.header->file_count];
+		entry->bitmap_offset = shared.header->words_used;
+		entry->line_count = words * 64;
+		entry->name_len = ZSTR_LEN(file->name);
+		memcpy(entry->name, ZSTR_VAL(file->name), ZSTR_LEN(file->name));
+
+		shared.header->words_used += words;
+		shared.header->file_count++;
+	} else if (words <= entry->line_count / 64 || words > shared.header->max_words - shared.header->words_used) {
+		if (words > entry->line_count / 64) {
+			xdebug_log_ex(XLOG_CHAN_COVERAGE, XLOG_WARN, "SHARED", "The shared coverage file has no room left for the new lines of '%s'.", ZSTR_VAL(file->name));
+		}
+		memset(shared.bitmaps + entry->bitmap_offset, 0, (entry->line_count / 64) * sizeof(uint64_t));
+	} else {
+		/* The old bitmap is left unused. merge_file() reads line_count before
+		 * bitmap_offset, so that it never sees the new size with the old
+		 * offset. */
+		entry->bitmap_offset = shared.header->words_used;
+		__sync_synchronize();
+		entry->line_count = words * 64;
+
+		shared.header->words_used += words;
+	}
+
+	entry->source_size = size;
+	entry->source_mtime = mtime;
+
+done:
+	unlock_shared_file();
+	return entry;
+}
+
+/* Looks up the file's entry in the shared table. Every process remembers the
+ * positions of entries, until its next sync, so that it only checks each file
+ * for changes once per XDEBUG_COVERAGE_SHARED_SYNC_INTERVAL */
+static xdebug_coverage_shared_entry *find_entry(xdebug_coverage_file *file)
+{
+	void                         *index;
+	xdebug_coverage_shared_entry *entry;
+
+	if (!XG_COV(shared_index)) {
+		XG_COV(shared_index) = xdebug_hash_alloc(256, NULL);
+	}
+
+	if (xdebug_hash_find(XG_COV(shared_index), ZSTR_VAL(file->name), ZSTR_LEN(file->name), &index)) {
+		return index ? &shared.entries[(size_t) index - 1] : NULL;
+	}
+
+	entry = NULL;
+	if (ZSTR_LEN(file->name) <= XDEBUG_COVERAGE_SHARED_NAME_SIZE) {
+		entry = register_file(file);
+	}
+
+	/* Files that did not fit are remembered too, so that they are not tried again */
+	xdebug_hash_add(XG_COV(shared_index), ZSTR_VAL(file->name), ZSTR_LEN(file->name), entry ? (void*) (size_t) (entry - shared.entries + 1) : NULL);
+
+	return entry;
+}
+
+static void or_word(uint64_t *target, uint64_t bits)
+{
+	/* Once a line has been seen, there is nothing to write */
+	if ((*target & bits) != bits) {
+		__sync_fetch_and_or(target, bits);
+	}
+}
+
+/* ORs the lines that were executed in this request into the file's bitmap, a
+ * word at a time */
+static void merge_file(xdebug_coverage_file *file)
+{
+	xdebug_coverage_shared_entry *entry;
+	uint64_t                     *bitmap;
+	uint64_t                      bits = 0;
+	uint32_t                      line_count, word_nr = 0;
+	int                           i;
+
+	if (!file->lines_size || !(entry = find_entry(file))) {
+		return;
+	}
+	line_count = entry->line_count;
+	__sync_synchronize();
+	bitmap = shared.bitmaps + entry->bitmap_offset;
+
+	for (i = 0; i < file->lines_size; i++) {
+		uint32_t lineno = file->lines_start + i;
+
+		if (file->lines[i].count == 0) {
+			continue;
+		}
+		if (lineno >= line_count) {
+			break;
+		}
+
+		if (lineno / 64 != word_nr) {
+			if (bits) {
+				or_word(&bitmap[word_nr], bits);
+			}
+			word_nr = lineno / 64;
+			bits = 0;
+		}
+		bits |= UINT64_C(1) << (lineno % 64);
+	}
+
+	if (bits) {
+		or_word(&bitmap[word_nr], bits);
+	}
+}
+#endif
+
+void xdebug_coverage_shared_minit(void)
+{
+	if (!XINI_COV(shared_file) || !XINI_COV(shared_file)[0]) {
+		return;
+	}
+
+#ifdef XDEBUG_COVERAGE_SHARED_SUPPORTED
+	open_shared_file(XINI_COV(shared_file));
+#else
+	xdebug_log_ex(XLOG_CHAN_COVERAGE, XLOG_ERR, "SHARED", "Shared coverage is not supported on Windows, or with thread safe PHP builds.");
+#endif
+}
+
+void xdebug_coverage_shared_mshutdown(void)
+{
+#ifdef XDEBUG_COVERAGE_SHARED_SUPPORTED
+	if (shared.header) {
+		msync(shared.header, shared.size, MS_SYNC);
+		munmap(shared.header, shared.size);
+		shared.header = NULL;
+	}
+	if (shared.lock_fd != -1 && shared.lock_fd != shared.fd) {
+		close(shared.lock_fd);
+	}
+	shared.lock_fd = -1;
+	if (shared.fd != -1) {
+		close(shared.fd);
+		shared.fd = -1;
+	}
+	if (shared.path) {
+		free(shared.path);
+		shared.path = NULL;
+	}
+#endif
+
+	if (XG_COV(shared_index)) {
+		xdebug_hash_destroy(XG_COV(shared_index));
+		XG_COV(shared_index) = NULL;
+	}
+}
+
+/* Turns on line coverage for every xdebug.coverage_shared_sample-th request of
+ * each process */
+void xdebug_coverage_shared_rinit(void)
+{
+	XG_COV(shared_collecting) = 0;
+
+#ifdef XDEBUG_COVERAGE_SHARED_SUPPORTED
+	if (!shared.header || XINI_COV(shared_sample) <= 0) {
+		return;
+	}
+
+	XG_COV(shared_request_count)++;
+	if (XG_COV(shared_request_count) % XINI_COV(shared_sample) != 0) {
+		return;
+	}
+
+	XG_COV(code_coverage_unused) = 0;
+	XG_COV(code_coverage_dead_code_analysis) = 0;
+	XG_COV(code_coverage_branch_check) = 0;
+	XG_COV(code_coverage_active) = 1;
+	XG_COV(shared_collecting) = 1;
+#endif
+}
+
+/* Called before the request's coverage data goes away. The per request line
+ * counters are this process' shadow of the shared bitmaps, so counting a line
+ * never touches shared memory. */
+void xdebug_coverage_shared_merge(void)
+{
+#ifdef XDEBUG_COVERAGE_SHARED_SUPPORTED
+	size_t i;
+	time_t now;
+
+	if (!XG_COV(shared_collecting) || !shared.header) {
+		return;
+	}
+	XG_COV(shared_collecting) = 0;
+
+	for (i = 0; i < XG_COV(file_slots).count; i++) {
+		merge_file(XG_COV(file_slots).files[i]);
+	}
+	__sync_fetch_and_add(&shared.header->requests, 1);
+
+	now = time(NULL);
+	if (now - shared.last_sync >= XDEBUG_COVERAGE_SHARED_SYNC_INTERVAL) {
+		msync(shared.header, shared.size, MS_ASYNC);
+		shared.last_sync = now;
+
+		if (XG_COV(shared_index)) {
+			xdebug_hash_destroy(XG_COV(shared_index));
+			XG_COV(shared_index) = NULL;
+		}
+	}
+#endif
+}
@@ -0,0 +1,66 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#ifndef __XDEBUG_COVERAGE_SHARED_H__
+#define __XDEBUG_COVERAGE_SHARED_H__
+
+#include "lib/php-header.h"
+
+/* The layout of the file that xdebug.coverage_shared_file points to. It is
+ * memory mapped by all processes that share it, and read by
+ * contrib/coverage-shared-dump.c, which has its own copy of these
+ * definitions. All numbers are in the host's byte order.
+ *
+ *   header
+ *   max_files file entries of XDEBUG_COVERAGE_SHARED_ENTRY_SIZE bytes
+ *   max_words uint64 words of line bitmaps
+ *
+ * Each file's bitmap has a bit per line, starting at line 0, and a set bit
+ * means that the line was executed in at least one request. */
+#define XDEBUG_COVERAGE_SHARED_MAGIC         "XDCOVSHM"
+#define XDEBUG_COVERAGE_SHARED_VERSION       2
+#define XDEBUG_COVERAGE_SHARED_MAX_FILES     16384
+#define XDEBUG_COVERAGE_SHARED_MAX_WORDS     (4 * 1024 * 1024)
+#define XDEBUG_COVERAGE_SHARED_ENTRY_SIZE    512
+#define XDEBUG_COVERAGE_SHARED_NAME_SIZE     (XDEBUG_COVERAGE_SHARED_ENTRY_SIZE - 32)
+
+typedef struct _xdebug_coverage_shared_header {
+	char     magic[8];
+	uint32_t version;
+	uint32_t max_files;
+	uint32_t max_words;
+	uint32_t file_count;
+	uint32_t words_used;
+	uint32_t entry_size;
+	uint64_t requests;    /* The number of requests that were merged in */
+	char     reserved[24];
+} xdebug_coverage_shared_header;
+
+typedef struct _xdebug_coverage_shared_entry {
+	uint32_t bitmap_offset; /* In words, from the start of the bitmaps */
+	uint32_t line_count;    /* The number of lines that the bitmap has room for */
+	uint32_t name_len;
+	uint32_t reserved;
+	uint64_t source_size;   /* The size and modification time of the source */
+	uint64_t source_mtime;  /* file that the bitmap's lines belong to */
+	char     name[XDEBUG_COVERAGE_SHARED_NAME_SIZE];
+} xdebug_coverage_shared_entry;
+
+void xdebug_coverage_shared_minit(void);
+void xdebug_coverage_shared_mshutdown(void);
+void xdebug_coverage_shared_rinit(void);
+void xdebug_coverage_shared_merge(void);
+
+#endif
@@ -17,6 +17,7 @@
 #include "php_xdebug.h"
 #include "lib_private.h"
 #include "log.h"
+#include "timing.h"
 
 ZEND_EXTERN_MODULE_GLOBALS(xdebug)
 
@@ -30,6 +31,10 @@ void xdebug_file_init(xdebug_file *xf)
 	xf->fp.gz     = NULL;
 #endif
 	xf->name      = NULL;
+	xf->bytes_written = 0;
+	xf->buffer    = NULL;
+	xf->buffer_flush_interval = 0;
+	xf->buffer_last_flush     = 0;
 }
 
 xdebug_file *xdebug_file_ctor(void)
@@ -48,6 +53,11 @@ void xdebug_file_deinit(xdebug_file *xf)
 	xf->fp.gz     = NULL;
 #endif
 	xdfree(xf->name);
+
+	if (xf->buffer) {
+		xdebug_str_free(xf->buffer);
+		xf->buffer = NULL;
+	}
 }
 
 void xdebug_file_dtor(xdebug_file *xf)
@@ -117,15 +127,71 @@ uncompressed:
 	return 1;
 }
 
+/* Makes writes go into one memory buffer, so that they do not each need a
+ * call into stdio or zlib. The buffer is written out when it is full, when
+ * xdebug_file_flush() is called, and by xdebug_file_flush_if_due() once
+ * 'flush_interval' nanoseconds have passed since it was last written. */
+void xdebug_file_enable_buffer(xdebug_file *file, uint64_t flush_interval)
+{
+	file->buffer                = xdebug_str_new();
+	file->buffer_flush_interval = flush_interval;
+	file->buffer_last_flush     = xdebug_get_nanotime();
+}
+
+static void write_buffer(xdebug_file *file)
+{
+	if (!file->buffer || !file->buffer->l) {
+		return;
+	}
+
+	switch (file->type) {
+		case XDEBUG_FILE_TYPE_NORMAL:
+			fwrite(file->buffer->d, 1, file->buffer->l, file->fp.normal);
+			break;
+#if HAVE_XDEBUG_ZLIB
+		case XDEBUG_FILE_TYPE_GZ:
+			gzwrite(file->fp.gz, file->buffer->d, file->buffer->l);
+			break;
+#endif
+	}
+
+	file->buffer->l = 0;
+}
+
+static void buffer_added(xdebug_file *file, size_t added)
+{
+	file->bytes_written += added;
+
+	if (file->buffer->l >= XDEBUG_FILE_BUFFER_SIZE) {
+		write_buffer(file);
+	}
+}
+
 int XDEBUG_ATTRIBUTE_FORMAT(printf, 2, 3) xdebug_file_printf(xdebug_file *file, const char *fmt, ...)
 {
 	va_list argv;
+	int     written;
+
+	if (file->buffer) {
+		size_t before = file->buffer->l;
+
+		va_start(argv, fmt);
+		xdebug_str_add_va_fmt(file->buffer, fmt, argv);
+		va_end(argv);
+
+		buffer_added(file, file->buffer->l - before);
+		return 1;
+	}
 
 	switch (file->type) {
 		case XDEBUG_FILE_TYPE_NORMAL:
 			va_start(argv, fmt);
-			vfprintf(file->fp.normal, fmt, argv);
+			written = vfprintf(file->fp.normal, fmt, argv);
 			va_end(argv);
+
+			if (written > 0) {
+				file->bytes_written += written;
+			}
 			break;
 #if HAVE_XDEBUG_ZLIB
 		case XDEBUG_FILE_TYPE_GZ: {
@@ -136,6 +202,7 @@ int XDEBUG_ATTRIBUTE_FORMAT(printf, 2, 3) xdebug_file_printf(xdebug_file *file,
 			va_end(argv);
 
 			gzwrite(file->fp.gz, formatted_string.d, formatted_string.l);
+			file->bytes_written += formatted_string.l;
 
 			xdebug_str_destroy(&formatted_string);
 			break;
@@ -151,6 +218,11 @@ int XDEBUG_ATTRIBUTE_FORMAT(printf, 2, 3) xdebug_file_printf(xdebug_file *file,
 
 int xdebug_file_flush(xdebug_file *file)
 {
+	if (file->buffer) {
+		write_buffer(file);
+		file->buffer_last_flush = xdebug_get_nanotime();
+	}
+
 	switch (file->type) {
 		case XDEBUG_FILE_TYPE_NORMAL:
 			return fflush(file->fp.normal);
@@ -164,8 +236,32 @@ int xdebug_file_flush(xdebug_file *file)
 	}
 }
 
+/* Flushes unbuffered files, and buffered files when their flush interval has passed */
+int xdebug_file_flush_if_due(xdebug_file *file)
+{
+	if (file->buffer && xdebug_get_nanotime() - file->buffer_last_flush < file->buffer_flush_interval) {
+		return 0;
+	}
+
+	return xdebug_file_flush(file);
+}
+
+/* For writers that do not need each record on disk straight away: without a
+ * flush interval, their buffer is only written out when it is full, or when
+ * the file is closed */
+int xdebug_file_flush_if_interval_due(xdebug_file *file)
+{
+	if (!file->buffer || !file->buffer_flush_interval) {
+		return 0;
+	}
+
+	return xdebug_file_flush_if_due(file);
+}
+
 int xdebug_file_close(xdebug_file *file)
 {
+	write_buffer(file);
+
 	switch (file->type) {
 		case XDEBUG_FILE_TYPE_NORMAL:
 			return fclose(file->fp.normal);
@@ -187,12 +283,24 @@ int xdebug_file_close(xdebug_file *file)
 
 size_t xdebug_file_write(const void *ptr, size_t size, size_t nmemb, xdebug_file *file)
 {
+	size_t written;
+
+	if (file->buffer) {
+		xdebug_str_addl(file->buffer, ptr, size * nmemb, 0);
+		buffer_added(file, size * nmemb);
+		return nmemb;
+	}
+
 	switch (file->type) {
 		case XDEBUG_FILE_TYPE_NORMAL:
-			return fwrite(ptr, size, nmemb, file->fp.normal);
+			written = fwrite(ptr, size, nmemb, file->fp.normal);
+			file->bytes_written += written * size;
+			return written;
 #if HAVE_XDEBUG_ZLIB
 		case XDEBUG_FILE_TYPE_GZ:
-			return gzfwrite(ptr, size, nmemb, file->fp.gz);
+			written = gzfwrite(ptr, size, nmemb, file->fp.gz);
+			file->bytes_written += written * size;
+			return written;
 #endif
 		default:
 			xdebug_log_ex(XLOG_CHAN_BASE, XLOG_CRIT, "FTYPE", "Unknown file type used with '%s'", file->name);
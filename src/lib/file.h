@@ -19,6 +19,7 @@
 
 #include "php_xdebug.h"
 #include "src/lib/compat.h"
+#include "lib/str.h"
 
 #if HAVE_XDEBUG_ZLIB
 # include <zlib.h>
@@ -30,6 +31,9 @@
 # define XDEBUG_FILE_TYPE_GZ     2
 #endif
 
+/* Buffered files write their buffer out once it has grown to this size */
+#define XDEBUG_FILE_BUFFER_SIZE  65536
+
 typedef struct _xdebug_file {
 	int type;
 	struct {
@@ -38,7 +42,13 @@ typedef struct _xdebug_file {
 		gzFile  gz;
 #endif
 	} fp;
-	char *name;
+	char   *name;
+	size_t  bytes_written; /* uncompressed, including what is still buffered */
+
+	/* See xdebug_file_enable_buffer() */
+	xdebug_str *buffer;
+	uint64_t    buffer_flush_interval;
+	uint64_t    buffer_last_flush;
 } xdebug_file;
 
 xdebug_file *xdebug_file_ctor(void);
@@ -46,7 +56,10 @@ void xdebug_file_dtor(xdebug_file *xf);
 void xdebug_file_init(xdebug_file *xf);
 void xdebug_file_deinit(xdebug_file *xf);
 int xdebug_file_open(xdebug_file *file, const char *filename, const char *extension, const char *mode);
+void xdebug_file_enable_buffer(xdebug_file *file, uint64_t flush_interval);
 int xdebug_file_flush(xdebug_file *file);
+int xdebug_file_flush_if_due(xdebug_file *file);
+int xdebug_file_flush_if_interval_due(xdebug_file *file);
 int XDEBUG_ATTRIBUTE_FORMAT(printf, 2, 3) xdebug_file_printf(xdebug_file *file, const char *fmt, ...);
 size_t xdebug_file_write(const void *ptr, size_t size, size_t nmemb, xdebug_file *file);
 int xdebug_file_close(xdebug_file *file);
@@ -507,6 +507,17 @@ function_stack_entry *xdebug_get_stack_frame(int nr)
 	return xdebug_vector_element_get(XG_BASE(stack), XDEBUG_VECTOR_COUNT(XG_BASE(stack)) - nr - 1);
 }
 
+/* Returns the name of the frame's function, which is only built once, as both
+ * the profiler and the trace handlers need it. The frame owns the string. */
+char *xdebug_fse_function_name(function_stack_entry *fse)
+{
+	if (!fse->function_name) {
+		fse->function_name = xdebug_show_fname(fse->function, XDEBUG_SHOW_FNAME_DEFAULT);
+	}
+
+	return fse->function_name;
+}
+
 static void xdebug_used_var_hash_from_llist_dtor(void *data)
 {
 	xdebug_str *var_name = (xdebug_str*) data;
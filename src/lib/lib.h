@@ -73,11 +73,16 @@ typedef struct xdebug_var_name {
 #define XDEBUG_TRACE_OPTION_NAKED_FILENAME  0x08
 #define XDEBUG_TRACE_OPTION_FLAMEGRAPH_COST 0x10
 #define XDEBUG_TRACE_OPTION_FLAMEGRAPH_MEM  0x20
+#define XDEBUG_TRACE_OPTION_CHROME          0x40
 
 #define XDEBUG_CC_OPTION_UNUSED          1
 #define XDEBUG_CC_OPTION_DEAD_CODE       2
 #define XDEBUG_CC_OPTION_BRANCH_CHECK    4
 
+#define XDEBUG_CC_DUMP_BINARY            0
+#define XDEBUG_CC_DUMP_LCOV              1
+#define XDEBUG_CC_DUMP_CLOVER            2
+
 #define STATUS_STARTING   0
 #define STATUS_STOPPING   1
 #define STATUS_STOPPED    2
@@ -177,6 +182,15 @@ typedef struct _function_stack_entry {
 	signed long  prev_memory;
 	uint64_t     nanotime;
 	bool         function_call_traced;
+	bool         trace_suppressed;
+	struct _xdebug_trace_call_count  *trace_call_count;
+	struct _xdebug_trace_call_counts *trace_call_counts;
+
+	/* call event properties, produced once per frame and shared by the
+	 * profiler and the trace handlers */
+	char        *function_name;
+	uint64_t     nanotime_end;
+	signed long  memory_end;
 
 	/* profiling properties */
 	xdebug_profile profile;
@@ -196,6 +210,7 @@ typedef struct _function_stack_entry {
 } function_stack_entry;
 
 function_stack_entry *xdebug_get_stack_frame(int nr);
+char *xdebug_fse_function_name(function_stack_entry *fse);
 
 
 xdebug_hash* xdebug_declared_var_hash_from_llist(xdebug_llist *list);
@@ -69,6 +69,24 @@ int xdebug_set_in_ex(xdebug_set *set, unsigned int position, int noisy)
 	return (*byte & (1 << bit));
 }
 
+/* Returns the number of positions in the set, a byte at a time */
+unsigned int xdebug_set_count(xdebug_set *set)
+{
+	unsigned int i, bytes, count = 0;
+
+	bytes = (set->size / 8) + 1 + ((set->size % 8) != 0);
+
+	for (i = 0; i < bytes; i++) {
+		unsigned char v = set->setinfo[i];
+
+		v = v - ((v >> 1) & 0x55);
+		v = (v & 0x33) + ((v >> 2) & 0x33);
+		count += (v + (v >> 4)) & 0x0F;
+	}
+
+	return count;
+}
+
 void xdebug_set_dump(xdebug_set *set)
 {
 	unsigned int i;
@@ -27,6 +27,7 @@ void xdebug_set_add(xdebug_set *set, unsigned int position);
 void xdebug_set_remove(xdebug_set *set, unsigned int position);
 #define xdebug_set_in(x,y) xdebug_set_in_ex(x,y,1)
 int xdebug_set_in_ex(xdebug_set *set, unsigned int position, int noisy);
+unsigned int xdebug_set_count(xdebug_set *set);
 void xdebug_set_dump(xdebug_set *set);
 void xdebug_set_free(xdebug_set *set);
 
@@ -28,7 +28,7 @@
 
 inline static void realloc_if_needed(xdebug_str *xs, int size_to_fit)
 {
-	if (!xs->a || !xs->l || xs->l + size_to_fit > xs->a - 1) {
+	if (!xs->a || xs->l + size_to_fit > xs->a - 1) {
 		xs->d = xdrealloc(xs->d, xs->a + size_to_fit + XDEBUG_STR_PREALLOC);
 		xs->a = xs->a + size_to_fit + XDEBUG_STR_PREALLOC;
 	}
@@ -427,6 +427,101 @@ static void xdebug_var_synopsis(zval **struc, xdebug_str *str, int level, int de
 	}
 }
 
+#define XDEBUG_SYNOPSIS_STRING_PREFIX 16
+
+static void add_synopsis_string_prefix(xdebug_str *str, zend_string *value)
+{
+	size_t i;
+	size_t len = ZSTR_LEN(value) < XDEBUG_SYNOPSIS_STRING_PREFIX ? ZSTR_LEN(value) : XDEBUG_SYNOPSIS_STRING_PREFIX;
+
+	xdebug_str_addc(str, '\'');
+	for (i = 0; i < len; i++) {
+		unsigned char c = ZSTR_VAL(value)[i];
+
+		switch (c) {
+			case '\'':  xdebug_str_add_literal(str, "\\'"); break;
+			case '\\':  xdebug_str_add_literal(str, "\\\\"); break;
+			case '\n':  xdebug_str_add_literal(str, "\\n"); break;
+			case '\r':  xdebug_str_add_literal(str, "\\r"); break;
+			case '\t':  xdebug_str_add_literal(str, "\\t"); break;
+			default:
+				if (c < 32 || c == 127) {
+					xdebug_str_add_fmt(str, "\\x%02x", c);
+				} else {
+					xdebug_str_addc(str, c);
+				}
+				break;
+		}
+	}
+	xdebug_str_addc(str, '\'');
+
+	if (ZSTR_LEN(value) > len) {
+		xdebug_str_add_literal(str, "...");
+	}
+}
+
+/* Adds a synopsis of a value to 'str' in constant time: only the type, the
+ * number of elements of an array, the class name of an object, and the length
+ * and first few characters of a string. Nothing is allocated, other than
+ * growing 'str' itself. */
+void xdebug_add_zval_synopsis_line(xdebug_str *str, zval *val)
+{
+	if (Z_TYPE_P(val) == IS_REFERENCE) {
+		val = Z_REFVAL_P(val);
+	}
+
+	switch (Z_TYPE_P(val)) {
+		case IS_TRUE:
+			xdebug_str_add_literal(str, "true");
+			break;
+
+		case IS_FALSE:
+			xdebug_str_add_literal(str, "false");
+			break;
+
+		case IS_NULL:
+			xdebug_str_add_literal(str, "null");
+			break;
+
+		case IS_LONG:
+			xdebug_str_add_literal(str, "long");
+			break;
+
+		case IS_DOUBLE:
+			xdebug_str_add_literal(str, "double");
+			break;
+
+		case IS_STRING:
+			xdebug_str_add_fmt(str, "string(%zu) ", Z_STRLEN_P(val));
+			add_synopsis_string_prefix(str, Z_STR_P(val));
+			break;
+
+		case IS_ARRAY:
+			xdebug_str_add_fmt(str, "array(%d)", zend_hash_num_elements(Z_ARRVAL_P(val)));
+			break;
+
+		case IS_OBJECT:
+			xdebug_str_add_literal(str, "class ");
+			xdebug_str_add_zstr(str, Z_OBJCE_P(val)->name);
+			break;
+
+		case IS_RESOURCE: {
+			const char *type_name = zend_rsrc_list_get_rsrc_type(Z_RES_P(val));
+
+			xdebug_str_add_fmt(str, "resource(%ld) of type (%s)", Z_RES_P(val)->handle, type_name ? type_name : "Unknown");
+			break;
+		}
+
+		case IS_UNDEF:
+			xdebug_str_add_literal(str, "*uninitialized*");
+			break;
+
+		default:
+			xdebug_str_add_literal(str, "NFC");
+			break;
+	}
+}
+
 xdebug_str* xdebug_get_zval_synopsis_line(zval *val, int debug_zval, xdebug_var_export_options *options)
 {
 	xdebug_str *str = xdebug_str_new();
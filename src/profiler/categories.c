@@ -0,0 +1,362 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#include "lib/php-header.h"
+
+#include "php_xdebug.h"
+#include "categories.h"
+#include "profiler_private.h"
+
+#include "lib/lib.h"
+#include "lib/mm.h"
+#include "lib/str.h"
+#include "lib/timing.h"
+#include "lib/usefulstuff.h"
+
+ZEND_EXTERN_MODULE_GLOBALS(xdebug)
+
+/* One pattern of xdebug.profiler_categories. Patterns are lower case, and
+ * either match a whole function name, or, ending in '*', its start */
+typedef struct _category_rule {
+	char   *pattern;
+	size_t  pattern_len;
+	bool    prefix;
+	int     category;
+} category_rule;
+
+/* Parsed once at MINIT, and only read afterwards */
+static char          **category_names = NULL;
+static int             category_count = 0;
+static category_rule  *category_rules = NULL;
+static int             category_rule_count = 0;
+
+static char *trim(char *str)
+{
+	char *end;
+
+	while (*str == ' ' || *str == '\t') {
+		str++;
+	}
+
+	end = str + strlen(str);
+	while (end > str && (end[-1] == ' ' || end[-1] == '\t')) {
+		end--;
+	}
+	*end = '\0';
+
+	return str;
+}
+
+static int find_or_add_category(const char *name)
+{
+	int i;
+
+	for (i = 0; i < category_count; i++) {
+		if (strcmp(category_names[i], name) == 0) {
+			return i;
+		}
+	}
+
+	category_names = xdrealloc(category_names, (category_count + 1) * sizeof(char*));
+	category_names[category_count] = xdstrdup(name);
+
+	return category_count++;
+}
+
+static void add_rule(int category, char *pattern)
+{
+	category_rule *rule;
+	size_t         len = strlen(pattern);
+
+	if (len == 0) {
+		return;
+	}
+
+	category_rules = xdrealloc(category_rules, (category_rule_count + 1) * sizeof(category_rule));
+	rule = &category_rules[category_rule_count++];
+
+	rule->prefix = pattern[len - 1] == '*';
+	if (rule->prefix) {
+		len--;
+	}
+	rule->pattern     = xdstrndup(pattern, len);
+	rule->pattern_len = len;
+	rule->category    = category;
+
+	zend_str_tolower(rule->pattern, rule->pattern_len);
+}
+
+/* Parses "category=pattern,pattern;category=pattern" */
+void xdebug_profiler_categories_minit(void)
+{
+	xdebug_arg *groups;
+	int         i, j;
+
+	if (!XINI_PROF(profiler_categories) || !XINI_PROF(profiler_categories)[0]) {
+		return;
+	}
+
+	groups = xdebug_arg_ctor();
+	xdebug_explode(";", XINI_PROF(profiler_categories), groups, -1);
+
+	for (i = 0; i < groups->c; i++) {
+		char       *equals = strchr(groups->args[i], '=');
+		char       *name;
+		xdebug_arg *patterns;
+		int         category;
+
+		if (!equals) {
+			continue;
+		}
+
+		*equals = '\0';
+		name = trim(groups->args[i]);
+		if (!name[0]) {
+			continue;
+		}
+
+		category = find_or_add_category(name);
+
+		patterns = xdebug_arg_ctor();
+		xdebug_explode(",", equals + 1, patterns, -1);
+		for (j = 0; j < patterns->c; j++) {
+			add_rule(category, trim(patterns->args[j]));
+		}
+		xdebug_arg_dtor(patterns);
+	}
+
+	xdebug_arg_dtor(groups);
+}
+
+void xdebug_profiler_categories_mshutdown(void)
+{
+	int i;
+
+	for (i = 0; i < category_rule_count; i++) {
+		xdfree(category_rules[i].pattern);
+	}
+	for (i = 0; i < category_count; i++) {
+		xdfree(category_names[i]);
+	}
+
+	if (category_rules) {
+		xdfree(category_rules);
+	}
+	if (category_names) {
+		xdfree(category_names);
+	}
+
+	category_rules = NULL;
+	category_rule_count = 0;
+	category_names = NULL;
+	category_count = 0;
+}
+
+void xdebug_profiler_categories_rinit(void)
+{
+	XG_PROF(category_cache) = NULL;
+	XG_PROF(category_totals) = category_count ? xdcalloc(category_count, sizeof(xdebug_category_total)) : NULL;
+	XG_PROF(category_stack) = NULL;
+	XG_PROF(category_stack_count) = 0;
+	XG_PROF(category_stack_size) = 0;
+}
+
+void xdebug_profiler_categories_post_deactivate(void)
+{
+	if (XG_PROF(category_cache)) {
+		zend_hash_destroy(XG_PROF(category_cache));
+		FREE_HASHTABLE(XG_PROF(category_cache));
+		XG_PROF(category_cache) = NULL;
+	}
+	if (XG_PROF(category_totals)) {
+		xdfree(XG_PROF(category_totals));
+		XG_PROF(category_totals) = NULL;
+	}
+	if (XG_PROF(category_stack)) {
+		xdfree(XG_PROF(category_stack));
+		XG_PROF(category_stack) = NULL;
+	}
+	XG_PROF(category_stack_count) = 0;
+	XG_PROF(category_stack_size) = 0;
+}
+
+/* Matches "class::method" or "function", in lower case, against the rules */
+static int classify(zend_function *func)
+{
+	char *name;
+	int   i, category = -1;
+
+	if (!func->common.function_name) {
+		return -1;
+	}
+
+	if (func->common.scope) {
+		name = xdebug_sprintf("%s::%s", ZSTR_VAL(func->common.scope->name), ZSTR_VAL(func->common.function_name));
+	} else {
+		name = xdstrdup(ZSTR_VAL(func->common.function_name));
+	}
+	zend_str_tolower(name, strlen(name));
+
+	for (i = 0; i < category_rule_count; i++) {
+		category_rule *rule = &category_rules[i];
+
+		if (rule->prefix ? strncmp(name, rule->pattern, rule->pattern_len) == 0 : strcmp(name, rule->pattern) == 0) {
+			category = rule->category;
+			break;
+		}
+	}
+
+	xdfree(name);
+
+	return category;
+}
+
+/* Internal functions are keyed on their persistent zend_function, and user
+ * functions on their opcodes, which closures share with their declaration,
+ * together with their scope, as trait methods share their opcodes with the
+ * same method in every class that uses the trait */
+static int find_category(zend_function *func)
+{
+	struct {
+		const void *function;
+		const void *scope;
+	} key;
+	zval *cached, category;
+
+	key.function = func->type == ZEND_USER_FUNCTION ? (const void*) func->op_array.opcodes : (const void*) func;
+	key.scope    = func->common.scope;
+
+	if (!XG_PROF(category_cache)) {
+		ALLOC_HASHTABLE(XG_PROF(category_cache));
+		zend_hash_init(XG_PROF(category_cache), 256, NULL, NULL, 0);
+	}
+
+	cached = zend_hash_str_find(XG_PROF(category_cache), (const char*) &key, sizeof(key));
+	if (cached) {
+		return (int) Z_LVAL_P(cached);
+	}
+
+	ZVAL_LONG(&category, classify(func));
+	zend_hash_str_add_new(XG_PROF(category_cache), (const char*) &key, sizeof(key), &category);
+
+	return (int) Z_LVAL(category);
+}
+
+void xdebug_profiler_categories_begin(function_stack_entry *fse, zend_function *func)
+{
+	xdebug_category_frame *frame;
+	int                    category;
+
+	if (!XG_PROF(category_totals) || !func) {
+		return;
+	}
+
+	category = find_category(func);
+	if (category < 0) {
+		return;
+	}
+
+	if (XG_PROF(category_stack_count) == XG_PROF(category_stack_size)) {
+		XG_PROF(category_stack_size) = XG_PROF(category_stack_size) ? XG_PROF(category_stack_size) * 2 : 16;
+		XG_PROF(category_stack) = xdrealloc(XG_PROF(category_stack), XG_PROF(category_stack_size) * sizeof(xdebug_category_frame));
+	}
+
+	frame = &XG_PROF(category_stack)[XG_PROF(category_stack_count)++];
+	frame->function_nr     = fse->function_nr;
+	frame->category        = category;
+	frame->nested_nanotime = 0;
+}
+
+/* Charges a categorised frame with its time, minus the time of the
+ * categorised frames that it called, so that categories do not overlap */
+void xdebug_profiler_categories_end(function_stack_entry *fse)
+{
+	xdebug_category_frame *frame;
+	uint64_t               elapsed;
+
+	if (!XG_PROF(category_stack_count)) {
+		return;
+	}
+
+	frame = &XG_PROF(category_stack)[XG_PROF(category_stack_count) - 1];
+	if (frame->function_nr != fse->function_nr) {
+		return;
+	}
+
+	elapsed = fse->nanotime_end - fse->nanotime;
+
+	XG_PROF(category_totals)[frame->category].nanotime += elapsed > frame->nested_nanotime ? elapsed - frame->nested_nanotime : 0;
+	XG_PROF(category_totals)[frame->category].calls++;
+
+	XG_PROF(category_stack_count)--;
+	if (XG_PROF(category_stack_count)) {
+		XG_PROF(category_stack)[XG_PROF(category_stack_count) - 1].nested_nanotime += elapsed;
+	}
+}
+
+void xdebug_profiler_categories_write_footer(xdebug_file *file)
+{
+	int i;
+	bool header_written = false;
+
+	if (!XG_PROF(category_totals)) {
+		return;
+	}
+
+	for (i = 0; i < category_count; i++) {
+		xdebug_category_total *total = &XG_PROF(category_totals)[i];
+
+		if (!total->calls) {
+			continue;
+		}
+
+		if (!header_written) {
+			xdebug_file_printf(file, "# time breakdown: category time_(10ns) calls\n");
+			header_written = true;
+		}
+
+		xdebug_file_printf(file, "# %s %lu " ZEND_LONG_FMT "\n", category_names[i], NANOTIME_SCALE_10NS(total->nanotime), total->calls);
+	}
+
+	if (header_written) {
+		xdebug_file_printf(file, "\n");
+	}
+}
+
+/* {{{ proto array xdebug_get_time_breakdown()
+   Returns the time spent in each category of xdebug.profiler_categories */
+PHP_FUNCTION(xdebug_get_time_breakdown)
+{
+	int i;
+
+	array_init(return_value);
+
+	WARN_AND_RETURN_IF_MODE_IS_NOT(XDEBUG_MODE_PROFILING);
+
+	if (!XG_PROF(category_totals)) {
+		return;
+	}
+
+	for (i = 0; i < category_count; i++) {
+		zval row;
+
+		array_init(&row);
+		add_assoc_double(&row, "time", XG_PROF(category_totals)[i].nanotime / (double) NANOS_IN_SEC);
+		add_assoc_long(&row, "calls", XG_PROF(category_totals)[i].calls);
+
+		add_assoc_zval(return_value, category_names[i], &row);
+	}
+}
+/* }}} */
@@ -0,0 +1,53 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#ifndef __XDEBUG_CATEGORIES_H__
+#define __XDEBUG_CATEGORIES_H__
+
+#include "lib/php-header.h"
+#include "php_xdebug.h"
+#include "lib/file.h"
+
+/* The default of xdebug.profiler_categories */
+#define XDEBUG_PROFILER_DEFAULT_CATEGORIES \
+	"io=fopen,fclose,fread,fwrite,fgets,fputs,file,file_get_contents,file_put_contents,readfile,fsockopen,stream_*,curl_*,splfileobject::*;" \
+	"db=pdo::*,pdostatement::*,mysqli*,pg_*,sqlite3*,redis::*,memcached::*;" \
+	"regex=preg_*,mb_ereg*;" \
+	"serialization=serialize,unserialize,json_encode,json_decode,var_export,igbinary_*,msgpack_*"
+
+/* A categorised frame that has not ended yet */
+typedef struct _xdebug_category_frame {
+	unsigned int function_nr;
+	int          category;
+	uint64_t     nested_nanotime; /* spent in categorised frames called from it */
+} xdebug_category_frame;
+
+typedef struct _xdebug_category_total {
+	uint64_t  nanotime;
+	zend_long calls;
+} xdebug_category_total;
+
+void xdebug_profiler_categories_minit(void);
+void xdebug_profiler_categories_mshutdown(void);
+void xdebug_profiler_categories_rinit(void);
+void xdebug_profiler_categories_post_deactivate(void);
+
+void xdebug_profiler_categories_begin(function_stack_entry *fse, zend_function *func);
+void xdebug_profiler_categories_end(function_stack_entry *fse);
+void xdebug_profiler_categories_write_footer(xdebug_file *file);
+
+PHP_FUNCTION(xdebug_get_time_breakdown);
+
+#endif
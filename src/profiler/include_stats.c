@@ -0,0 +1,398 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#include "lib/php-header.h"
+
+#include "php_xdebug.h"
+#include "include_stats.h"
+#include "profiler_private.h"
+
+#include "lib/file.h"
+#include "lib/lib.h"
+#include "lib/log.h"
+#include "lib/mm.h"
+#include "lib/str.h"
+#include "lib/timing.h"
+#include "lib/var.h"
+
+ZEND_EXTERN_MODULE_GLOBALS(xdebug)
+
+/* How many of the frames that called the autoloader are recorded */
+#define XDEBUG_INCLUDE_STATS_CHAIN_DEPTH 4
+
+static void include_stats_entry_dtor(void *elem)
+{
+	xdebug_include_stats_entry *entry = (xdebug_include_stats_entry*) elem;
+
+	zend_string_release(entry->filename);
+	if (entry->autoload_class) {
+		zend_string_release(entry->autoload_class);
+	}
+	if (entry->autoload_chain) {
+		xdfree(entry->autoload_chain);
+	}
+	xdfree(entry);
+}
+
+static xdebug_include_stats_entry *find_or_add_entry(zend_string *filename)
+{
+	xdebug_include_stats_entry *entry;
+
+	if (xdebug_hash_find(XG_PROF(include_stats), ZSTR_VAL(filename), ZSTR_LEN(filename), (void*) &entry)) {
+		return entry;
+	}
+
+	entry = xdcalloc(1, sizeof(xdebug_include_stats_entry));
+	entry->filename = zend_string_copy(filename);
+
+	xdebug_hash_add(XG_PROF(include_stats), ZSTR_VAL(filename), ZSTR_LEN(filename), (void*) entry);
+
+	return entry;
+}
+
+static void resolved_filename_dtor(void *elem)
+{
+	zend_string_release((zend_string*) elem);
+}
+
+/* Remembers the file that the engine resolved the pending *_once operand to,
+ * when it compiled or started to execute it */
+static void resolve_pending_once(zend_string *filename)
+{
+	zend_string *pending = XG_PROF(include_once_pending);
+
+	if (!pending) {
+		return;
+	}
+
+	XG_PROF(include_once_pending) = NULL;
+
+	if (filename && XG_PROF(include_once_resolved)) {
+		xdebug_hash_update(XG_PROF(include_once_resolved), ZSTR_VAL(pending), ZSTR_LEN(pending), zend_string_copy(filename));
+	}
+	zend_string_release(pending);
+}
+
+/* A pending *_once operand that was not compiled or executed by the time the
+ * next file is included, found a file that was already included. The path
+ * that the engine resolved it to is known from when it was first included,
+ * and only absolute paths, which have no prefix, can be used as they are. */
+static void finish_pending_once(void)
+{
+	zend_string                *pending = XG_PROF(include_once_pending);
+	zend_string                *resolved = NULL;
+	xdebug_include_stats_entry *entry;
+
+	if (!pending) {
+		return;
+	}
+
+	XG_PROF(include_once_pending) = NULL;
+
+	if (!XG_PROF(include_once_resolved) || !xdebug_hash_find(XG_PROF(include_once_resolved), ZSTR_VAL(pending), ZSTR_LEN(pending), (void*) &resolved)) {
+		resolved = strlen(ZSTR_VAL(pending)) == ZSTR_LEN(pending) ? pending : NULL;
+	}
+
+	/* The operand did not open a file at all */
+	if (resolved && XG_PROF(include_stats) && zend_hash_exists(&EG(included_files), resolved)) {
+		entry = find_or_add_entry(resolved);
+		entry->once_hits++;
+	}
+
+	zend_string_release(pending);
+}
+
+void xdebug_include_stats_init(char *report_basename)
+{
+	XG_PROF(include_stats) = xdebug_hash_alloc(64, include_stats_entry_dtor);
+	XG_PROF(include_report_basename) = report_basename ? xdstrdup(report_basename) : NULL;
+	XG_PROF(include_once_resolved) = xdebug_hash_alloc(64, resolved_filename_dtor);
+}
+
+void xdebug_include_stats_free(void)
+{
+	if (XG_PROF(include_once_pending)) {
+		zend_string_release(XG_PROF(include_once_pending));
+		XG_PROF(include_once_pending) = NULL;
+	}
+	if (XG_PROF(include_once_resolved)) {
+		xdebug_hash_destroy(XG_PROF(include_once_resolved));
+		XG_PROF(include_once_resolved) = NULL;
+	}
+	if (XG_PROF(include_stats)) {
+		xdebug_hash_destroy(XG_PROF(include_stats));
+		XG_PROF(include_stats) = NULL;
+	}
+	if (XG_PROF(include_report_basename)) {
+		xdfree(XG_PROF(include_report_basename));
+		XG_PROF(include_report_basename) = NULL;
+	}
+}
+
+void xdebug_profiler_compile_file(zend_op_array *op_array, uint64_t nanotime_taken)
+{
+	xdebug_include_stats_entry *entry;
+
+	if (!XG_PROF(active) || !op_array->filename) {
+		return;
+	}
+
+	resolve_pending_once(op_array->filename);
+
+	entry = find_or_add_entry(op_array->filename);
+	entry->compile_count++;
+	entry->compile_nanotime += nanotime_taken;
+}
+
+/* Records which class was being autoloaded, and the functions that loaded it */
+static void add_autoload_info(xdebug_include_stats_entry *entry, function_stack_entry *fse)
+{
+	zend_string          *key, *class_name = NULL;
+	function_stack_entry *parent;
+	xdebug_str            chain = XDEBUG_STR_INITIALIZER;
+	int                   depth = 0;
+
+	/* The class that is being autoloaded last, is the one that included the file */
+	ZEND_HASH_FOREACH_STR_KEY(EG(in_autoload), key) {
+		if (key) {
+			class_name = key;
+		}
+	} ZEND_HASH_FOREACH_END();
+
+	if (!class_name) {
+		return;
+	}
+
+	for (parent = fse - 1; depth < XDEBUG_INCLUDE_STATS_CHAIN_DEPTH && xdebug_vector_element_is_valid(XG_BASE(stack), parent); parent--, depth++) {
+		if (!XDEBUG_IS_NORMAL_FUNCTION(&parent->function)) {
+			break;
+		}
+
+		if (depth) {
+			xdebug_str_add_literal(&chain, " <- ");
+		}
+		xdebug_str_add(&chain, xdebug_fse_function_name(parent), 0);
+	}
+
+	entry->autoload_class = zend_string_copy(class_name);
+	entry->autoload_chain = chain.d ? chain.d : xdstrdup("");
+}
+
+void xdebug_profiler_include_begin(function_stack_entry *fse)
+{
+	/* Compiling can be skipped by an opcode cache that runs before Xdebug's
+	 * compile hook, but executing the file can not */
+	if (fse->function.type == XFUNC_INCLUDE_ONCE || fse->function.type == XFUNC_REQUIRE_ONCE) {
+		resolve_pending_once(fse->include_filename);
+	}
+}
+
+void xdebug_profiler_include_end(function_stack_entry *fse)
+{
+	xdebug_include_stats_entry *entry;
+
+	if (!XG_PROF(active) || !XG_PROF(include_stats)) {
+		return;
+	}
+
+	if (fse->function.type < XFUNC_INCLUDE || fse->function.type > XFUNC_REQUIRE_ONCE || !fse->include_filename) {
+		return;
+	}
+
+	entry = find_or_add_entry(fse->include_filename);
+	entry->include_count++;
+	entry->include_nanotime += fse->nanotime_end - fse->nanotime;
+
+	if (!entry->autoload_class && EG(in_autoload) && zend_hash_num_elements(EG(in_autoload)) > 0) {
+		add_autoload_info(entry, fse);
+	}
+}
+
+/* Counts include_once and require_once of files that were already included,
+ * as these still need to resolve the file's path every time. Whether the file
+ * was already included is only known after the engine has run the opline, so
+ * the operand is kept until the next include, see finish_pending_once(). */
+int xdebug_profiler_include_or_eval_handler(XDEBUG_OPCODE_HANDLER_ARGS)
+{
+	const zend_op *opline = execute_data->opline;
+	zval          *inc_filename;
+	int            is_var;
+
+	if (!XG_PROF(active) || !XG_PROF(include_stats)) {
+		return xdebug_call_original_opcode_handler_if_set(opline->opcode, XDEBUG_OPCODE_HANDLER_ARGS_PASSTHRU);
+	}
+
+	finish_pending_once();
+
+	if (opline->extended_value != ZEND_INCLUDE_ONCE && opline->extended_value != ZEND_REQUIRE_ONCE) {
+		return xdebug_call_original_opcode_handler_if_set(opline->opcode, XDEBUG_OPCODE_HANDLER_ARGS_PASSTHRU);
+	}
+
+	inc_filename = xdebug_get_zval(execute_data, opline->op1_type, &opline->op1, &is_var);
+	if (!inc_filename || Z_TYPE_P(inc_filename) != IS_STRING) {
+		return xdebug_call_original_opcode_handler_if_set(opline->opcode, XDEBUG_OPCODE_HANDLER_ARGS_PASSTHRU);
+	}
+
+	/* Relative paths resolve differently depending on the including file, so
+	 * they are prefixed with its name and a '\0' */
+	if (IS_ABSOLUTE_PATH(Z_STRVAL_P(inc_filename), Z_STRLEN_P(inc_filename))) {
+		XG_PROF(include_once_pending) = zend_string_copy(Z_STR_P(inc_filename));
+	} else {
+		zend_string *including = execute_data->func->op_array.filename;
+		zend_string *key = zend_string_alloc(ZSTR_LEN(including) + 1 + Z_STRLEN_P(inc_filename), 0);
+
+		memcpy(ZSTR_VAL(key), ZSTR_VAL(including), ZSTR_LEN(including));
+		ZSTR_VAL(key)[ZSTR_LEN(including)] = '\0';
+		memcpy(ZSTR_VAL(key) + ZSTR_LEN(including) + 1, Z_STRVAL_P(inc_filename), Z_STRLEN_P(inc_filename));
+		ZSTR_VAL(key)[ZSTR_LEN(key)] = '\0';
+
+		XG_PROF(include_once_pending) = key;
+	}
+
+	return xdebug_call_original_opcode_handler_if_set(opline->opcode, XDEBUG_OPCODE_HANDLER_ARGS_PASSTHRU);
+}
+
+typedef struct _include_stats_list {
+	xdebug_include_stats_entry **entries;
+	size_t                       count;
+} include_stats_list;
+
+static void collect_entry(void *user, xdebug_hash_element *he)
+{
+	include_stats_list *list = (include_stats_list*) user;
+
+	list->entries[list->count++] = (xdebug_include_stats_entry*) he->ptr;
+}
+
+/* Most expensive files first */
+static int compare_entries(const void *a, const void *b)
+{
+	const xdebug_include_stats_entry *entry_a = *(const xdebug_include_stats_entry**) a;
+	const xdebug_include_stats_entry *entry_b = *(const xdebug_include_stats_entry**) b;
+	uint64_t cost_a = entry_a->include_nanotime + entry_a->compile_nanotime;
+	uint64_t cost_b = entry_b->include_nanotime + entry_b->compile_nanotime;
+
+	if (cost_a != cost_b) {
+		return cost_a > cost_b ? -1 : 1;
+	}
+
+	return strcmp(ZSTR_VAL(entry_a->filename), ZSTR_VAL(entry_b->filename));
+}
+
+static void collect_sorted_entries(include_stats_list *list)
+{
+	list->count = 0;
+	list->entries = xdmalloc((XG_PROF(include_stats)->size + 1) * sizeof(xdebug_include_stats_entry*));
+
+	xdebug_hash_apply(XG_PROF(include_stats), (void*) list, collect_entry);
+	qsort(list->entries, list->count, sizeof(xdebug_include_stats_entry*), compare_entries);
+}
+
+void xdebug_include_stats_write_report(void)
+{
+	xdebug_file        report;
+	include_stats_list list;
+	size_t             i;
+
+	if (!XG_PROF(include_stats) || !XG_PROF(include_report_basename)) {
+		return;
+	}
+
+	finish_pending_once();
+
+	xdebug_file_init(&report);
+	if (!xdebug_file_open(&report, XG_PROF(include_report_basename), "includes", "wb")) {
+		xdebug_log_diagnose_permissions(XLOG_CHAN_PROFILE, xdebug_lib_get_output_dir(), XG_PROF(include_report_basename));
+		return;
+	}
+
+	xdebug_file_printf(&report, "Include Report\n");
+	xdebug_file_printf(&report, "version: 1\ncreator: xdebug %s (PHP %s)\n\n", XDEBUG_VERSION, PHP_VERSION);
+	xdebug_file_printf(&report, " Includes | Include Time | Compiles | Compile Time | Once Hits | File\n");
+	xdebug_file_printf(&report, "----------+--------------+----------+--------------+-----------+-----\n");
+
+	collect_sorted_entries(&list);
+
+	for (i = 0; i < list.count; i++) {
+		xdebug_include_stats_entry *entry = list.entries[i];
+
+		xdebug_file_printf(
+			&report,
+			"%9" ZEND_LONG_FMT_SPEC " | %9.3f ms | %8" ZEND_LONG_FMT_SPEC " | %9.3f ms | %9" ZEND_LONG_FMT_SPEC " | %s\n",
+			entry->include_count,
+			entry->include_nanotime / (double) NANOS_IN_MILLISEC,
+			entry->compile_count,
+			entry->compile_nanotime / (double) NANOS_IN_MILLISEC,
+			entry->once_hits,
+			ZSTR_VAL(entry->filename)
+		);
+
+		if (entry->autoload_class) {
+			xdebug_file_printf(
+				&report, "          autoloaded for '%s' by %s\n",
+				ZSTR_VAL(entry->autoload_class),
+				entry->autoload_chain[0] ? entry->autoload_chain : "-"
+			);
+		}
+	}
+
+	xdfree(list.entries);
+
+	xdebug_file_close(&report);
+	xdebug_file_deinit(&report);
+}
+
+/* {{{ proto array xdebug_get_include_stats()
+   Returns the compile and execution costs of each included file */
+PHP_FUNCTION(xdebug_get_include_stats)
+{
+	include_stats_list list;
+	size_t             i;
+
+	array_init(return_value);
+
+	if (!XG_PROF(include_stats)) {
+		return;
+	}
+
+	finish_pending_once();
+	collect_sorted_entries(&list);
+
+	for (i = 0; i < list.count; i++) {
+		xdebug_include_stats_entry *entry = list.entries[i];
+		zval                        row, autoload;
+
+		array_init(&row);
+		add_assoc_long(&row, "include_count", entry->include_count);
+		add_assoc_double(&row, "include_time", entry->include_nanotime / (double) NANOS_IN_SEC);
+		add_assoc_long(&row, "compile_count", entry->compile_count);
+		add_assoc_double(&row, "compile_time", entry->compile_nanotime / (double) NANOS_IN_SEC);
+		add_assoc_long(&row, "once_hits", entry->once_hits);
+
+		if (entry->autoload_class) {
+			array_init(&autoload);
+			add_assoc_str(&autoload, "class", zend_string_copy(entry->autoload_class));
+			add_assoc_string(&autoload, "chain", entry->autoload_chain);
+			add_assoc_zval(&row, "autoload", &autoload);
+		} else {
+			add_assoc_null(&row, "autoload");
+		}
+
+		zend_symtable_update(Z_ARRVAL_P(return_value), entry->filename, &row);
+	}
+
+	xdfree(list.entries);
+}
+/* }}} */
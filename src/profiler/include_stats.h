@@ -0,0 +1,47 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#ifndef __XDEBUG_INCLUDE_STATS_H__
+#define __XDEBUG_INCLUDE_STATS_H__
+
+#include "lib/php-header.h"
+#include "php_xdebug.h"
+
+/* Costs of one included file, collected while the profiler is active */
+typedef struct _xdebug_include_stats_entry {
+	zend_string *filename;
+	zend_long    compile_count;
+	uint64_t     compile_nanotime;
+	zend_long    include_count;
+	uint64_t     include_nanotime; /* inclusive */
+	zend_long    once_hits;        /* *_once of the file when already included */
+
+	/* The first autoload that included this file */
+	zend_string *autoload_class;
+	char        *autoload_chain;
+} xdebug_include_stats_entry;
+
+void xdebug_include_stats_init(char *report_basename);
+void xdebug_include_stats_write_report(void);
+void xdebug_include_stats_free(void);
+
+void xdebug_profiler_compile_file(zend_op_array *op_array, uint64_t nanotime_taken);
+void xdebug_profiler_include_begin(function_stack_entry *fse);
+void xdebug_profiler_include_end(function_stack_entry *fse);
+int xdebug_profiler_include_or_eval_handler(XDEBUG_OPCODE_HANDLER_ARGS);
+
+PHP_FUNCTION(xdebug_get_include_stats);
+
+#endif
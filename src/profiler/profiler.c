@@ -26,6 +26,10 @@
 #include "php_xdebug.h"
 #include "profiler.h"
 #include "profiler_private.h"
+#include "categories.h"
+#include "include_stats.h"
+
+#include "base/span.h"
 
 #include "lib/log.h"
 #include "lib/mm.h"
@@ -46,10 +50,16 @@ void xdebug_profiler_minit(void)
 {
 	/* Overload the "exit" opcode */
 	xdebug_set_opcode_handler(ZEND_EXIT, xdebug_profiler_exit_handler);
+
+	/* For counting include_once/require_once of already included files */
+	xdebug_register_with_opcode_multi_handler(ZEND_INCLUDE_OR_EVAL, xdebug_profiler_include_or_eval_handler);
+
+	xdebug_profiler_categories_minit();
 }
 
 void xdebug_profiler_mshutdown(void)
 {
+	xdebug_profiler_categories_mshutdown();
 }
 
 void xdebug_profiler_rinit(void)
@@ -60,7 +70,13 @@ void xdebug_profiler_rinit(void)
 	XG_PROF(profile_last_filename_ref) = 0;
 	XG_PROF(php_internal_seen_before) = 0;
 	XG_PROF(profile_last_functionname_ref) = 0;
+	XG_PROF(include_stats) = NULL;
+	XG_PROF(include_report_basename) = NULL;
+	XG_PROF(include_once_pending) = NULL;
+	XG_PROF(include_once_resolved) = NULL;
 	XG_PROF(active) = 0;
+
+	xdebug_profiler_categories_rinit();
 }
 
 static void deinit_if_active(void)
@@ -75,6 +91,9 @@ static void deinit_if_active(void)
 void xdebug_profiler_post_deactivate(void)
 {
 	deinit_if_active();
+
+	xdebug_include_stats_free();
+	xdebug_profiler_categories_post_deactivate();
 }
 
 void xdebug_profiler_pcntl_exec_handler(void)
@@ -109,10 +128,14 @@ void xdebug_profiler_init_if_requested(zend_op_array *op_array)
 
 void xdebug_profiler_execute_ex(function_stack_entry *fse, zend_op_array *op_array)
 {
+	xdebug_profiler_categories_begin(fse, (zend_function*) op_array);
+
 	if (!XG_PROF(active)) {
 		return;
 	}
 
+	xdebug_profiler_include_begin(fse);
+
 	/* Calculate all elements for profile entries */
 	xdebug_profiler_add_function_details_user(fse, op_array);
 	xdebug_profiler_function_begin(fse);
@@ -120,12 +143,16 @@ void xdebug_profiler_execute_ex(function_stack_entry *fse, zend_op_array *op_arr
 
 void xdebug_profiler_execute_ex_end(function_stack_entry *fse)
 {
+	xdebug_profiler_categories_end(fse);
+	xdebug_profiler_include_end(fse);
 	xdebug_profiler_function_end(fse);
 	xdebug_profiler_free_function_details(fse);
 }
 
 void xdebug_profiler_execute_internal(function_stack_entry *fse)
 {
+	xdebug_profiler_categories_begin(fse, EG(current_execute_data)->func);
+
 	if (!XG_PROF(active)) {
 		return;
 	}
@@ -136,6 +163,8 @@ void xdebug_profiler_execute_internal(function_stack_entry *fse)
 
 void xdebug_profiler_execute_internal_end(function_stack_entry *fse)
 {
+	xdebug_profiler_categories_end(fse);
+
 	if (!XG_PROF(active)) {
 		return;
 	}
@@ -168,8 +197,6 @@ static void profiler_write_header(xdebug_file *file, char *script_name)
 	xdebug_file_flush(file);
 }
 
-#define NANOTIME_SCALE_10NS(nanotime) ((unsigned long)(((nanotime) + 5) / 10))
-
 void xdebug_profiler_init(char *script_name)
 {
 	char *filename = NULL, *fname = NULL;
@@ -219,6 +246,9 @@ void xdebug_profiler_init(char *script_name)
 	XG_PROF(profile_last_filename_ref) = 1;
 	XG_PROF(profile_last_functionname_ref) = 0;
 
+	xdebug_include_stats_free();
+	xdebug_include_stats_init(XINI_PROF(profiler_include_report) ? filename : NULL);
+
 return_and_free_names:
 	xdfree(filename);
 	xdfree(fname);
@@ -228,11 +258,18 @@ void xdebug_profiler_deinit()
 {
 	function_stack_entry *fse = XDEBUG_VECTOR_TAIL(XG_BASE(stack));
 	int                   i;
+	uint64_t              nanotime = xdebug_get_nanotime();
+	long                  memory = zend_memory_usage(0);
 
+	/* Frames that are still open end now */
 	for (i = 0; i < XDEBUG_VECTOR_COUNT(XG_BASE(stack)); i++, fse--) {
+		fse->nanotime_end = nanotime;
+		fse->memory_end   = memory;
 		xdebug_profiler_function_end(fse);
 	}
 
+	xdebug_profiler_categories_write_footer(&XG_PROF(profile_file));
+
 	xdebug_file_printf(
 		&XG_PROF(profile_file),
 		"summary: %lu %zd\n\n",
@@ -242,6 +279,8 @@ void xdebug_profiler_deinit()
 
 	XG_PROF(active) = 0;
 
+	xdebug_include_stats_write_report();
+
 	xdebug_file_flush(&XG_PROF(profile_file));
 
 	if (XG_PROF(profile_file).type != XDEBUG_FILE_TYPE_NULL) {
@@ -255,11 +294,11 @@ void xdebug_profiler_deinit()
 	XG_PROF(profile_functionname_refs) = NULL;
 }
 
-static inline void xdebug_profiler_function_push(function_stack_entry *fse)
+static inline void xdebug_profiler_function_push(function_stack_entry *fse, uint64_t nanotime, long memory)
 {
-	fse->profile.nanotime += (xdebug_get_nanotime() - fse->profile.nanotime_mark);
+	fse->profile.nanotime += (nanotime - fse->profile.nanotime_mark);
 	fse->profile.nanotime_mark = 0;
-	fse->profile.memory += (zend_memory_usage(0) - fse->profile.mem_mark);
+	fse->profile.memory += (memory - fse->profile.mem_mark);
 	fse->profile.mem_mark = 0;
 }
 
@@ -270,7 +309,7 @@ void xdebug_profiler_function_continue(function_stack_entry *fse)
 
 void xdebug_profiler_function_pause(function_stack_entry *fse)
 {
-	xdebug_profiler_function_push(fse);
+	xdebug_profiler_function_push(fse, xdebug_get_nanotime(), zend_memory_usage(0));
 }
 
 static inline void add_filename_ref(xdebug_str *buffer, char *name)
@@ -313,7 +352,7 @@ void xdebug_profiler_add_function_details_user(function_stack_entry *fse, zend_o
 {
 	char *tmp_fname, *tmp_name;
 
-	tmp_name = xdebug_show_fname(fse->function, XDEBUG_SHOW_FNAME_DEFAULT);
+	tmp_name = xdstrdup(xdebug_fse_function_name(fse));
 	switch (fse->function.type) {
 		case XFUNC_INCLUDE:
 		case XFUNC_INCLUDE_ONCE:
@@ -350,7 +389,7 @@ void xdebug_profiler_add_function_details_internal(function_stack_entry *fse)
 {
 	char *tmp_fname, *tmp_name;
 
-	tmp_name = xdebug_show_fname(fse->function, XDEBUG_SHOW_FNAME_DEFAULT);
+	tmp_name = xdstrdup(xdebug_fse_function_name(fse));
 	switch (fse->function.type) {
 		case XFUNC_INCLUDE:
 		case XFUNC_INCLUDE_ONCE:
@@ -376,12 +415,14 @@ void xdebug_profiler_add_function_details_internal(function_stack_entry *fse)
 	xdfree(tmp_name);
 }
 
+/* The start of the call is shared with the trace handlers, as it was recorded
+ * when the frame was created */
 void xdebug_profiler_function_begin(function_stack_entry *fse)
 {
 	fse->profile.nanotime = 0;
-	fse->profile.nanotime_mark = xdebug_get_nanotime();
+	fse->profile.nanotime_mark = fse->nanotime;
 	fse->profile.memory = 0;
-	fse->profile.mem_mark = zend_memory_usage(0);
+	fse->profile.mem_mark = fse->memory;
 }
 
 #define TMP_KEY_BUFFER_LEN 1024
@@ -389,6 +430,55 @@ void xdebug_profiler_function_begin(function_stack_entry *fse)
 #define TMP_KEY_PREFIX_LEN (sizeof(TMP_KEY_PREFIX)-1)
 #define TMP_KEY_MAX_LEN    (TMP_KEY_BUFFER_LEN-TMP_KEY_PREFIX_LEN-1)
 
+/* Adds the cfl=/cfn= entries for each function called from a frame */
+static void add_call_list(xdebug_str *file_buffer, xdebug_llist *call_list, char *tmp_key)
+{
+	xdebug_llist_element *le;
+
+	for (le = XDEBUG_LLIST_HEAD(call_list); le != NULL; le = XDEBUG_LLIST_NEXT(le))
+	{
+		xdebug_call_entry *call_entry = XDEBUG_LLIST_VALP(le);
+
+		if (call_entry->user_defined == XDEBUG_BUILT_IN) {
+			size_t tmp_key_funcname_len = strlen(call_entry->function);
+
+			memcpy(tmp_key + TMP_KEY_PREFIX_LEN,
+				call_entry->function,
+				tmp_key_funcname_len > TMP_KEY_MAX_LEN ? TMP_KEY_MAX_LEN : tmp_key_funcname_len + 1
+			);
+			tmp_key[TMP_KEY_BUFFER_LEN - 1] = '\0';
+
+			if (XG_PROF(php_internal_seen_before)) {
+				xdebug_str_add_literal(file_buffer, "cfl=(1)\n");
+			} else {
+				xdebug_str_add_literal(file_buffer, "cfl=(1) php:internal\n");
+				XG_PROF(php_internal_seen_before) = 1;
+			}
+
+			xdebug_str_add_literal(file_buffer, "cfn=");
+			add_functionname_ref(file_buffer, tmp_key);
+			xdebug_str_addc(file_buffer, '\n');
+		} else {
+			xdebug_str_add_literal(file_buffer, "cfl=");
+			add_filename_ref(file_buffer, ZSTR_VAL(call_entry->filename));
+
+			xdebug_str_add_literal(file_buffer, "\ncfn=");
+			add_functionname_ref(file_buffer, call_entry->function);
+			xdebug_str_addc(file_buffer, '\n');
+		}
+
+		xdebug_str_add_literal(file_buffer, "calls=1 0 0\n");
+
+		/* Adds %d %lu %lu, with lineno, time, and memory */
+		xdebug_str_add_uint64(file_buffer, call_entry->lineno);
+		xdebug_str_addc(file_buffer, ' ');
+		xdebug_str_add_uint64(file_buffer, NANOTIME_SCALE_10NS(call_entry->nanotime_taken));
+		xdebug_str_addc(file_buffer, ' ');
+		xdebug_str_add_uint64(file_buffer, call_entry->mem_used >= 0 ? call_entry->mem_used : 0);
+		xdebug_str_addc(file_buffer, '\n');
+	}
+}
+
 void xdebug_profiler_function_end(function_stack_entry *fse)
 {
 	xdebug_llist_element *le;
@@ -408,7 +498,8 @@ void xdebug_profiler_function_end(function_stack_entry *fse)
 	if (!fse->profile.call_list) {
 		fse->profile.call_list = xdebug_llist_alloc(xdebug_profile_call_entry_dtor);
 	}
-	xdebug_profiler_function_push(fse);
+	/* The end of the call was recorded once for all users in the call event */
+	xdebug_profiler_function_push(fse, fse->nanotime_end, fse->memory_end);
 
 	if (xdebug_vector_element_is_valid(XG_BASE(stack), fse - 1)) {
 		xdebug_call_entry *ce = xdmalloc(sizeof(xdebug_call_entry));
@@ -471,47 +562,63 @@ void xdebug_profiler_function_end(function_stack_entry *fse)
 	xdebug_str_addc(&file_buffer, '\n');
 
 	/* dump call list */
-	for (le = XDEBUG_LLIST_HEAD(fse->profile.call_list); le != NULL; le = XDEBUG_LLIST_NEXT(le))
-	{
-		xdebug_call_entry *call_entry = XDEBUG_LLIST_VALP(le);
+	add_call_list(&file_buffer, fse->profile.call_list, tmp_key);
+	xdebug_str_addc(&file_buffer, '\n');
 
-		if (call_entry->user_defined == XDEBUG_BUILT_IN) {
-			size_t tmp_key_funcname_len = strlen(call_entry->function);
+	xdebug_file_write(file_buffer.d, sizeof(char), file_buffer.l, &XG_PROF(profile_file));
+	xdebug_str_dtor(file_buffer);
+}
 
-			memcpy(tmp_key + TMP_KEY_PREFIX_LEN,
-				call_entry->function,
-				tmp_key_funcname_len > TMP_KEY_MAX_LEN ? TMP_KEY_MAX_LEN : tmp_key_funcname_len + 1
-			);
-			tmp_key[TMP_KEY_BUFFER_LEN - 1] = '\0';
+/* Spans and markers are written as frames of their own, called from the frame
+ * that began them. Their file and line are where they were begun. */
+static void add_synthetic_frame(function_stack_entry *owner, zend_string *filename, char *funcname, int lineno, uint64_t nanotime, long memory, xdebug_llist *call_list)
+{
+	xdebug_llist_element *le;
+	xdebug_str            file_buffer = XDEBUG_STR_INITIALIZER;
+	char                  tmp_key[TMP_KEY_BUFFER_LEN];
+	xdebug_call_entry    *ce;
 
-			if (XG_PROF(php_internal_seen_before)) {
-				xdebug_str_add_literal(&file_buffer, "cfl=(1)\n");
-			} else {
-				xdebug_str_add_literal(&file_buffer, "cfl=(1) php:internal\n");
-				XG_PROF(php_internal_seen_before) = 1;
-			}
+	if (!owner->profile.call_list) {
+		owner->profile.call_list = xdebug_llist_alloc(xdebug_profile_call_entry_dtor);
+	}
 
-			xdebug_str_add_literal(&file_buffer, "cfn=");
-			add_functionname_ref(&file_buffer, tmp_key);
-			xdebug_str_addc(&file_buffer, '\n');
-		} else {
-			xdebug_str_add_literal(&file_buffer, "cfl=");
-			add_filename_ref(&file_buffer, ZSTR_VAL(call_entry->filename));
+	ce = xdmalloc(sizeof(xdebug_call_entry));
+	ce->filename = zend_string_copy(filename);
+	ce->function = xdstrdup(funcname);
+	ce->nanotime_taken = nanotime;
+	ce->lineno = lineno;
+	ce->user_defined = XDEBUG_USER_DEFINED;
+	ce->mem_used = memory;
 
-			xdebug_str_add_literal(&file_buffer, "\ncfn=");
-			add_functionname_ref(&file_buffer, call_entry->function);
-			xdebug_str_addc(&file_buffer, '\n');
+	xdebug_llist_insert_next(owner->profile.call_list, NULL, ce);
+
+	memcpy(tmp_key, TMP_KEY_PREFIX, TMP_KEY_PREFIX_LEN);
+
+	xdebug_str_add_literal(&file_buffer, "fl=");
+	add_filename_ref(&file_buffer, ZSTR_VAL(filename));
+
+	xdebug_str_add_literal(&file_buffer, "\nfn=");
+	add_functionname_ref(&file_buffer, funcname);
+	xdebug_str_addc(&file_buffer, '\n');
+
+	if (call_list) {
+		for (le = XDEBUG_LLIST_HEAD(call_list); le != NULL; le = XDEBUG_LLIST_NEXT(le))
+		{
+			xdebug_call_entry *call_entry = XDEBUG_LLIST_VALP(le);
+			nanotime -= call_entry->nanotime_taken;
+			memory -= call_entry->mem_used;
 		}
+	}
 
-		xdebug_str_add_literal(&file_buffer, "calls=1 0 0\n");
+	xdebug_str_add_uint64(&file_buffer, lineno);
+	xdebug_str_addc(&file_buffer, ' ');
+	xdebug_str_add_uint64(&file_buffer, NANOTIME_SCALE_10NS(nanotime));
+	xdebug_str_addc(&file_buffer, ' ');
+	xdebug_str_add_uint64(&file_buffer, memory >= 0 ? memory : 0);
+	xdebug_str_addc(&file_buffer, '\n');
 
-		/* Adds %d %lu %lu, with lineno, time, and memory */
-		xdebug_str_add_uint64(&file_buffer, call_entry->lineno);
-		xdebug_str_addc(&file_buffer, ' ');
-		xdebug_str_add_uint64(&file_buffer, NANOTIME_SCALE_10NS(call_entry->nanotime_taken));
-		xdebug_str_addc(&file_buffer, ' ');
-		xdebug_str_add_uint64(&file_buffer, call_entry->mem_used >= 0 ? call_entry->mem_used : 0);
-		xdebug_str_addc(&file_buffer, '\n');
+	if (call_list) {
+		add_call_list(&file_buffer, call_list, tmp_key);
 	}
 	xdebug_str_addc(&file_buffer, '\n');
 
@@ -519,6 +626,59 @@ void xdebug_profiler_function_end(function_stack_entry *fse)
 	xdebug_str_dtor(file_buffer);
 }
 
+/* While a span is open, the calls made by its owner are collected in a call
+ * list of their own, which becomes the span's list of callees */
+void xdebug_profiler_span_begin(function_stack_entry *owner, xdebug_span *span)
+{
+	if (!XG_PROF(active)) {
+		return;
+	}
+
+	span->profiled = true;
+	span->profile_call_list = owner->profile.call_list;
+	owner->profile.call_list = NULL;
+}
+
+void xdebug_profiler_span_end(function_stack_entry *owner, xdebug_span *span)
+{
+	xdebug_llist *span_call_list;
+	char         *funcname;
+
+	if (!span->profiled || !XG_PROF(active)) {
+		return;
+	}
+
+	span_call_list = owner->profile.call_list;
+	owner->profile.call_list = span->profile_call_list;
+	span->profile_call_list = NULL;
+	span->profiled = false;
+
+	funcname = xdebug_sprintf("span::%s", ZSTR_VAL(span->label));
+	add_synthetic_frame(
+		owner, span->filename, funcname, span->lineno,
+		xdebug_get_nanotime() - span->nanotime, zend_memory_usage(0) - span->memory,
+		span_call_list
+	);
+	xdfree(funcname);
+
+	if (span_call_list) {
+		xdebug_llist_destroy(span_call_list, NULL);
+	}
+}
+
+void xdebug_profiler_marker(function_stack_entry *owner, zend_string *label, zend_string *filename, int lineno)
+{
+	char *funcname;
+
+	if (!XG_PROF(active)) {
+		return;
+	}
+
+	funcname = xdebug_sprintf("marker::%s", ZSTR_VAL(label));
+	add_synthetic_frame(owner, filename, funcname, lineno, 0, 0, NULL);
+	xdfree(funcname);
+}
+
 void xdebug_profiler_free_function_details(function_stack_entry *fse)
 {
 	if (fse->profiler.funcname) {
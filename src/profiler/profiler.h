@@ -33,11 +33,26 @@ typedef struct _xdebug_profiler_globals_t {
 	int             php_internal_seen_before;
 	xdebug_hash    *profile_functionname_refs;
 	int             profile_last_functionname_ref;
+
+	/* Include costs, see include_stats.c */
+	xdebug_hash    *include_stats;
+	char           *include_report_basename;
+	zend_string    *include_once_pending;  /* operand of the last *_once, until it is known whether it compiled */
+	xdebug_hash    *include_once_resolved; /* operands of *_once, to the files the engine resolved them to */
+
+	/* Time per category, see categories.c */
+	HashTable                     *category_cache;
+	struct _xdebug_category_total *category_totals;
+	struct _xdebug_category_frame *category_stack;
+	size_t                         category_stack_count;
+	size_t                         category_stack_size;
 } xdebug_profiler_globals_t;
 
 typedef struct _xdebug_profiler_settings_t {
 	char         *profiler_output_name; /* "pid" or "crc32" */
 	zend_bool     profiler_append;
+	zend_bool     profiler_include_report;
+	char         *profiler_categories;
 } xdebug_profiler_settings_t;
 
 void xdebug_init_profiler_globals(xdebug_profiler_globals_t *xg);
@@ -64,6 +79,13 @@ void xdebug_profiler_free_function_details(function_stack_entry *fse);
 void xdebug_profiler_function_begin(function_stack_entry *fse);
 void xdebug_profiler_function_end(function_stack_entry *fse);
 
+/* See base/span.h */
+struct _xdebug_span;
+
+void xdebug_profiler_span_begin(function_stack_entry *owner, struct _xdebug_span *span);
+void xdebug_profiler_span_end(function_stack_entry *owner, struct _xdebug_span *span);
+void xdebug_profiler_marker(function_stack_entry *owner, zend_string *label, zend_string *filename, int lineno);
+
 void xdebug_profile_call_entry_dtor(void *dummy, void *elem);
 
 char *xdebug_get_profiler_filename(void);
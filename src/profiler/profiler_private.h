@@ -26,6 +26,8 @@ typedef struct _xdebug_call_entry {
 	long         mem_used;
 } xdebug_call_entry;
 
+#define NANOTIME_SCALE_10NS(nanotime) ((unsigned long)(((nanotime) + 5) / 10))
+
 #define XG_PROF(v)     (XG(globals.profiler.v))
 #define XINI_PROF(v)   (XG(settings.profiler.v))
 
@@ -0,0 +1,458 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#include "lib/php-header.h"
+#if PHP_VERSION_ID >= 80100
+# include "Zend/zend_fibers.h"
+#endif
+
+#include "php_xdebug.h"
+#include "tracing_private.h"
+#include "trace_chrome.h"
+
+#include "lib/lib_private.h"
+#include "lib/var_export_line.h"
+
+extern ZEND_DECLARE_MODULE_GLOBALS(xdebug);
+
+/* This handler writes the "JSON Array Format" of the Chrome Trace Event
+ * format, which can be loaded into chrome://tracing and Perfetto. Each
+ * function call is written as a single complete ("X") event when the function
+ * exits, so that events never need to be kept in memory, and a trace that is
+ * cut short is still readable, as the closing ']' is optional. */
+
+#define XDEBUG_CHROME_TS(nanotime) (((nanotime) - XG_BASE(start_nanotime)) / (double) NANOS_IN_MICROSEC)
+
+static void add_json_string(xdebug_str *str, const char *s, size_t len)
+{
+	size_t i, run_start = 0;
+
+	xdebug_str_addc(str, '"');
+
+	for (i = 0; i < len; i++) {
+		unsigned char c = (unsigned char) s[i];
+
+		if (c >= 0x20 && c != '"' && c != '\\') {
+			continue;
+		}
+
+		/* Add everything that did not need escaping in one go */
+		if (i > run_start) {
+			xdebug_str_addl(str, s + run_start, i - run_start, 0);
+		}
+		run_start = i + 1;
+
+		switch (c) {
+			case '"':  xdebug_str_add_literal(str, "\\\""); break;
+			case '\\': xdebug_str_add_literal(str, "\\\\"); break;
+			case '\n': xdebug_str_add_literal(str, "\\n"); break;
+			case '\r': xdebug_str_add_literal(str, "\\r"); break;
+			case '\t': xdebug_str_add_literal(str, "\\t"); break;
+			default:
+				xdebug_str_add_fmt(str, "\\u%04x", c);
+				break;
+		}
+	}
+
+	if (i > run_start) {
+		xdebug_str_addl(str, s + run_start, i - run_start, 0);
+	}
+
+	xdebug_str_addc(str, '"');
+}
+
+static void add_json_zval(xdebug_str *str, zval *zv)
+{
+	xdebug_str *tmp_value = xdebug_get_zval_value_line(zv, 0, NULL);
+
+	if (tmp_value) {
+		add_json_string(str, tmp_value->d, tmp_value->l);
+		xdebug_str_free(tmp_value);
+	} else {
+		xdebug_str_add_literal(str, "\"???\"");
+	}
+}
+
+static void write_event(xdebug_trace_chrome_context *context, xdebug_str *event)
+{
+	xdebug_file_printf(context->trace_file, "%s%s", context->events_written ? ",\n" : "", event->d);
+	xdebug_file_flush_if_interval_due(context->trace_file);
+	context->events_written++;
+}
+
+static void write_name_event(xdebug_trace_chrome_context *context, const char *type, int track_id, const char *name)
+{
+	xdebug_str str = XDEBUG_STR_INITIALIZER;
+
+	xdebug_str_add_fmt(&str, "{\"name\":\"%s\",\"ph\":\"M\",\"pid\":" ZEND_ULONG_FMT ",\"tid\":%d,\"args\":{\"name\":", type, context->pid, track_id);
+	add_json_string(&str, name, strlen(name));
+	xdebug_str_add_literal(&str, "}}");
+
+	write_event(context, &str);
+	xdfree(str.d);
+}
+
+static void write_sort_index_event(xdebug_trace_chrome_context *context, int track_id)
+{
+	xdebug_str str = XDEBUG_STR_INITIALIZER;
+
+	xdebug_str_add_fmt(&str, "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":" ZEND_ULONG_FMT ",\"tid\":%d,\"args\":{\"sort_index\":%d}}", context->pid, track_id, track_id);
+
+	write_event(context, &str);
+	xdfree(str.d);
+}
+
+static const char *track_name_for_stack(xdebug_vector *stack)
+{
+#if PHP_VERSION_ID >= 80100
+	function_stack_entry *head = XDEBUG_VECTOR_HEAD(stack);
+
+	/* Fiber stacks start with a synthetic frame that carries the Fiber's name */
+	if (head && head->function.type == XFUNC_FIBER) {
+		return head->function.function;
+	}
+#endif
+
+	return "{main}";
+}
+
+static zend_ulong current_fiber(void)
+{
+#if PHP_VERSION_ID >= 80100
+	return (zend_ulong) (uintptr_t) EG(current_fiber_context);
+#else
+	return 0;
+#endif
+}
+
+/* Returns the track (Chrome's "tid") for the currently running Fiber. Looking
+ * up the track only happens when a different Fiber runs. */
+static int find_track_id(xdebug_trace_chrome_context *context)
+{
+	zend_ulong  fiber = current_fiber();
+	void       *track_id = NULL;
+
+	if (context->last_track_id && fiber == context->last_fiber) {
+		return context->last_track_id;
+	}
+
+	if (!xdebug_hash_index_find(context->tracks, fiber, &track_id)) {
+		track_id = (void*) (intptr_t) context->next_track_id++;
+		xdebug_hash_index_add(context->tracks, fiber, track_id);
+
+		write_name_event(context, "thread_name", (int) (intptr_t) track_id, track_name_for_stack(XG_BASE(stack)));
+		write_sort_index_event(context, (int) (intptr_t) track_id);
+	}
+
+	context->last_fiber    = fiber;
+	context->last_track_id = (int) (intptr_t) track_id;
+
+	return context->last_track_id;
+}
+
+static void add_event_location(xdebug_str *str, xdebug_trace_chrome_context *context, uint64_t nanotime)
+{
+	xdebug_str_add_fmt(str, ",\"ts\":%.3F", XDEBUG_CHROME_TS(nanotime));
+	xdebug_str_add_fmt(str, ",\"pid\":" ZEND_ULONG_FMT ",\"tid\":%d", context->pid, find_track_id(context));
+}
+
+static void add_arguments(xdebug_trace_chrome_context *context, xdebug_str *str, function_stack_entry *fse)
+{
+	unsigned int j;
+	int          sent_variables = fse->varc;
+
+	if (sent_variables > 0 && fse->var[sent_variables-1].is_variadic && Z_ISUNDEF(fse->var[sent_variables-1].data)) {
+		sent_variables--;
+	}
+
+	xdebug_str_add_literal(str, ",\"params\":[");
+
+	for (j = 0; j < sent_variables; j++) {
+		if (j) {
+			xdebug_str_addc(str, ',');
+		}
+
+		if (Z_ISUNDEF(fse->var[j].data)) {
+			xdebug_str_add_literal(str, "\"???\"");
+		} else if (XINI_TRACE(collect_params_synopsis)) {
+			/* The scratch buffer is reused, so that no argument allocates */
+			context->synopsis.l = 0;
+			xdebug_add_zval_synopsis_line(&context->synopsis, &(fse->var[j].data));
+			add_json_string(str, context->synopsis.d, context->synopsis.l);
+		} else {
+			add_json_zval(str, &(fse->var[j].data));
+		}
+	}
+
+	xdebug_str_addc(str, ']');
+}
+
+void *xdebug_trace_chrome_init(char *fname, zend_string *script_filename, long options)
+{
+	xdebug_trace_chrome_context *tmp_chrome_context;
+
+	tmp_chrome_context = xdmalloc(sizeof(xdebug_trace_chrome_context));
+	tmp_chrome_context->trace_file = xdebug_trace_open_file(fname, script_filename, options);
+
+	if (!tmp_chrome_context->trace_file) {
+		xdfree(tmp_chrome_context);
+		return NULL;
+	}
+
+	tmp_chrome_context->script_filename = script_filename ? zend_string_copy(script_filename) : NULL;
+	tmp_chrome_context->pid             = xdebug_get_pid();
+	tmp_chrome_context->events_written  = 0;
+	tmp_chrome_context->tracks          = xdebug_hash_alloc(16, NULL);
+	tmp_chrome_context->last_fiber      = 0;
+	tmp_chrome_context->last_track_id   = 0;
+	tmp_chrome_context->next_track_id   = 1;
+	tmp_chrome_context->synopsis.l      = 0;
+	tmp_chrome_context->synopsis.a      = 0;
+	tmp_chrome_context->synopsis.d      = NULL;
+
+	return tmp_chrome_context;
+}
+
+void xdebug_trace_chrome_deinit(void *ctxt)
+{
+	xdebug_trace_chrome_context *context = (xdebug_trace_chrome_context*) ctxt;
+
+	xdebug_file_close(context->trace_file);
+	xdebug_file_dtor(context->trace_file);
+	context->trace_file = NULL;
+
+	xdebug_hash_destroy(context->tracks);
+	context->tracks = NULL;
+
+	xdebug_str_destroy(&context->synopsis);
+
+	if (context->script_filename) {
+		zend_string_release(context->script_filename);
+	}
+
+	xdfree(context);
+}
+
+void xdebug_trace_chrome_write_header(void *ctxt)
+{
+	xdebug_trace_chrome_context *context = (xdebug_trace_chrome_context*) ctxt;
+
+	/* The header is written again at the start of each trace file segment,
+	 * which also needs its own track metadata */
+	context->events_written = 0;
+	context->last_track_id  = 0;
+	xdebug_hash_destroy(context->tracks);
+	context->tracks = xdebug_hash_alloc(16, NULL);
+
+	xdebug_file_printf(context->trace_file, "[\n");
+
+	write_name_event(context, "process_name", 0, context->script_filename ? ZSTR_VAL(context->script_filename) : "php");
+
+	xdebug_file_flush(context->trace_file);
+}
+
+void xdebug_trace_chrome_write_footer(void *ctxt)
+{
+	xdebug_trace_chrome_context *context = (xdebug_trace_chrome_context*) ctxt;
+
+	xdebug_file_printf(context->trace_file, "\n]\n");
+	xdebug_file_flush(context->trace_file);
+}
+
+char *xdebug_trace_chrome_get_filename(void *ctxt)
+{
+	xdebug_trace_chrome_context *context = (xdebug_trace_chrome_context*) ctxt;
+
+	return context->trace_file->name;
+}
+
+void xdebug_trace_chrome_function_exit(void *ctxt, function_stack_entry *fse)
+{
+	xdebug_trace_chrome_context *context = (xdebug_trace_chrome_context*) ctxt;
+	xdebug_str                   str = XDEBUG_STR_INITIALIZER;
+	char                        *tmp_name;
+	uint64_t                     nanotime = fse->nanotime_end;
+
+	tmp_name = xdebug_fse_function_name(fse);
+	xdebug_str_add_literal(&str, "{\"name\":");
+	add_json_string(&str, tmp_name, strlen(tmp_name));
+
+	if (fse->user_defined == XDEBUG_USER_DEFINED) {
+		xdebug_str_add_literal(&str, ",\"cat\":\"user\",\"ph\":\"X\"");
+	} else {
+		xdebug_str_add_literal(&str, ",\"cat\":\"internal\",\"ph\":\"X\"");
+	}
+
+	add_event_location(&str, context, fse->nanotime);
+	xdebug_str_add_fmt(&str, ",\"dur\":%.3F", (nanotime - fse->nanotime) / (double) NANOS_IN_MICROSEC);
+
+	xdebug_str_add_fmt(&str, ",\"args\":{\"function_nr\":%d,\"file\":", fse->function_nr);
+	add_json_string(&str, ZSTR_VAL(fse->filename), ZSTR_LEN(fse->filename));
+	xdebug_str_add_fmt(&str, ",\"line\":%d", fse->lineno);
+	xdebug_str_add_fmt(&str, ",\"memory\":%ld,\"memory_delta\":%ld", fse->memory, fse->memory_end - fse->memory);
+
+	if (fse->include_filename) {
+		xdebug_str_add_literal(&str, ",\"include\":");
+		add_json_string(&str, ZSTR_VAL(fse->include_filename), ZSTR_LEN(fse->include_filename));
+	}
+
+	if (XINI_TRACE(collect_params)) {
+		add_arguments(context, &str, fse);
+	}
+
+	xdebug_str_add_literal(&str, "}}");
+
+	write_event(context, &str);
+	xdfree(str.d);
+}
+
+void xdebug_trace_chrome_function_return_value(void *ctxt, function_stack_entry *fse, zval *return_value)
+{
+	xdebug_trace_chrome_context *context = (xdebug_trace_chrome_context*) ctxt;
+	xdebug_str                   str = XDEBUG_STR_INITIALIZER;
+
+	xdebug_str_add_literal(&str, "{\"name\":\"return\",\"cat\":\"return\",\"ph\":\"i\",\"s\":\"t\"");
+	add_event_location(&str, context, fse->nanotime_end);
+	xdebug_str_add_fmt(&str, ",\"args\":{\"function_nr\":%d,\"value\":", fse->function_nr);
+	add_json_zval(&str, return_value);
+	xdebug_str_add_literal(&str, "}}");
+
+	write_event(context, &str);
+	xdfree(str.d);
+}
+
+void xdebug_trace_chrome_assignment(void *ctxt, function_stack_entry *fse, char *full_varname, zval *retval, char *right_full_varname, const char *op, char *filename, int lineno)
+{
+	xdebug_trace_chrome_context *context = (xdebug_trace_chrome_context*) ctxt;
+	xdebug_str                   str = XDEBUG_STR_INITIALIZER;
+
+	xdebug_str_add_literal(&str, "{\"name\":");
+	add_json_string(&str, full_varname, strlen(full_varname));
+	xdebug_str_add_literal(&str, ",\"cat\":\"assignment\",\"ph\":\"i\",\"s\":\"t\"");
+	add_event_location(&str, context, xdebug_get_nanotime());
+
+	xdebug_str_add_literal(&str, ",\"args\":{\"file\":");
+	add_json_string(&str, filename, strlen(filename));
+	xdebug_str_add_fmt(&str, ",\"line\":%d", lineno);
+
+	/* pre/post inc/dec ops are special */
+	if (op[0] != '\0') {
+		xdebug_str_add_literal(&str, ",\"op\":");
+		add_json_string(&str, op, strlen(op));
+
+		if (right_full_varname) {
+			xdebug_str_add_literal(&str, ",\"value\":");
+			add_json_string(&str, right_full_varname, strlen(right_full_varname));
+		} else if (retval) {
+			xdebug_str_add_literal(&str, ",\"value\":");
+			add_json_zval(&str, retval);
+		}
+	}
+
+	xdebug_str_add_literal(&str, "}}");
+
+	write_event(context, &str);
+	xdfree(str.d);
+}
+
+/* Calls that were left out because of xdebug.trace_call_limit are summarised
+ * as an instant event when their caller returns, as only their count and
+ * cumulative time are known */
+void xdebug_trace_chrome_suppressed_calls(void *ctxt, function_stack_entry *fse, xdebug_trace_call_count *count)
+{
+	xdebug_trace_chrome_context *context = (xdebug_trace_chrome_context*) ctxt;
+	xdebug_str                   str = XDEBUG_STR_INITIALIZER;
+
+	xdebug_str_add_literal(&str, "{\"name\":");
+	add_json_string(&str, count->function_name, strlen(count->function_name));
+	xdebug_str_add_literal(&str, ",\"cat\":\"suppressed\",\"ph\":\"i\",\"s\":\"t\"");
+	add_event_location(&str, context, xdebug_get_nanotime());
+	xdebug_str_add_fmt(&str, ",\"args\":{\"function_nr\":%d,\"calls\":%lu", fse->function_nr, (unsigned long) count->suppressed);
+	xdebug_str_add_fmt(&str, ",\"dur\":%.3F}}", count->nanotime / (double) NANOS_IN_MICROSEC);
+
+	write_event(context, &str);
+	xdfree(str.d);
+}
+
+/* Markers are instant events, and spans are complete events on the track of
+ * the frame that began them, written when they end */
+void xdebug_trace_chrome_marker(void *ctxt, function_stack_entry *fse, xdebug_trace_marker *marker)
+{
+	xdebug_trace_chrome_context *context = (xdebug_trace_chrome_context*) ctxt;
+	xdebug_str                   str = XDEBUG_STR_INITIALIZER;
+
+	if (marker->type == XDEBUG_TRACE_SPAN_BEGIN) {
+		return;
+	}
+
+	xdebug_str_add_literal(&str, "{\"name\":");
+	add_json_string(&str, ZSTR_VAL(marker->label), ZSTR_LEN(marker->label));
+
+	if (marker->type == XDEBUG_TRACE_MARKER) {
+		xdebug_str_add_literal(&str, ",\"cat\":\"marker\",\"ph\":\"i\",\"s\":\"t\"");
+		add_event_location(&str, context, marker->nanotime);
+	} else {
+		xdebug_str_add_literal(&str, ",\"cat\":\"span\",\"ph\":\"X\"");
+		add_event_location(&str, context, marker->nanotime_begin);
+		xdebug_str_add_fmt(&str, ",\"dur\":%.3F", (marker->nanotime - marker->nanotime_begin) / (double) NANOS_IN_MICROSEC);
+	}
+
+	xdebug_str_add_fmt(&str, ",\"args\":{\"function_nr\":%d", fse->function_nr);
+	if (marker->id) {
+		xdebug_str_add_fmt(&str, ",\"span\":%d", marker->id);
+	}
+	if (marker->attributes) {
+		xdebug_str_add_literal(&str, ",\"attributes\":");
+		add_json_zval(&str, marker->attributes);
+	}
+	xdebug_str_add_literal(&str, "}}");
+
+	write_event(context, &str);
+	xdfree(str.d);
+}
+
+#if PHP_VERSION_ID >= 80100
+/* A new Fiber can get the address of one that is gone, but not its track */
+void xdebug_trace_chrome_fiber_destroyed(void *ctxt, zend_fiber_context *fiber)
+{
+	xdebug_trace_chrome_context *context = (xdebug_trace_chrome_context*) ctxt;
+
+	xdebug_hash_index_delete(context->tracks, (zend_ulong) (uintptr_t) fiber);
+	if (context->last_fiber == (zend_ulong) (uintptr_t) fiber) {
+		context->last_track_id = 0;
+	}
+}
+#endif
+
+xdebug_trace_handler_t xdebug_trace_handler_chrome =
+{
+	xdebug_trace_chrome_init,
+	xdebug_trace_chrome_deinit,
+	xdebug_trace_chrome_write_header,
+	xdebug_trace_chrome_write_footer,
+	xdebug_trace_chrome_get_filename,
+	NULL /* xdebug_trace_chrome_function_entry */,
+	xdebug_trace_chrome_function_exit,
+	xdebug_trace_chrome_function_return_value,
+	NULL /* xdebug_trace_chrome_generator_return_value */,
+	xdebug_trace_chrome_assignment,
+	xdebug_trace_chrome_suppressed_calls,
+	xdebug_trace_chrome_marker,
+#if PHP_VERSION_ID >= 80100
+	xdebug_trace_chrome_fiber_destroyed
+#else
+	NULL /* xdebug_trace_chrome_fiber_destroyed */
+#endif
+};
@@ -0,0 +1,39 @@
+/*
+   +----------------------------------------------------------------------+
+   | Xdebug                                                               |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2002-2023 Derick Rethans                               |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 1.01 of the Xdebug license,   |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available at through the world-wide-web at                           |
+   | https://xdebug.org/license.php                                       |
+   | If you did not receive a copy of the Xdebug license and are unable   |
+   | to obtain it through the world-wide-web, please send a note to       |
+   | derick@xdebug.org so we can mail you a copy immediately.             |
+   +----------------------------------------------------------------------+
+ */
+#ifndef XDEBUG_TRACE_CHROME_H
+#define XDEBUG_TRACE_CHROME_H
+
+#include "tracing_private.h"
+
+typedef struct _xdebug_trace_chrome_context
+{
+	xdebug_file   *trace_file;
+	zend_string   *script_filename;
+	zend_ulong     pid;
+	size_t         events_written;
+
+	/* Each Fiber, including the main one, gets its own track */
+	xdebug_hash   *tracks;        /* by Fiber context address */
+	zend_ulong     last_fiber;
+	int            last_track_id; /* 0 when last_fiber is not set */
+	int            next_track_id;
+
+	/* Scratch buffer for argument synopses, see xdebug.collect_params_synopsis */
+	xdebug_str     synopsis;
+} xdebug_trace_chrome_context;
+
+extern xdebug_trace_handler_t xdebug_trace_handler_chrome;
+#endif
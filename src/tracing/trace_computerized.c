@@ -37,6 +37,10 @@ void *xdebug_trace_computerized_init(char *fname, zend_string *script_filename,
 		return NULL;
 	}
 
+	tmp_computerized_context->line.l = 0;
+	tmp_computerized_context->line.a = 0;
+	tmp_computerized_context->line.d = NULL;
+
 	return tmp_computerized_context;
 }
 
@@ -48,6 +52,7 @@ void xdebug_trace_computerized_deinit(void *ctxt)
 	xdebug_file_dtor(context->trace_file);
 	context->trace_file = NULL;
 
+	xdebug_str_destroy(&context->line);
 	xdfree(context);
 }
 
@@ -92,11 +97,24 @@ char *xdebug_trace_computerized_get_filename(void *ctxt)
 	return context->trace_file->name;
 }
 
+static xdebug_str *start_record(xdebug_trace_computerized_context *context)
+{
+	context->line.l = 0;
+
+	return &context->line;
+}
+
+static void write_record(xdebug_trace_computerized_context *context)
+{
+	xdebug_file_write(context->line.d, 1, context->line.l, context->trace_file);
+	xdebug_file_flush_if_due(context->trace_file);
+}
+
 static void add_single_value(xdebug_str *str, zval *zv)
 {
 	xdebug_str *tmp_value = NULL;
 
-	tmp_value = xdebug_get_zval_value_line(zv, 0, NULL);
+	tmp_value = xdebug_trace_format_value(zv);
 
 	if (tmp_value) {
 		xdebug_str_add_str(str, tmp_value);
@@ -122,10 +140,12 @@ static void add_arguments(xdebug_str *line_entry, function_stack_entry *fse)
 	for (j = 0; j < sent_variables; j++) {
 		xdebug_str_addc(line_entry, '\t');
 
-		if (!Z_ISUNDEF(fse->var[j].data)) {
-			add_single_value(line_entry, &(fse->var[j].data));
-		} else {
+		if (Z_ISUNDEF(fse->var[j].data)) {
 			xdebug_str_add_literal(line_entry, "???");
+		} else if (XINI_TRACE(collect_params_synopsis)) {
+			xdebug_add_zval_synopsis_line(line_entry, &(fse->var[j].data));
+		} else {
+			add_single_value(line_entry, &(fse->var[j].data));
 		}
 	}
 }
@@ -134,23 +154,22 @@ void xdebug_trace_computerized_function_entry(void *ctxt, function_stack_entry *
 {
 	xdebug_trace_computerized_context *context = (xdebug_trace_computerized_context*) ctxt;
 	char *tmp_name;
-	xdebug_str str = XDEBUG_STR_INITIALIZER;
+	xdebug_str *str = start_record(context);
 
-	xdebug_str_add_fmt(&str, "%d\t", fse->level);
-	xdebug_str_add_fmt(&str, "%d\t", fse->function_nr);
+	xdebug_str_add_fmt(str, "%d\t", fse->level);
+	xdebug_str_add_fmt(str, "%d\t", fse->function_nr);
 
-	tmp_name = xdebug_show_fname(fse->function, XDEBUG_SHOW_FNAME_DEFAULT);
+	tmp_name = xdebug_fse_function_name(fse);
 
-	xdebug_str_add_literal(&str, "0\t");
-	xdebug_str_add_fmt(&str, "%F\t", XDEBUG_SECONDS_SINCE_START(fse->nanotime));
-	xdebug_str_add_fmt(&str, "%lu\t", fse->memory);
-	xdebug_str_add_fmt(&str, "%s\t", tmp_name);
+	xdebug_str_add_literal(str, "0\t");
+	xdebug_str_add_fmt(str, "%F\t", XDEBUG_SECONDS_SINCE_START(fse->nanotime));
+	xdebug_str_add_fmt(str, "%lu\t", fse->memory);
+	xdebug_str_add_fmt(str, "%s\t", tmp_name);
 	if (fse->user_defined == XDEBUG_USER_DEFINED) {
-		xdebug_str_add_literal(&str, "1\t");
+		xdebug_str_add_literal(str, "1\t");
 	} else {
-		xdebug_str_add_literal(&str, "0\t");
+		xdebug_str_add_literal(str, "0\t");
 	}
-	xdfree(tmp_name);
 
 	if (fse->include_filename) {
 		if (fse->function.type == XFUNC_EVAL) {
@@ -158,105 +177,162 @@ void xdebug_trace_computerized_function_entry(void *ctxt, function_stack_entry *
 
 			escaped = php_addcslashes(fse->include_filename, (char*) "'\\\0..\37", 6);
 
-			xdebug_str_addc(&str, '\'');
-			xdebug_str_add_zstr(&str, escaped);
-			xdebug_str_addc(&str, '\'');
+			xdebug_str_addc(str, '\'');
+			xdebug_str_add_zstr(str, escaped);
+			xdebug_str_addc(str, '\'');
 			zend_string_release(escaped);
 		} else {
-			xdebug_str_add_zstr(&str, fse->include_filename);
+			xdebug_str_add_zstr(str, fse->include_filename);
 		}
 	}
 
 	/* Filename and Lineno (9, 10) */
-	xdebug_str_add_fmt(&str, "\t%s\t%d", ZSTR_VAL(fse->filename), fse->lineno);
+	xdebug_str_add_fmt(str, "\t%s\t%d", ZSTR_VAL(fse->filename), fse->lineno);
 
 	if (XINI_TRACE(collect_params)) {
-		add_arguments(&str, fse);
+		add_arguments(str, fse);
 	}
 
 	/* Trailing \n */
-	xdebug_str_addc(&str, '\n');
+	xdebug_str_addc(str, '\n');
 
-	xdebug_file_printf(context->trace_file, "%s", str.d);
-	xdebug_file_flush(context->trace_file);
-	xdfree(str.d);
+	write_record(context);
 }
 
 void xdebug_trace_computerized_function_exit(void *ctxt, function_stack_entry *fse)
 {
 	xdebug_trace_computerized_context *context = (xdebug_trace_computerized_context*) ctxt;
-	xdebug_str str = XDEBUG_STR_INITIALIZER;
+	xdebug_str *str = start_record(context);
 
-	xdebug_str_add_fmt(&str, "%d\t", fse->level);
-	xdebug_str_add_fmt(&str, "%d\t", fse->function_nr);
+	xdebug_str_add_fmt(str, "%d\t", fse->level);
+	xdebug_str_add_fmt(str, "%d\t", fse->function_nr);
 
-	xdebug_str_add_literal(&str, "1\t");
-	xdebug_str_add_fmt(&str, "%F\t", XDEBUG_SECONDS_SINCE_START(xdebug_get_nanotime()));
-	xdebug_str_add_fmt(&str, "%lu\n", zend_memory_usage(0));
+	xdebug_str_add_literal(str, "1\t");
+	xdebug_str_add_fmt(str, "%F\t", XDEBUG_SECONDS_SINCE_START(fse->nanotime_end));
+	xdebug_str_add_fmt(str, "%lu\n", fse->memory_end);
 
-	xdebug_file_printf(context->trace_file, "%s", str.d);
-	xdebug_file_flush(context->trace_file);
-	xdfree(str.d);
+	write_record(context);
 }
 
 void xdebug_trace_computerized_function_return_value(void *ctxt, function_stack_entry *fse, zval *return_value)
 {
 	xdebug_trace_computerized_context *context = (xdebug_trace_computerized_context*) ctxt;
-	xdebug_str str = XDEBUG_STR_INITIALIZER;
+	xdebug_str *str = start_record(context);
 
-	xdebug_str_add_fmt(&str, "%d\t", fse->level);
-	xdebug_str_add_fmt(&str, "%d\t", fse->function_nr);
-	xdebug_str_add_literal(&str, "R\t\t\t");
+	xdebug_str_add_fmt(str, "%d\t", fse->level);
+	xdebug_str_add_fmt(str, "%d\t", fse->function_nr);
+	xdebug_str_add_literal(str, "R\t\t\t");
 
-	add_single_value(&str, return_value);
+	add_single_value(str, return_value);
 
-	xdebug_str_add_literal(&str, "\n");
+	xdebug_str_add_literal(str, "\n");
 
-	xdebug_file_printf(context->trace_file, "%s", str.d);
-	xdebug_file_flush(context->trace_file);
-	xdfree(str.d);
+	write_record(context);
 }
 
 void xdebug_trace_computerized_assignment(void *ctxt, function_stack_entry *fse, char *full_varname, zval *retval, char *right_full_varname, const char *op, char *filename, int lineno)
 {
 	xdebug_trace_computerized_context *context = (xdebug_trace_computerized_context*) ctxt;
-	xdebug_str                         str = XDEBUG_STR_INITIALIZER;
+	xdebug_str                        *str = start_record(context);
 	xdebug_str                        *tmp_value;
 
-	xdebug_str_add_fmt(&str, "%d\t", fse->level);
+	xdebug_str_add_fmt(str, "%d\t", fse->level);
 	/* no function_nr */
-	xdebug_str_add_literal(&str, "\t");
+	xdebug_str_add_literal(str, "\t");
 
-	xdebug_str_add_literal(&str, "A\t");
+	xdebug_str_add_literal(str, "A\t");
 	/* skip time index, memory usage, function name, user defined */
-	xdebug_str_add_literal(&str, "\t\t\t\t");
+	xdebug_str_add_literal(str, "\t\t\t\t");
 
 	/* Filename and Lineno (9, 10) */
-	xdebug_str_add_fmt(&str, "\t%s\t%d", filename, lineno);
-	xdebug_str_add_fmt(&str, "\t%s", full_varname);
+	xdebug_str_add_fmt(str, "\t%s\t%d", filename, lineno);
+	xdebug_str_add_fmt(str, "\t%s", full_varname);
 
 	if (op[0] != '\0' ) { /* pre/post inc/dec ops are special */
-		xdebug_str_addc(&str, ' ');
-		xdebug_str_add(&str, op, 0);
-		xdebug_str_addc(&str, ' ');
+		xdebug_str_addc(str, ' ');
+		xdebug_str_add(str, op, 0);
+		xdebug_str_addc(str, ' ');
 
 		tmp_value = xdebug_get_zval_value_line(retval, 0, NULL);
 
 		if (tmp_value) {
-			xdebug_str_add_str(&str, tmp_value);
+			xdebug_str_add_str(str, tmp_value);
 			xdebug_str_free(tmp_value);
 		} else {
-			xdebug_str_add_literal(&str, "NULL");
+			xdebug_str_add_literal(str, "NULL");
 		}
 	}
 
 	/* Trailing \n */
-	xdebug_str_add_literal(&str, "\n");
+	xdebug_str_add_literal(str, "\n");
 
-	xdebug_file_printf(context->trace_file, "%s", str.d);
-	xdebug_file_flush(context->trace_file);
+	write_record(context);
+}
+
+void xdebug_trace_computerized_suppressed_calls(void *ctxt, function_stack_entry *fse, xdebug_trace_call_count *count)
+{
+	xdebug_trace_computerized_context *context = (xdebug_trace_computerized_context*) ctxt;
+	xdebug_str                        *str = start_record(context);
+
+	/* The summary is at the level of the calls it replaces */
+	xdebug_str_add_fmt(str, "%d\t", fse->level + 1);
+	/* no function_nr */
+	xdebug_str_add_literal(str, "\t");
+
+	xdebug_str_add_literal(str, "S\t");
+	xdebug_str_add_fmt(str, "%F\t", XDEBUG_SECONDS_SINCE_START(xdebug_get_nanotime()));
+	xdebug_str_add_fmt(str, "%lu\t", zend_memory_usage(0));
+	xdebug_str_add_fmt(str, "%s\t", count->function_name);
+
+	/* Number of calls left out, and their cumulative time */
+	xdebug_str_add_fmt(str, "%lu\t", (unsigned long) count->suppressed);
+	xdebug_str_add_fmt(str, "%F\n", (double) count->nanotime / NANOS_IN_SEC);
+
+	write_record(context);
+}
+
+void xdebug_trace_computerized_marker(void *ctxt, function_stack_entry *fse, xdebug_trace_marker *marker)
+{
+	xdebug_trace_computerized_context *context = (xdebug_trace_computerized_context*) ctxt;
+	xdebug_str                        *str = start_record(context);
+	zend_string                       *escaped;
+
+	/* Markers are at the level of the calls made by the frame that wrote them */
+	xdebug_str_add_fmt(str, "%d\t", fse->level + 1);
+	/* no function_nr */
+	xdebug_str_add_literal(str, "\t");
+
+	xdebug_str_add_literal(str, "M\t");
+	xdebug_str_add_fmt(str, "%F\t", XDEBUG_SECONDS_SINCE_START(marker->nanotime));
+	xdebug_str_add_fmt(str, "%lu\t", zend_memory_usage(0));
+
+	switch (marker->type) {
+		case XDEBUG_TRACE_MARKER:
+			xdebug_str_add_literal(str, "marker\t");
+			break;
+		case XDEBUG_TRACE_SPAN_BEGIN:
+			xdebug_str_add_literal(str, "begin\t");
+			break;
+		case XDEBUG_TRACE_SPAN_END:
+			xdebug_str_add_literal(str, "end\t");
+			break;
+	}
+	xdebug_str_add_fmt(str, "%d\t", marker->id);
+
+	escaped = php_addcslashes(marker->label, (char*) "'\\\0..\37", 6);
+	xdebug_str_add_zstr(str, escaped);
+	zend_string_release(escaped);
+
+	/* Attributes for markers and span begins, the duration for span ends */
+	if (marker->type == XDEBUG_TRACE_SPAN_END) {
+		xdebug_str_add_fmt(str, "\t%F", (double) (marker->nanotime - marker->nanotime_begin) / NANOS_IN_SEC);
+	} else if (marker->attributes) {
+		xdebug_str_addc(str, '\t');
+		add_single_value(str, marker->attributes);
+	}
+	xdebug_str_addc(str, '\n');
 
-	xdfree(str.d);
+	write_record(context);
 }
 
 xdebug_trace_handler_t xdebug_trace_handler_computerized =
@@ -270,5 +346,8 @@ xdebug_trace_handler_t xdebug_trace_handler_computerized =
 	xdebug_trace_computerized_function_exit,
 	xdebug_trace_computerized_function_return_value,
 	NULL /* xdebug_trace_computerized_generator_return_value */,
-	xdebug_trace_computerized_assignment
+	xdebug_trace_computerized_assignment,
+	xdebug_trace_computerized_suppressed_calls,
+	xdebug_trace_computerized_marker,
+	NULL /* xdebug_trace_computerized_fiber_destroyed */
 };
@@ -21,6 +21,7 @@
 typedef struct _xdebug_trace_computerized_context
 {
 	xdebug_file *trace_file;
+	xdebug_str   line; /* reused for every record */
 } xdebug_trace_computerized_context;
 
 extern xdebug_trace_handler_t xdebug_trace_handler_computerized;
@@ -109,7 +109,7 @@ static inline int compute_inclusive_value(const xdebug_trace_flamegraph_context
 		case XDEBUG_TRACE_OPTION_FLAMEGRAPH_MEM:
 			/* We compare with 'memory' because 'prev_memory' is not memory when starting the
 			 * function execution, 'memory' is. */
-			current_mem = zend_memory_usage(0);
+			current_mem = fse->memory_end;
 			if (current_mem < fse->memory) {
 				/* When memory is below 0, flamegraph generator will error, and you won't have a
 				 * good visual. This happens when garbage collection happened during this function
@@ -121,7 +121,7 @@ static inline int compute_inclusive_value(const xdebug_trace_flamegraph_context
 			break;
 
 		case XDEBUG_TRACE_OPTION_FLAMEGRAPH_COST:
-			value = xdebug_get_nanotime() - fse->nanotime;
+			value = fse->nanotime_end - fse->nanotime;
 			break;
 	}
 
@@ -188,7 +188,7 @@ void xdebug_trace_flamegraph_function_entry(void *ctxt, function_stack_entry *fs
 	xdebug_str                      *prefix = xdebug_str_new();
 	char                            *tmp_name;
 
-	tmp_name = xdebug_show_fname(fse->function, XDEBUG_SHOW_FNAME_DEFAULT);
+	tmp_name = xdebug_fse_function_name(fse);
 	function = fg_function_ctor();
 
 	parent_fse = fg_parent_find();
@@ -212,7 +212,6 @@ void xdebug_trace_flamegraph_function_entry(void *ctxt, function_stack_entry *fs
 
 	fg_function_add(context, fse->function_nr, function);
 
-	xdfree(tmp_name);
 }
 
 void xdebug_trace_flamegraph_function_exit(void *ctxt, function_stack_entry *fse)
@@ -249,6 +248,31 @@ void xdebug_trace_flamegraph_function_exit(void *ctxt, function_stack_entry *fse
 	}
 
 	xdebug_file_printf(context->trace_file, "%s", str.d);
+	xdebug_file_flush_if_interval_due(context->trace_file);
+	xdfree(str.d);
+}
+
+void xdebug_trace_flamegraph_suppressed_calls(void *ctxt, function_stack_entry *fse, xdebug_trace_call_count *count)
+{
+	xdebug_trace_flamegraph_context *context = (xdebug_trace_flamegraph_context*) ctxt;
+	flamegraph_function             *parent_function;
+	xdebug_str                       str = XDEBUG_STR_INITIALIZER;
+
+	/* Only the time of the left out calls is known */
+	if (context->mode != XDEBUG_TRACE_OPTION_FLAMEGRAPH_COST) {
+		return;
+	}
+
+	parent_function = fg_function_find(context, fse->function_nr);
+	if (!parent_function) {
+		return;
+	}
+
+	xdebug_str_add_fmt(&str, "%s;%s %d\n", parent_function->prefix->d, count->function_name, (int) count->nanotime);
+	parent_function->value += (int) count->nanotime;
+
+	xdebug_file_printf(context->trace_file, "%s", str.d);
+	xdebug_file_flush_if_interval_due(context->trace_file);
 	xdfree(str.d);
 }
 
@@ -263,7 +287,10 @@ xdebug_trace_handler_t xdebug_trace_handler_flamegraph_cost =
 	xdebug_trace_flamegraph_function_exit,
 	NULL /* xdebug_trace_flamegraph_function_return_value */,
 	NULL /* xdebug_trace_flamegraph_generator_return_value */,
-	NULL /* xdebug_trace_flamegraph_assignment */
+	NULL /* xdebug_trace_flamegraph_assignment */,
+	xdebug_trace_flamegraph_suppressed_calls,
+	NULL /* xdebug_trace_flamegraph_marker */,
+	NULL /* xdebug_trace_flamegraph_fiber_destroyed */
 };
 
 xdebug_trace_handler_t xdebug_trace_handler_flamegraph_mem =
@@ -277,5 +304,8 @@ xdebug_trace_handler_t xdebug_trace_handler_flamegraph_mem =
 	xdebug_trace_flamegraph_function_exit,
 	NULL /* xdebug_trace_flamegraph_function_return_value */,
 	NULL /* xdebug_trace_flamegraph_generator_return_value */,
-	NULL /* xdebug_trace_flamegraph_assignment */
+	NULL /* xdebug_trace_flamegraph_assignment */,
+	xdebug_trace_flamegraph_suppressed_calls,
+	NULL /* xdebug_trace_flamegraph_marker */,
+	NULL /* xdebug_trace_flamegraph_fiber_destroyed */
 };
@@ -19,6 +19,8 @@
 #include "tracing_private.h"
 #include "trace_html.h"
 
+#include "ext/standard/html.h"
+
 #include "lib/var.h"
 
 extern ZEND_DECLARE_MODULE_GLOBALS(xdebug);
@@ -92,9 +94,8 @@ void xdebug_trace_html_function_entry(void *ctxt, function_stack_entry *fse)
 	}
 	xdebug_str_add_literal(&str, "-&gt;</td>");
 
-	tmp_name = xdebug_show_fname(fse->function, XDEBUG_SHOW_FNAME_DEFAULT);
+	tmp_name = xdebug_fse_function_name(fse);
 	xdebug_str_add_fmt(&str, "<td>%s(", tmp_name);
-	xdfree(tmp_name);
 
 	if (fse->include_filename) {
 		if (fse->function.type == XFUNC_EVAL) {
@@ -117,7 +118,77 @@ void xdebug_trace_html_function_entry(void *ctxt, function_stack_entry *fse)
 	xdebug_str_add_literal(&str, "</tr>\n");
 
 	xdebug_file_printf(context->trace_file, "%s", str.d);
-	xdebug_file_flush(context->trace_file);
+	xdebug_file_flush_if_due(context->trace_file);
+	xdfree(str.d);
+}
+
+void xdebug_trace_html_suppressed_calls(void *ctxt, function_stack_entry *fse, xdebug_trace_call_count *count)
+{
+	xdebug_trace_html_context *context = (xdebug_trace_html_context*) ctxt;
+	unsigned int j;
+	xdebug_str str = XDEBUG_STR_INITIALIZER;
+
+	xdebug_str_add_literal(&str, "\t<tr>");
+	xdebug_str_add_literal(&str, "<td></td>");
+	xdebug_str_add_fmt(&str, "<td>%0.6F</td>", XDEBUG_SECONDS_SINCE_START(xdebug_get_nanotime()));
+	xdebug_str_add_fmt(&str, "<td align='right'>%lu</td>", zend_memory_usage(0));
+
+	/* The summary is at the level of the calls it replaces */
+	xdebug_str_add_literal(&str, "<td align='left'>");
+	for (j = 0; j < fse->level; j++) {
+		xdebug_str_add_literal(&str, "&nbsp; &nbsp;");
+	}
+	xdebug_str_add_literal(&str, "-&gt;</td>");
+
+	xdebug_str_add_fmt(&str, "<td colspan='2'><i>%s() x %lu more calls, %F sec</i></td>", count->function_name, (unsigned long) count->suppressed, (double) count->nanotime / NANOS_IN_SEC);
+	xdebug_str_add_literal(&str, "</tr>\n");
+
+	xdebug_file_printf(context->trace_file, "%s", str.d);
+	xdebug_file_flush_if_due(context->trace_file);
+	xdfree(str.d);
+}
+
+void xdebug_trace_html_marker(void *ctxt, function_stack_entry *fse, xdebug_trace_marker *marker)
+{
+	xdebug_trace_html_context *context = (xdebug_trace_html_context*) ctxt;
+	unsigned int j;
+	xdebug_str str = XDEBUG_STR_INITIALIZER;
+	zend_string *escaped;
+
+	xdebug_str_add_literal(&str, "\t<tr>");
+	xdebug_str_add_literal(&str, "<td></td>");
+	xdebug_str_add_fmt(&str, "<td>%0.6F</td>", XDEBUG_SECONDS_SINCE_START(marker->nanotime));
+	xdebug_str_add_fmt(&str, "<td align='right'>%lu</td>", zend_memory_usage(0));
+	xdebug_str_add_literal(&str, "<td align='left'>");
+	for (j = 0; j < fse->level; j++) {
+		xdebug_str_add_literal(&str, "&nbsp; &nbsp;");
+	}
+	xdebug_str_add_literal(&str, "--</td>");
+
+	switch (marker->type) {
+		case XDEBUG_TRACE_MARKER:
+			xdebug_str_add_literal(&str, "<td colspan='2'><i>marker ");
+			break;
+		case XDEBUG_TRACE_SPAN_BEGIN:
+			xdebug_str_add_fmt(&str, "<td colspan='2'><i>span #%d begin ", marker->id);
+			break;
+		case XDEBUG_TRACE_SPAN_END:
+			xdebug_str_add_fmt(&str, "<td colspan='2'><i>span #%d end ", marker->id);
+			break;
+	}
+
+	escaped = php_escape_html_entities((unsigned char *) ZSTR_VAL(marker->label), ZSTR_LEN(marker->label), 0, ENT_QUOTES, NULL);
+	xdebug_str_add_zstr(&str, escaped);
+	zend_string_release(escaped);
+
+	if (marker->type == XDEBUG_TRACE_SPAN_END) {
+		xdebug_str_add_fmt(&str, ", %F sec", (double) (marker->nanotime - marker->nanotime_begin) / NANOS_IN_SEC);
+	}
+	xdebug_str_add_literal(&str, "</i></td>");
+	xdebug_str_add_literal(&str, "</tr>\n");
+
+	xdebug_file_printf(context->trace_file, "%s", str.d);
+	xdebug_file_flush_if_due(context->trace_file);
 	xdfree(str.d);
 }
 
@@ -132,5 +203,8 @@ xdebug_trace_handler_t xdebug_trace_handler_html =
 	NULL /* xdebug_trace_html_function_exit */,
 	NULL /* xdebug_trace_html_function_return_value */,
 	NULL /* xdebug_trace_html_generator_return_value */,
-	NULL /* xdebug_trace_html_assignment */
+	NULL /* xdebug_trace_html_assignment */,
+	xdebug_trace_html_suppressed_calls,
+	xdebug_trace_html_marker,
+	NULL /* xdebug_trace_html_fiber_destroyed */
 };
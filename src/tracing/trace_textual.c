@@ -95,7 +95,7 @@ static void add_single_value(xdebug_str *str, zval *zv)
 {
 	xdebug_str *tmp_value = NULL;
 
-	tmp_value = xdebug_get_zval_value_line(zv, 0, NULL);
+	tmp_value = xdebug_trace_format_value(zv);
 
 	if (tmp_value) {
 		xdebug_str_add_str(str, tmp_value);
@@ -152,10 +152,12 @@ static void add_arguments(xdebug_str *line_entry, function_stack_entry *fse)
 			xdebug_str_add_fmt(line_entry, "%d => ", variadic_count++);
 		}
 
-		if (!Z_ISUNDEF(fse->var[j].data)) {
-			add_single_value(line_entry, &fse->var[j].data);
-		} else {
+		if (Z_ISUNDEF(fse->var[j].data)) {
 			xdebug_str_add_literal(line_entry, "???");
+		} else if (XINI_TRACE(collect_params_synopsis)) {
+			xdebug_add_zval_synopsis_line(line_entry, &fse->var[j].data);
+		} else {
+			add_single_value(line_entry, &fse->var[j].data);
 		}
 	}
 
@@ -171,7 +173,7 @@ void xdebug_trace_textual_function_entry(void *ctxt, function_stack_entry *fse)
 	char *tmp_name;
 	xdebug_str str = XDEBUG_STR_INITIALIZER;
 
-	tmp_name = xdebug_show_fname(fse->function, XDEBUG_SHOW_FNAME_DEFAULT);
+	tmp_name = xdebug_fse_function_name(fse);
 
 	xdebug_str_add_fmt(&str, "%10.4F ", XDEBUG_SECONDS_SINCE_START(fse->nanotime));
 	xdebug_str_add_fmt(&str, "%10lu ", fse->memory);
@@ -180,7 +182,6 @@ void xdebug_trace_textual_function_entry(void *ctxt, function_stack_entry *fse)
 	}
 	xdebug_str_add_fmt(&str, "-> %s(", tmp_name);
 
-	xdfree(tmp_name);
 
 	if (XINI_TRACE(collect_params)) {
 		add_arguments(&str, fse);
@@ -204,7 +205,7 @@ void xdebug_trace_textual_function_entry(void *ctxt, function_stack_entry *fse)
 	xdebug_str_add_fmt(&str, ") %s:%d\n", ZSTR_VAL(fse->filename), fse->lineno);
 
 	xdebug_file_printf(context->trace_file, "%s", str.d);
-	xdebug_file_flush(context->trace_file);
+	xdebug_file_flush_if_due(context->trace_file);
 
 	xdfree(str.d);
 }
@@ -214,8 +215,8 @@ static void xdebug_return_trace_stack_common(xdebug_str *str, function_stack_ent
 {
 	unsigned int j = 0; /* Counter */
 
-	xdebug_str_add_fmt(str, "%10.4F ", XDEBUG_SECONDS_SINCE_START(xdebug_get_nanotime()));
-	xdebug_str_add_fmt(str, "%10lu ", zend_memory_usage(0));
+	xdebug_str_add_fmt(str, "%10.4F ", XDEBUG_SECONDS_SINCE_START(fse->nanotime_end));
+	xdebug_str_add_fmt(str, "%10lu ", fse->memory_end);
 
 	for (j = 0; j < fse->level; j++) {
 		xdebug_str_add_literal(str, "  ");
@@ -232,7 +233,7 @@ void xdebug_trace_textual_function_return_value(void *ctxt, function_stack_entry
 
 	xdebug_return_trace_stack_common(&str, fse);
 
-	tmp_value = xdebug_get_zval_value_line(return_value, 0, NULL);
+	tmp_value = xdebug_trace_format_value(return_value);
 	if (tmp_value) {
 		xdebug_str_add_str(&str, tmp_value);
 		xdebug_str_free(tmp_value);
@@ -240,7 +241,7 @@ void xdebug_trace_textual_function_return_value(void *ctxt, function_stack_entry
 	xdebug_str_addc(&str, '\n');
 
 	xdebug_file_printf(context->trace_file, "%s", str.d);
-	xdebug_file_flush(context->trace_file);
+	xdebug_file_flush_if_due(context->trace_file);
 
 	xdebug_str_destroy(&str);
 }
@@ -260,7 +261,7 @@ void xdebug_trace_textual_generator_return_value(void *ctxt, function_stack_entr
 	}
 
 	/* Generator key */
-	tmp_value = xdebug_get_zval_value_line(&generator->key, 0, NULL);
+	tmp_value = xdebug_trace_format_value(&generator->key);
 	if (!tmp_value) {
 		return;
 	}
@@ -272,7 +273,7 @@ void xdebug_trace_textual_generator_return_value(void *ctxt, function_stack_entr
 	xdebug_str_add_literal(&str, " => ");
 	xdebug_str_free(tmp_value);
 
-	tmp_value = xdebug_get_zval_value_line(&generator->value, 0, NULL);
+	tmp_value = xdebug_trace_format_value(&generator->value);
 	if (tmp_value) {
 		xdebug_str_add_str(&str, tmp_value);
 		xdebug_str_free(tmp_value);
@@ -281,7 +282,7 @@ void xdebug_trace_textual_generator_return_value(void *ctxt, function_stack_entr
 	xdebug_str_add_literal(&str, ")\n");
 
 	xdebug_file_printf(context->trace_file, "%s", str.d);
-	xdebug_file_flush(context->trace_file);
+	xdebug_file_flush_if_due(context->trace_file);
 
 	xdebug_str_destroy(&str);
 }
@@ -323,11 +324,79 @@ void xdebug_trace_textual_assignment(void *ctxt, function_stack_entry *fse, char
 	xdebug_str_add_fmt(&str, " %s:%d\n", filename, lineno);
 
 	xdebug_file_printf(context->trace_file, "%s", str.d);
-	xdebug_file_flush(context->trace_file);
+	xdebug_file_flush_if_due(context->trace_file);
 
 	xdfree(str.d);
 }
 
+void xdebug_trace_textual_suppressed_calls(void *ctxt, function_stack_entry *fse, xdebug_trace_call_count *count)
+{
+	xdebug_trace_textual_context *context = (xdebug_trace_textual_context*) ctxt;
+	unsigned int                  j = 0;
+	xdebug_str                    str = XDEBUG_STR_INITIALIZER;
+
+	xdebug_str_add_fmt(&str, "%10.4F ", XDEBUG_SECONDS_SINCE_START(xdebug_get_nanotime()));
+	xdebug_str_add_fmt(&str, "%10lu ", zend_memory_usage(0));
+
+	/* The summary is at the level of the calls it replaces */
+	for (j = 0; j <= fse->level; j++) {
+		xdebug_str_add_literal(&str, "  ");
+	}
+	xdebug_str_add_fmt(&str, "-> %s() x %lu more calls, %F sec\n", count->function_name, (unsigned long) count->suppressed, (double) count->nanotime / NANOS_IN_SEC);
+
+	xdebug_file_printf(context->trace_file, "%s", str.d);
+	xdebug_file_flush_if_due(context->trace_file);
+
+	xdebug_str_destroy(&str);
+}
+
+void xdebug_trace_textual_marker(void *ctxt, function_stack_entry *fse, xdebug_trace_marker *marker)
+{
+	xdebug_trace_textual_context *context = (xdebug_trace_textual_context*) ctxt;
+	unsigned int                  j = 0;
+	xdebug_str                    str = XDEBUG_STR_INITIALIZER;
+	zend_string                  *escaped;
+
+	xdebug_str_add_fmt(&str, "%10.4F ", XDEBUG_SECONDS_SINCE_START(marker->nanotime));
+	xdebug_str_add_fmt(&str, "%10lu ", zend_memory_usage(0));
+
+	/* Markers are at the level of the calls made by the frame that wrote them */
+	for (j = 0; j <= fse->level; j++) {
+		xdebug_str_add_literal(&str, "  ");
+	}
+
+	switch (marker->type) {
+		case XDEBUG_TRACE_MARKER:
+			xdebug_str_add_literal(&str, "-- marker '");
+			break;
+		case XDEBUG_TRACE_SPAN_BEGIN:
+			xdebug_str_add_fmt(&str, "-- span #%d begin '", marker->id);
+			break;
+		case XDEBUG_TRACE_SPAN_END:
+			xdebug_str_add_fmt(&str, "-- span #%d end '", marker->id);
+			break;
+	}
+
+	escaped = php_addcslashes(marker->label, (char*) "'\\\0..\37", 6);
+	xdebug_str_add_zstr(&str, escaped);
+	xdebug_str_addc(&str, '\'');
+	zend_string_release(escaped);
+
+	if (marker->attributes) {
+		xdebug_str_addc(&str, ' ');
+		add_single_value(&str, marker->attributes);
+	}
+	if (marker->type == XDEBUG_TRACE_SPAN_END) {
+		xdebug_str_add_fmt(&str, ", %F sec", (double) (marker->nanotime - marker->nanotime_begin) / NANOS_IN_SEC);
+	}
+	xdebug_str_addc(&str, '\n');
+
+	xdebug_file_printf(context->trace_file, "%s", str.d);
+	xdebug_file_flush_if_due(context->trace_file);
+
+	xdebug_str_destroy(&str);
+}
+
 xdebug_trace_handler_t xdebug_trace_handler_textual =
 {
 	xdebug_trace_textual_init,
@@ -339,5 +408,8 @@ xdebug_trace_handler_t xdebug_trace_handler_textual =
 	NULL /*xdebug_trace_textual_function_exit */,
 	xdebug_trace_textual_function_return_value,
 	xdebug_trace_textual_generator_return_value,
-	xdebug_trace_textual_assignment
+	xdebug_trace_textual_assignment,
+	xdebug_trace_textual_suppressed_calls,
+	xdebug_trace_textual_marker,
+	NULL /* xdebug_trace_textual_fiber_destroyed */
 };
@@ -15,6 +15,9 @@
  */
 #include "lib/php-header.h"
 #include "ext/standard/php_string.h"
+#if PHP_VERSION_ID >= 80100
+# include "Zend/zend_fibers.h"
+#endif
 
 #include "php_xdebug.h"
 #include "tracing_private.h"
@@ -22,6 +25,7 @@
 #include "trace_flamegraph.h"
 #include "trace_computerized.h"
 #include "trace_html.h"
+#include "trace_chrome.h"
 
 #include "lib/compat.h"
 #include "lib/log.h"
@@ -40,6 +44,7 @@ static xdebug_trace_handler_t *xdebug_select_trace_handler(int options)
 		case 2: tmp = &xdebug_trace_handler_html; break;
 		case 3: tmp = &xdebug_trace_handler_flamegraph_cost; break;
 		case 4: tmp = &xdebug_trace_handler_flamegraph_mem; break;
+		case 5: tmp = &xdebug_trace_handler_chrome; break;
 		default:
 			php_error(E_NOTICE, "A wrong value for xdebug.trace_format was selected (%d), defaulting to the textual format", (int) XINI_TRACE(trace_format));
 			tmp = &xdebug_trace_handler_textual; break;
@@ -58,6 +63,9 @@ static xdebug_trace_handler_t *xdebug_select_trace_handler(int options)
 	if (options & XDEBUG_TRACE_OPTION_HTML) {
 		tmp = &xdebug_trace_handler_html;
 	}
+	if (options & XDEBUG_TRACE_OPTION_CHROME) {
+		tmp = &xdebug_trace_handler_chrome;
+	}
 
 	if (!tmp->init || !tmp->deinit || !tmp->get_filename) {
 		xdebug_log_ex(XLOG_CHAN_TRACE, XLOG_CRIT, "HNDLR", "Broken trace handler for format '%d', missing 'init', 'deinit', or 'get_filename'  handler", options);
@@ -66,6 +74,18 @@ static xdebug_trace_handler_t *xdebug_select_trace_handler(int options)
 	return tmp;
 }
 
+/* Records are collected in memory, and written out at most every
+ * xdebug.trace_flush_interval_ms, so that a process that crashes still leaves
+ * a trace that is complete up to that interval. With the default of 0, the
+ * textual, computerized, and HTML formats write out every record straight
+ * away, and the flamegraph and Chrome formats only when the buffer is full. */
+static void enable_trace_file_buffer(xdebug_file *file)
+{
+	zend_long interval = XINI_TRACE(trace_flush_interval_ms) > 0 ? XINI_TRACE(trace_flush_interval_ms) : 0;
+
+	xdebug_file_enable_buffer(file, (uint64_t) interval * NANOS_IN_MILLISEC);
+}
+
 xdebug_file *xdebug_trace_open_file(char *requested_filename, zend_string *script_filename, long options)
 {
 	xdebug_file *file = xdebug_file_ctor();
@@ -102,7 +122,17 @@ xdebug_file *xdebug_trace_open_file(char *requested_filename, zend_string *scrip
 		(options & XDEBUG_TRACE_OPTION_APPEND) ? "ab" : "wb"
 	)) {
 		xdebug_log_diagnose_permissions(XLOG_CHAN_TRACE, output_dir, generated_filename);
+	} else {
+		enable_trace_file_buffer(file);
+	}
+
+	/* Remember the file, and how to name the next segment if it needs rotating */
+	XG_TRACE(trace_file) = file;
+	if (XG_TRACE(trace_file_basename)) {
+		xdfree(XG_TRACE(trace_file_basename));
 	}
+	XG_TRACE(trace_file_basename) = xdstrdup(filename_to_use);
+	XG_TRACE(trace_file_naked)    = !!(options & XDEBUG_TRACE_OPTION_NAKED_FILENAME);
 
 	if (generated_filename) {
 		xdfree(generated_filename);
@@ -118,6 +148,8 @@ static char* xdebug_start_trace(char* fname, zend_string *script_filename, long
 		return NULL;
 	}
 
+	XG_TRACE(trace_segment_nr) = 0;
+
 	XG_TRACE(trace_handler) = xdebug_select_trace_handler(options);
 	if (!XG_TRACE(trace_handler)) {
 		return NULL;
@@ -135,6 +167,112 @@ static char* xdebug_start_trace(char* fname, zend_string *script_filename, long
 	return xdstrdup(XG_TRACE(trace_handler)->get_filename(XG_TRACE(trace_context)));
 }
 
+/* Only values that format to at least this many characters get an ID */
+#define XDEBUG_TRACE_DEDUP_MIN_LENGTH 64
+/* Later values are written in full, so that the table does not grow without bounds */
+#define XDEBUG_TRACE_DEDUP_MAX_VALUES 65536
+
+static void value_table_free(void)
+{
+	if (!XG_TRACE(value_table)) {
+		return;
+	}
+
+	xdebug_hash_destroy(XG_TRACE(value_table)->identities);
+	xdebug_hash_destroy(XG_TRACE(value_table)->values);
+	xdfree(XG_TRACE(value_table));
+	XG_TRACE(value_table) = NULL;
+}
+
+static xdebug_str *value_reference(unsigned int id)
+{
+	xdebug_str *reference = xdebug_str_new();
+
+	xdebug_str_add_fmt(reference, "#%u", id);
+
+	return reference;
+}
+
+/* Immutable arrays and interned strings do not change while they exist, so
+ * their address identifies their value without formatting it again */
+static void *value_identity(zval *zv)
+{
+	if (Z_TYPE_P(zv) == IS_ARRAY && (GC_FLAGS(Z_ARRVAL_P(zv)) & IS_ARRAY_IMMUTABLE)) {
+		return Z_ARRVAL_P(zv);
+	}
+	if (Z_TYPE_P(zv) == IS_STRING && ZSTR_IS_INTERNED(Z_STR_P(zv))) {
+		return Z_STR_P(zv);
+	}
+
+	return NULL;
+}
+
+/* Formats a value like xdebug_get_zval_value_line() does. With
+ * xdebug.trace_dedup_values, long values are prefixed with an ID the first
+ * time they are written ("#12=array (...)"), and later written as "#12" */
+xdebug_str *xdebug_trace_format_value(zval *zv)
+{
+	xdebug_trace_value_table *table;
+	xdebug_str               *formatted, *definition;
+	zval                     *value = zv;
+	void                     *identity, *found;
+	unsigned int              id;
+
+	if (!XINI_TRACE(trace_dedup_values)) {
+		return xdebug_get_zval_value_line(zv, 0, NULL);
+	}
+
+	ZVAL_DEREF(value);
+	if (Z_TYPE_P(value) != IS_ARRAY && Z_TYPE_P(value) != IS_OBJECT && Z_TYPE_P(value) != IS_STRING) {
+		return xdebug_get_zval_value_line(zv, 0, NULL);
+	}
+
+	if (!XG_TRACE(value_table)) {
+		XG_TRACE(value_table) = xdmalloc(sizeof(xdebug_trace_value_table));
+		XG_TRACE(value_table)->identities = xdebug_hash_alloc(1024, NULL);
+		XG_TRACE(value_table)->values     = xdebug_hash_alloc(4096, NULL);
+		XG_TRACE(value_table)->last_id    = 0;
+	}
+	table = XG_TRACE(value_table);
+
+	identity = value_identity(value);
+	if (identity && xdebug_hash_find(table->identities, (char*) &identity, sizeof(identity), &found)) {
+		return value_reference((unsigned int) (uintptr_t) found);
+	}
+
+	formatted = xdebug_get_zval_value_line(zv, 0, NULL);
+	if (!formatted || formatted->l < XDEBUG_TRACE_DEDUP_MIN_LENGTH) {
+		return formatted;
+	}
+
+	if (xdebug_hash_find(table->values, formatted->d, formatted->l, &found)) {
+		id = (unsigned int) (uintptr_t) found;
+		if (identity) {
+			xdebug_hash_add(table->identities, (char*) &identity, sizeof(identity), found);
+		}
+
+		xdebug_str_free(formatted);
+		return value_reference(id);
+	}
+
+	if (table->last_id >= XDEBUG_TRACE_DEDUP_MAX_VALUES) {
+		return formatted;
+	}
+
+	id = ++table->last_id;
+	xdebug_hash_add(table->values, formatted->d, formatted->l, (void*) (uintptr_t) id);
+	if (identity) {
+		xdebug_hash_add(table->identities, (char*) &identity, sizeof(identity), (void*) (uintptr_t) id);
+	}
+
+	definition = xdebug_str_new();
+	xdebug_str_add_fmt(definition, "#%u=", id);
+	xdebug_str_add_str(definition, formatted);
+	xdebug_str_free(formatted);
+
+	return definition;
+}
+
 static void xdebug_stop_trace(void)
 {
 	if (!XG_TRACE(trace_context)) {
@@ -146,6 +284,111 @@ static void xdebug_stop_trace(void)
 	}
 	XG_TRACE(trace_handler)->deinit(XG_TRACE(trace_context));
 	XG_TRACE(trace_context) = NULL;
+	XG_TRACE(trace_file) = NULL;
+	value_table_free();
+
+	if (XG_TRACE(trace_file_basename)) {
+		xdfree(XG_TRACE(trace_file_basename));
+		XG_TRACE(trace_file_basename) = NULL;
+	}
+	if (XG_TRACE(trace_segments)) {
+		xdebug_llist_destroy(XG_TRACE(trace_segments), NULL);
+		XG_TRACE(trace_segments) = NULL;
+	}
+}
+
+static void segment_name_dtor(void *dummy, void *elem)
+{
+	xdfree(elem);
+}
+
+/* Closes the current trace file, and continues the trace in the next segment,
+ * named after the original file with a sequence number (trace.X.0001.xt).
+ * When xdebug.trace_max_size is also set, only the newest segments that fit
+ * in it are kept. Segments are not synced to disk, so that rotating does not
+ * block the request for any longer than it takes to close the file. */
+static void xdebug_trace_rotate_segment(void)
+{
+	xdebug_file *file = XG_TRACE(trace_file);
+	xdebug_file *next_file;
+	char        *segment_name;
+
+	segment_name = xdebug_sprintf("%s.%04d", XG_TRACE(trace_file_basename), XG_TRACE(trace_segment_nr) + 1);
+	next_file = xdebug_file_ctor();
+
+	if (!xdebug_file_open(next_file, segment_name, XG_TRACE(trace_file_naked) ? NULL : "xt", "wb")) {
+		xdebug_log_ex(XLOG_CHAN_TRACE, XLOG_ERR, "SEGMENT", "Could not open trace segment '%s', continuing with '%s'", segment_name, file->name);
+		xdfree(segment_name);
+		xdebug_file_dtor(next_file);
+
+		/* Don't retry for every single line, but only after another segment's worth */
+		file->bytes_written = 0;
+		return;
+	}
+	xdfree(segment_name);
+	enable_trace_file_buffer(next_file);
+
+	XG_TRACE(trace_segment_nr)++;
+	if (!XG_TRACE(trace_segments)) {
+		XG_TRACE(trace_segments) = xdebug_llist_alloc(segment_name_dtor);
+	}
+	xdebug_llist_insert_next(XG_TRACE(trace_segments), XDEBUG_LLIST_TAIL(XG_TRACE(trace_segments)), xdstrdup(file->name));
+
+	/* Each segment is a complete trace file, with its own footer */
+	if (XG_TRACE(trace_handler)->write_footer) {
+		XG_TRACE(trace_handler)->write_footer(XG_TRACE(trace_context));
+	}
+	xdebug_file_flush(file);
+
+	/* Handlers hold on to the xdebug_file, so swap the new file in place */
+	xdebug_file_close(file);
+	xdebug_file_deinit(file);
+	*file = *next_file;
+	xdfree(next_file);
+
+	/* Back-references can not point into segments that might be removed */
+	value_table_free();
+
+	if (XINI_TRACE(trace_max_size) > 0) {
+		size_t keep = XINI_TRACE(trace_max_size) / XINI_TRACE(trace_segment_size);
+
+		/* The segment that is currently being written counts too */
+		while (xdebug_llist_count(XG_TRACE(trace_segments)) > 0 && xdebug_llist_count(XG_TRACE(trace_segments)) + 1 > keep) {
+			VCWD_UNLINK((char*) XDEBUG_LLIST_VALP(XDEBUG_LLIST_HEAD(XG_TRACE(trace_segments))));
+			xdebug_llist_remove(XG_TRACE(trace_segments), XDEBUG_LLIST_HEAD(XG_TRACE(trace_segments)), NULL);
+		}
+	}
+
+	if (XG_TRACE(trace_handler)->write_header) {
+		XG_TRACE(trace_handler)->write_header(XG_TRACE(trace_context));
+	}
+}
+
+/* Rotates the trace file when it has reached xdebug.trace_segment_size, or
+ * stops the trace when it reached xdebug.trace_max_size without segments.
+ * Returns whether the trace is still running. */
+static bool xdebug_trace_enforce_size_limits(void)
+{
+	xdebug_file *file = XG_TRACE(trace_file);
+
+	if (!file) {
+		return true;
+	}
+
+	if (XINI_TRACE(trace_segment_size) > 0) {
+		if (file->bytes_written >= (size_t) XINI_TRACE(trace_segment_size)) {
+			xdebug_trace_rotate_segment();
+		}
+		return true;
+	}
+
+	if (XINI_TRACE(trace_max_size) > 0 && file->bytes_written >= (size_t) XINI_TRACE(trace_max_size)) {
+		xdebug_log_ex(XLOG_CHAN_TRACE, XLOG_WARN, "MAXSIZE", "Trace file '%s' reached xdebug.trace_max_size (" ZEND_LONG_FMT " bytes), stopping trace", file->name, XINI_TRACE(trace_max_size));
+		xdebug_stop_trace();
+		return false;
+	}
+
+	return true;
 }
 
 char *xdebug_get_trace_filename(void)
@@ -299,60 +542,201 @@ static int is_fetch_op(const zend_op *op)
 	);
 }
 
-static char *xdebug_find_var_name(zend_execute_data *execute_data, const zend_op *cur_opcode, const zend_op *lower_bound)
+/* The name of the variable that an assignment opline writes to only depends
+ * on the oplines leading up to it, except for the values of non-constant
+ * array keys and property names. The name is therefore compiled once per
+ * opline into a template of literal text and 'dynamic' operands, and only
+ * the dynamic operands are looked up when the assignment executes. */
+#define XDEBUG_VAR_NAME_SEGMENT_LITERAL   0
+#define XDEBUG_VAR_NAME_SEGMENT_NAME      1 /* exported without decoration */
+#define XDEBUG_VAR_NAME_SEGMENT_KEY       2 /* exported with decoration */
+#define XDEBUG_VAR_NAME_SEGMENT_RAW       3 /* added as string as-is */
+
+typedef struct _xdebug_var_name_segment {
+	int            type;
+	char          *literal;
+	size_t         literal_len;
+	const zend_op *opline;
+	int            op_type;
+	znode_op       op;
+} xdebug_var_name_segment;
+
+typedef struct _xdebug_var_name_template {
+	int                      count;
+	int                      size;
+	xdebug_var_name_segment *segments;
+	xdebug_str               pending;
+	xdebug_var_export_options *options;
+} xdebug_var_name_template;
+
+typedef struct _xdebug_var_name_table {
+	uint32_t                   count;
+	xdebug_var_name_template **templates;
+} xdebug_var_name_table;
+
+/* True globals */
+int zend_xdebug_var_name_handle = -1;
+
+static void var_name_template_free(xdebug_var_name_template *template)
+{
+	int i;
+
+	for (i = 0; i < template->count; i++) {
+		if (template->segments[i].type == XDEBUG_VAR_NAME_SEGMENT_LITERAL) {
+			xdfree(template->segments[i].literal);
+		}
+	}
+	xdfree(template->segments);
+	xdfree(template);
+}
+
+static void var_name_table_dtor(void *dummy, void *elem)
+{
+	xdebug_var_name_table *table = (xdebug_var_name_table*) elem;
+	uint32_t               i;
+
+	for (i = 0; i < table->count; i++) {
+		if (table->templates[i]) {
+			var_name_template_free(table->templates[i]);
+		}
+	}
+	xdfree(table->templates);
+	xdfree(table);
+}
+
+static xdebug_var_name_segment *template_push_segment(xdebug_var_name_template *template, int type)
+{
+	xdebug_var_name_segment *segment;
+
+	if (template->count == template->size) {
+		template->size = template->size ? template->size * 2 : 4;
+		template->segments = xdrealloc(template->segments, template->size * sizeof(xdebug_var_name_segment));
+	}
+
+	segment = &template->segments[template->count++];
+	memset(segment, 0, sizeof(xdebug_var_name_segment));
+	segment->type = type;
+
+	return segment;
+}
+
+static void template_flush_literal(xdebug_var_name_template *template)
+{
+	xdebug_var_name_segment *segment;
+
+	if (!template->pending.l) {
+		return;
+	}
+
+	segment = template_push_segment(template, XDEBUG_VAR_NAME_SEGMENT_LITERAL);
+	segment->literal     = template->pending.d;
+	segment->literal_len = template->pending.l;
+
+	template->pending.d = NULL;
+	template->pending.l = 0;
+	template->pending.a = 0;
+}
+
+static void add_segment_value(xdebug_str *name, int type, zval *value, xdebug_var_export_options *options)
+{
+	xdebug_str *zval_value;
+
+	if (!value) {
+		return;
+	}
+
+	if (type == XDEBUG_VAR_NAME_SEGMENT_RAW) {
+		if (Z_TYPE_P(value) == IS_STRING) {
+			xdebug_str_add(name, Z_STRVAL_P(value), 0);
+		}
+		return;
+	}
+
+	zval_value = xdebug_get_zval_value_line(value, 0, type == XDEBUG_VAR_NAME_SEGMENT_NAME ? options : NULL);
+	if (zval_value) {
+		xdebug_str_add_str(name, zval_value);
+		xdebug_str_free(zval_value);
+	}
+}
+
+static void template_add_literal(xdebug_var_name_template *template, const char *literal)
+{
+	xdebug_str_add(&template->pending, literal, 0);
+}
+
+static void template_add_cv(xdebug_var_name_template *template, zend_op_array *op_array, uint32_t var)
+{
+	xdebug_str_addc(&template->pending, '$');
+	xdebug_str_add_zstr(&template->pending, zend_get_compiled_variable_name(op_array, var));
+}
+
+/* Constant (and unused) operands are resolved straight away, everything else
+ * is recorded so that it can be fetched from the frame each time */
+static void template_add_operand(xdebug_var_name_template *template, zend_execute_data *execute_data, int type, const zend_op *opline, int op_type, const znode_op *op)
+{
+	xdebug_var_name_segment *segment;
+	int                      is_var;
+
+	if (op_type == IS_CONST || op_type == IS_UNUSED) {
+		zval *value = op_type == IS_CONST ? xdebug_get_zval_with_opline(execute_data, opline, op_type, op, &is_var) : NULL;
+
+		add_segment_value(&template->pending, type, value, template->options);
+		return;
+	}
+
+	template_flush_literal(template);
+
+	segment = template_push_segment(template, type);
+	segment->opline  = opline;
+	segment->op_type = op_type;
+	segment->op      = *op;
+}
+
+static xdebug_var_name_template *xdebug_compile_var_name(zend_execute_data *execute_data, const zend_op *cur_opcode, const zend_op *lower_bound)
 {
 	const zend_op *next_opcode, *prev_opcode = NULL, *opcode_ptr;
-	zval          *dimval;
-	int            is_var;
 	zend_op_array *op_array = &execute_data->func->op_array;
-	xdebug_str     name = XDEBUG_STR_INITIALIZER;
 	int            gohungfound = 0, is_static = 0;
-	xdebug_str    *zval_value = NULL;
-	xdebug_var_export_options *options;
 	const zend_op *static_opcode_ptr = NULL;
+	xdebug_var_name_template *template;
+
+	template = xdcalloc(1, sizeof(xdebug_var_name_template));
 
 	next_opcode = cur_opcode + 1;
 	prev_opcode = cur_opcode - 1;
 
 	if (cur_opcode->opcode == ZEND_QM_ASSIGN) {
-		xdebug_str_addc(&name, '$');
-		xdebug_str_add(&name, zend_get_compiled_variable_name(op_array, cur_opcode->result.var)->val, 0);
+		template_add_cv(template, op_array, cur_opcode->result.var);
+		template_flush_literal(template);
 
-		return name.d;
+		return template;
 	}
 
 	is_static = xdebug_is_static_call(op_array->opcodes, cur_opcode, prev_opcode, &static_opcode_ptr);
-	options = xdebug_var_export_options_from_ini();
-	options->no_decoration = 1;
+	template->options = xdebug_var_export_options_from_ini();
+	template->options->no_decoration = 1;
 
 	if (cur_opcode->op1_type == IS_CV) {
 		if (!lower_bound) {
-			xdebug_str_addc(&name, '$');
-			xdebug_str_add(&name, zend_get_compiled_variable_name(op_array, cur_opcode->op1.var)->val, 0);
+			template_add_cv(template, op_array, cur_opcode->op1.var);
 		}
 	} else if (cur_opcode->op1_type == IS_VAR && cur_opcode->opcode == ZEND_ASSIGN && (prev_opcode->opcode == ZEND_FETCH_W || prev_opcode->opcode == ZEND_FETCH_RW)) {
 		if (is_static) {
-			xdebug_str_add_literal(&name, "self::");
+			template_add_literal(template, "self::");
 		} else {
-			zval_value = xdebug_get_zval_value_line(xdebug_get_zval_with_opline(execute_data, prev_opcode, prev_opcode->op1_type, &prev_opcode->op1, &is_var), 0, options);
-			xdebug_str_addc(&name, '$');
-			xdebug_str_add_str(&name, zval_value);
-			xdebug_str_free(zval_value);
+			template_add_literal(template, "$");
+			template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_NAME, prev_opcode, prev_opcode->op1_type, &prev_opcode->op1);
 		}
 	} else if (is_static) { /* todo : see if you can change this and the previous cases around */
-		xdebug_str_add_literal(&name, "self::");
+		template_add_literal(template, "self::");
 	}
 	if (cur_opcode->opcode >= ZEND_PRE_INC_OBJ && cur_opcode->opcode <= ZEND_POST_DEC_OBJ) {
-		zval_value = xdebug_get_zval_value_line(xdebug_get_zval(execute_data, cur_opcode->op2_type, &cur_opcode->op2, &is_var), 0, options);
-		xdebug_str_add_literal(&name, "$this->");
-		xdebug_str_add_str(&name, zval_value);
-		xdebug_str_free(zval_value);
+		template_add_literal(template, "$this->");
+		template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_NAME, cur_opcode, cur_opcode->op2_type, &cur_opcode->op2);
 	}
 
 	if (cur_opcode->opcode >= ZEND_PRE_INC_STATIC_PROP && cur_opcode->opcode <= ZEND_POST_DEC_STATIC_PROP) {
-		zval_value = xdebug_get_zval_value_line(xdebug_get_zval(execute_data, cur_opcode->op1_type, &cur_opcode->op1, &is_var), 0, options);
-		xdebug_str_add_str(&name, zval_value);
-		xdebug_str_free(zval_value);
+		template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_NAME, cur_opcode, cur_opcode->op1_type, &cur_opcode->op1);
 	}
 
 	/* Scroll back to start of FETCHES */
@@ -382,40 +766,27 @@ static char *xdebug_find_var_name(zend_execute_data *execute_data, const zend_op
 				opcode_ptr->op1_type == IS_UNUSED &&
 				(opcode_ptr->opcode == ZEND_FETCH_OBJ_W || opcode_ptr->opcode == ZEND_FETCH_OBJ_RW)
 			) {
-				xdebug_str_add_literal(&name, "$this");
+				template_add_literal(template, "$this");
 			}
 			if (opcode_ptr->op1_type == IS_CV) {
-				xdebug_str_addc(&name, '$');
-				xdebug_str_add(&name, zend_get_compiled_variable_name(op_array, opcode_ptr->op1.var)->val, 0);
+				template_add_cv(template, op_array, opcode_ptr->op1.var);
 			}
 			if (opcode_ptr->opcode == ZEND_FETCH_STATIC_PROP_W || opcode_ptr->opcode == ZEND_FETCH_STATIC_PROP_R || opcode_ptr->opcode == ZEND_FETCH_STATIC_PROP_RW) {
-				zval_value = xdebug_get_zval_value_line(xdebug_get_zval_with_opline(execute_data, opcode_ptr, opcode_ptr->op1_type, &opcode_ptr->op1, &is_var), 0, options);
-				xdebug_str_add_str(&name, zval_value);
-				xdebug_str_free(zval_value);
+				template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_NAME, opcode_ptr, opcode_ptr->op1_type, &opcode_ptr->op1);
 			}
 			if (opcode_ptr->opcode == ZEND_FETCH_W) {
-				zval_value = xdebug_get_zval_value_line(xdebug_get_zval_with_opline(execute_data, opcode_ptr, opcode_ptr->op1_type, &opcode_ptr->op1, &is_var), 0, options);
-				xdebug_str_add_str(&name, zval_value);
-				xdebug_str_free(zval_value);
+				template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_NAME, opcode_ptr, opcode_ptr->op1_type, &opcode_ptr->op1);
 			}
 			if (is_static && opcode_ptr->opcode == ZEND_FETCH_RW) {
-				zval_value = xdebug_get_zval_value_line(xdebug_get_zval_with_opline(execute_data, opcode_ptr, opcode_ptr->op1_type, &opcode_ptr->op1, &is_var), 0, options);
-				xdebug_str_add_str(&name, zval_value);
-				xdebug_str_free(zval_value);
+				template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_NAME, opcode_ptr, opcode_ptr->op1_type, &opcode_ptr->op1);
 			}
 			if (opcode_ptr->opcode == ZEND_FETCH_DIM_W || opcode_ptr->opcode == ZEND_FETCH_DIM_RW) {
-				zval_value = xdebug_get_zval_value_line(xdebug_get_zval_with_opline(execute_data, opcode_ptr, opcode_ptr->op2_type, &opcode_ptr->op2, &is_var), 0, NULL);
-				xdebug_str_addc(&name, '[');
-				if (zval_value) {
-					xdebug_str_add_str(&name, zval_value);
-				}
-				xdebug_str_addc(&name, ']');
-				xdebug_str_free(zval_value);
+				template_add_literal(template, "[");
+				template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_KEY, opcode_ptr, opcode_ptr->op2_type, &opcode_ptr->op2);
+				template_add_literal(template, "]");
 			} else if (opcode_ptr->opcode == ZEND_FETCH_OBJ_W || opcode_ptr->opcode == ZEND_FETCH_OBJ_RW) {
-				zval_value = xdebug_get_zval_value_line(xdebug_get_zval_with_opline(execute_data, opcode_ptr, opcode_ptr->op2_type, &opcode_ptr->op2, &is_var), 0, options);
-				xdebug_str_add_literal(&name, "->");
-				xdebug_str_add_str(&name, zval_value);
-				xdebug_str_free(zval_value);
+				template_add_literal(template, "->");
+				template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_NAME, opcode_ptr, opcode_ptr->op2_type, &opcode_ptr->op2);
 			}
 			opcode_ptr = opcode_ptr + 1;
 			if (opcode_ptr->op1_type == IS_CV) {
@@ -429,60 +800,141 @@ static char *xdebug_find_var_name(zend_execute_data *execute_data, const zend_op
 		(cur_opcode->opcode == ZEND_ASSIGN_OBJ_REF)
 	) {
 		if (cur_opcode->op1_type == IS_UNUSED) {
-			xdebug_str_add_literal(&name, "$this");
+			template_add_literal(template, "$this");
 		}
-		dimval = xdebug_get_zval(execute_data, cur_opcode->op2_type, &cur_opcode->op2, &is_var);
-		xdebug_str_add_literal(&name, "->");
-		xdebug_str_add(&name, Z_STRVAL_P(dimval), 0);
+		template_add_literal(template, "->");
+		template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_RAW, cur_opcode, cur_opcode->op2_type, &cur_opcode->op2);
 	}
 
 	if (cur_opcode->opcode == ZEND_ASSIGN_STATIC_PROP_REF) {
-		dimval = xdebug_get_zval(execute_data, cur_opcode->op1_type, &cur_opcode->op1, &is_var);
-		xdebug_str_add(&name, Z_STRVAL_P(dimval), 0);
+		template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_RAW, cur_opcode, cur_opcode->op1_type, &cur_opcode->op1);
 	}
 	if (cur_opcode->opcode == ZEND_ASSIGN_DIM_OP) {
-		zval_value = xdebug_get_zval_value_line(xdebug_get_zval(execute_data, cur_opcode->op2_type, &cur_opcode->op2, &is_var), 0, NULL);
-		xdebug_str_addc(&name, '[');
-		xdebug_str_add_str(&name, zval_value);
-		xdebug_str_addc(&name, ']');
-		xdebug_str_free(zval_value);
+		template_add_literal(template, "[");
+		template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_KEY, cur_opcode, cur_opcode->op2_type, &cur_opcode->op2);
+		template_add_literal(template, "]");
 	}
 	if (cur_opcode->opcode == ZEND_ASSIGN_OBJ_OP) {
-		zval_value = xdebug_get_zval_value_line(xdebug_get_zval(execute_data, cur_opcode->op2_type, &cur_opcode->op2, &is_var), 0, options);
 		if (cur_opcode->op1_type == IS_UNUSED) {
-			xdebug_str_add_literal(&name, "$this->");
+			template_add_literal(template, "$this->");
 		} else {
-			xdebug_str_add_literal(&name, "->");
+			template_add_literal(template, "->");
 		}
-		xdebug_str_add_str(&name, zval_value);
-		xdebug_str_free(zval_value);
+		template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_NAME, cur_opcode, cur_opcode->op2_type, &cur_opcode->op2);
 	}
 	if (cur_opcode->opcode == ZEND_ASSIGN_STATIC_PROP_OP) {
-		zval_value = xdebug_get_zval_value_line(xdebug_get_zval(execute_data, cur_opcode->op1_type, &cur_opcode->op1, &is_var), 0, options);
-		xdebug_str_add_literal(&name, "self::");
-		xdebug_str_add_str(&name, zval_value);
-		xdebug_str_free(zval_value);
+		template_add_literal(template, "self::");
+		template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_NAME, cur_opcode, cur_opcode->op1_type, &cur_opcode->op1);
 	}
 
 	if (cur_opcode->opcode == ZEND_ASSIGN_DIM) {
 		if (next_opcode->opcode == ZEND_OP_DATA && cur_opcode->op2_type == IS_UNUSED) {
-			xdebug_str_add_literal(&name, "[]");
+			template_add_literal(template, "[]");
 		} else {
-			zval_value = xdebug_get_zval_value_line(xdebug_get_zval_with_opline(execute_data, opcode_ptr, opcode_ptr->op2_type, &opcode_ptr->op2, &is_var), 0, NULL);
-			xdebug_str_addc(&name, '[');
-			xdebug_str_add_str(&name, zval_value);
-			xdebug_str_addc(&name, ']');
-			xdebug_str_free(zval_value);
+			template_add_literal(template, "[");
+			template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_KEY, opcode_ptr, opcode_ptr->op2_type, &opcode_ptr->op2);
+			template_add_literal(template, "]");
 		}
 	}
 
 	if (cur_opcode->opcode == ZEND_ASSIGN_STATIC_PROP) {
-		dimval = xdebug_get_zval(execute_data, cur_opcode->op1_type, &cur_opcode->op1, &is_var);
-		xdebug_str_add(&name, Z_STRVAL_P(dimval), 0);
+		template_add_operand(template, execute_data, XDEBUG_VAR_NAME_SEGMENT_RAW, cur_opcode, cur_opcode->op1_type, &cur_opcode->op1);
+	}
+
+	template_flush_literal(template);
+
+	xdfree(template->options->runtime);
+	xdfree(template->options);
+	template->options = NULL;
+
+	return template;
+}
+
+static xdebug_var_name_template **find_var_name_template_slot(zend_op_array *op_array, const zend_op *cur_opcode)
+{
+	xdebug_var_name_table *table;
+	uint32_t               opline_nr = cur_opcode - op_array->opcodes;
+
+	if (zend_xdebug_var_name_handle < 0 || !RUN_TIME_CACHE(op_array) || opline_nr >= op_array->last) {
+		return NULL;
 	}
 
-	xdfree(options->runtime);
-	xdfree(options);
+	table = (xdebug_var_name_table*) ZEND_OP_ARRAY_EXTENSION(op_array, zend_xdebug_var_name_handle);
+
+	/* Every closure object gets a fresh run-time cache, so closures find the
+	 * table of their declaration through the opcodes that they share */
+	if (!table && (op_array->fn_flags & ZEND_ACC_CLOSURE) && XG_TRACE(closure_var_name_tables)) {
+		table = zend_hash_index_find_ptr(XG_TRACE(closure_var_name_tables), (zend_ulong) (uintptr_t) op_array->opcodes);
+
+		if (table && table->count != op_array->last) {
+			table = NULL;
+		}
+	}
+
+	if (!table) {
+		table = xdmalloc(sizeof(xdebug_var_name_table));
+		table->count     = op_array->last;
+		table->templates = xdcalloc(op_array->last, sizeof(xdebug_var_name_template*));
+
+		xdebug_llist_insert_next(XG_TRACE(var_name_tables), XDEBUG_LLIST_TAIL(XG_TRACE(var_name_tables)), table);
+
+		if (op_array->fn_flags & ZEND_ACC_CLOSURE) {
+			if (!XG_TRACE(closure_var_name_tables)) {
+				ALLOC_HASHTABLE(XG_TRACE(closure_var_name_tables));
+				zend_hash_init(XG_TRACE(closure_var_name_tables), 16, NULL, NULL, 0);
+			}
+			zend_hash_index_update_ptr(XG_TRACE(closure_var_name_tables), (zend_ulong) (uintptr_t) op_array->opcodes, table);
+		}
+	}
+
+	ZEND_OP_ARRAY_EXTENSION(op_array, zend_xdebug_var_name_handle) = table;
+
+	return &table->templates[opline_nr];
+}
+
+static char *xdebug_find_var_name(zend_execute_data *execute_data, const zend_op *cur_opcode, const zend_op *lower_bound)
+{
+	xdebug_var_name_template **slot;
+	xdebug_var_name_template  *template;
+	xdebug_var_export_options *options = NULL;
+	xdebug_str                 name = XDEBUG_STR_INITIALIZER;
+	int                        i, is_var;
+
+	slot = lower_bound ? NULL : find_var_name_template_slot(&execute_data->func->op_array, cur_opcode);
+
+	if (slot && *slot) {
+		template = *slot;
+	} else {
+		template = xdebug_compile_var_name(execute_data, cur_opcode, lower_bound);
+		if (slot) {
+			*slot = template;
+		}
+	}
+
+	for (i = 0; i < template->count; i++) {
+		xdebug_var_name_segment *segment = &template->segments[i];
+
+		if (segment->type == XDEBUG_VAR_NAME_SEGMENT_LITERAL) {
+			xdebug_str_addl(&name, segment->literal, segment->literal_len, 0);
+			continue;
+		}
+
+		if (segment->type == XDEBUG_VAR_NAME_SEGMENT_NAME && !options) {
+			options = xdebug_var_export_options_from_ini();
+			options->no_decoration = 1;
+		}
+
+		add_segment_value(&name, segment->type, xdebug_get_zval_with_opline(execute_data, segment->opline, segment->op_type, &segment->op, &is_var), options);
+	}
+
+	if (options) {
+		xdfree(options->runtime);
+		xdfree(options);
+	}
+
+	if (!slot) {
+		var_name_template_free(template);
+	}
 
 	return name.d;
 }
@@ -508,7 +960,9 @@ static int xdebug_common_assign_dim_handler(const char *op, XDEBUG_OPCODE_HANDLE
 //		return xdebug_call_original_opcode_handler_if_set(cur_opcode->opcode, XDEBUG_OPCODE_HANDLER_ARGS_PASSTHRU);
 //	}
 
-	if (XG_TRACE(trace_context) && XINI_TRACE(collect_assignments)) {
+	fse = XDEBUG_VECTOR_TAIL(XG_BASE(stack));
+
+	if (XG_TRACE(trace_context) && XINI_TRACE(collect_assignments) && !fse->trace_suppressed && xdebug_trace_enforce_size_limits()) {
 		char *full_varname;
 
 		if (cur_opcode->opcode == ZEND_QM_ASSIGN && cur_opcode->result_type != IS_CV) {
@@ -588,7 +1042,6 @@ static int xdebug_common_assign_dim_handler(const char *op, XDEBUG_OPCODE_HANDLE
 			val = xdebug_get_zval(execute_data, cur_opcode->op2_type, &cur_opcode->op2, &is_var);
 		}
 
-		fse = XDEBUG_VECTOR_TAIL(XG_BASE(stack));
 		if (XG_TRACE(trace_context) && XINI_TRACE(collect_assignments) && XG_TRACE(trace_handler)->assignment) {
 			XG_TRACE(trace_handler)->assignment(XG_TRACE(trace_context), fse, full_varname, val, right_full_varname, op, file, lineno);
 		}
@@ -629,10 +1082,24 @@ void xdebug_init_tracing_globals(xdebug_tracing_globals_t *xg)
 {
 	xg->trace_handler = NULL;
 	xg->trace_context = NULL;
+	xg->var_name_tables = NULL;
+	xg->closure_var_name_tables = NULL;
+	xg->trace_file = NULL;
+	xg->trace_file_basename = NULL;
+	xg->trace_file_naked = 0;
+	xg->trace_segment_nr = 0;
+	xg->trace_segments = NULL;
 }
 
 void xdebug_tracing_minit(INIT_FUNC_ARGS)
 {
+	/* Get a run-time cache slot for the per op_array variable name templates */
+#if PHP_VERSION_ID >= 80200
+	zend_xdebug_var_name_handle = zend_get_op_array_extension_handle(XDEBUG_NAME);
+#else
+	zend_xdebug_var_name_handle = zend_get_op_array_extension_handle();
+#endif
+
 	/* Override opcodes for variable assignments in traces */
 	xdebug_register_with_opcode_multi_handler(ZEND_ASSIGN, xdebug_assign_handler);
 	xdebug_register_with_opcode_multi_handler(ZEND_QM_ASSIGN, xdebug_qm_assign_handler);
@@ -664,6 +1131,7 @@ void xdebug_tracing_minit(INIT_FUNC_ARGS)
 void xdebug_tracing_register_constants(INIT_FUNC_ARGS)
 {
 	REGISTER_LONG_CONSTANT("XDEBUG_TRACE_APPEND", XDEBUG_TRACE_OPTION_APPEND, CONST_CS | CONST_PERSISTENT);
+	REGISTER_LONG_CONSTANT("XDEBUG_TRACE_CHROME", XDEBUG_TRACE_OPTION_CHROME, CONST_CS | CONST_PERSISTENT);
 	REGISTER_LONG_CONSTANT("XDEBUG_TRACE_COMPUTERIZED", XDEBUG_TRACE_OPTION_COMPUTERIZED, CONST_CS | CONST_PERSISTENT);
 	REGISTER_LONG_CONSTANT("XDEBUG_TRACE_FLAMEGRAPH_COST", XDEBUG_TRACE_OPTION_FLAMEGRAPH_COST, CONST_CS | CONST_PERSISTENT);
 	REGISTER_LONG_CONSTANT("XDEBUG_TRACE_FLAMEGRAPH_MEM", XDEBUG_TRACE_OPTION_FLAMEGRAPH_MEM, CONST_CS | CONST_PERSISTENT);
@@ -675,6 +1143,8 @@ void xdebug_tracing_rinit(void)
 {
 	XG_TRACE(trace_handler) = NULL;
 	XG_TRACE(trace_context) = NULL;
+	XG_TRACE(value_table) = NULL;
+	XG_TRACE(var_name_tables) = xdebug_llist_alloc(var_name_table_dtor);
 
 	xdebug_disable_opcache_optimizer();
 }
@@ -686,6 +1156,15 @@ void xdebug_tracing_post_deactivate(void)
 	}
 
 	XG_TRACE(trace_context) = NULL;
+
+	if (XG_TRACE(closure_var_name_tables)) {
+		zend_hash_destroy(XG_TRACE(closure_var_name_tables));
+		FREE_HASHTABLE(XG_TRACE(closure_var_name_tables));
+		XG_TRACE(closure_var_name_tables) = NULL;
+	}
+
+	xdebug_llist_destroy(XG_TRACE(var_name_tables), NULL);
+	XG_TRACE(var_name_tables) = NULL;
 }
 
 void xdebug_tracing_init_if_requested(zend_op_array *op_array)
@@ -697,12 +1176,149 @@ void xdebug_tracing_init_if_requested(zend_op_array *op_array)
 	}
 }
 
+static void call_count_dtor(void *dummy, void *elem)
+{
+	xdebug_trace_call_count *count = (xdebug_trace_call_count*) elem;
+
+	if (count->function_name) {
+		xdfree(count->function_name);
+	}
+	xdfree(count);
+}
+
+void xdebug_trace_call_counts_dtor(xdebug_trace_call_counts *counts)
+{
+	xdebug_hash_destroy(counts->functions);
+	if (counts->trampolines) {
+		xdebug_hash_destroy(counts->trampolines);
+	}
+	xdebug_llist_destroy(counts->counts, NULL);
+	xdfree(counts);
+}
+
+/* Returns whether the call should be left out of the trace, because its
+ * function has already been written xdebug.trace_call_limit times from the
+ * same parent frame. Calls made from a call that is left out are left out as
+ * well, as their time is part of the summary of their caller. */
+static bool xdebug_trace_suppress_call(function_stack_entry *fse)
+{
+	function_stack_entry     *parent_fse = fse - 1;
+	xdebug_trace_call_counts *counts;
+	xdebug_trace_call_count  *count = NULL;
+	xdebug_hash              *functions;
+	const char               *key;
+	size_t                    key_len;
+	const void               *function_id;
+
+	if (XINI_TRACE(trace_call_limit) <= 0 || !fse->op_array || !xdebug_vector_element_is_valid(XG_BASE(stack), parent_fse)) {
+		return false;
+	}
+
+	if (parent_fse->trace_suppressed) {
+		fse->trace_suppressed = true;
+		return true;
+	}
+
+	/* The summary is written when the parent exits, which only happens for
+	 * parents that are traced themselves */
+	if (parent_fse->filtered_tracing) {
+		return false;
+	}
+
+	if (!parent_fse->trace_call_counts) {
+		parent_fse->trace_call_counts = xdmalloc(sizeof(xdebug_trace_call_counts));
+		parent_fse->trace_call_counts->functions = xdebug_hash_alloc(16, NULL);
+		parent_fse->trace_call_counts->trampolines = NULL;
+		parent_fse->trace_call_counts->counts = xdebug_llist_alloc(call_count_dtor);
+	}
+	counts = parent_fse->trace_call_counts;
+
+	if (fse->is_trampoline) {
+		/* All trampolines (__call and friends) share one function, so they
+		 * are told apart by the name of the method that was called */
+		if (!counts->trampolines) {
+			counts->trampolines = xdebug_hash_alloc(16, NULL);
+		}
+		functions = counts->trampolines;
+		key       = xdebug_fse_function_name(fse);
+		key_len   = strlen(key);
+	} else {
+		/* User functions are keyed on their opcodes, which closure objects
+		 * share with their declaration, and internal functions on their
+		 * persistent zend_function */
+		function_id = fse->user_defined == XDEBUG_USER_DEFINED ? (const void*) fse->op_array->opcodes : (const void*) fse->op_array;
+		functions   = counts->functions;
+		key         = (const char*) &function_id;
+		key_len     = sizeof(function_id);
+	}
+
+	if (!xdebug_hash_find(functions, key, key_len, (void*) &count)) {
+		count = xdcalloc(1, sizeof(xdebug_trace_call_count));
+		xdebug_hash_add(functions, key, key_len, count);
+		xdebug_llist_insert_next(counts->counts, XDEBUG_LLIST_TAIL(counts->counts), count);
+	}
+
+	if (count->written < XINI_TRACE(trace_call_limit)) {
+		count->written++;
+		return false;
+	}
+
+	/* The name is only created once, for the summary */
+	if (!count->function_name) {
+		count->function_name = xdstrdup(xdebug_fse_function_name(fse));
+	}
+	count->suppressed++;
+
+	fse->trace_suppressed = true;
+	fse->trace_call_count = count;
+
+	return true;
+}
+
+static void xdebug_trace_suppressed_call_end(function_stack_entry *fse)
+{
+	if (fse->trace_call_count) {
+		fse->trace_call_count->nanotime += fse->nanotime_end - fse->nanotime;
+	}
+}
+
+/* Writes the summaries of the calls from this frame that were left out */
+static void xdebug_trace_write_suppressed_calls(function_stack_entry *fse)
+{
+	xdebug_llist_element *le;
+
+	if (!fse->trace_call_counts) {
+		return;
+	}
+
+	if (XG_TRACE(trace_handler)->suppressed_calls) {
+		for (le = XDEBUG_LLIST_HEAD(fse->trace_call_counts->counts); le != NULL; le = XDEBUG_LLIST_NEXT(le)) {
+			xdebug_trace_call_count *count = XDEBUG_LLIST_VALP(le);
+
+			if (count->suppressed) {
+				XG_TRACE(trace_handler)->suppressed_calls(XG_TRACE(trace_context), fse, count);
+			}
+		}
+	}
+
+	xdebug_trace_call_counts_dtor(fse->trace_call_counts);
+	fse->trace_call_counts = NULL;
+}
+
 void xdebug_tracing_execute_ex(function_stack_entry *fse)
 {
 	if (fse->filtered_tracing || !XG_TRACE(trace_context)) {
 		return;
 	}
 
+	if (!xdebug_trace_enforce_size_limits()) {
+		return;
+	}
+
+	if (xdebug_trace_suppress_call(fse)) {
+		return;
+	}
+
 	if (XG_TRACE(trace_handler)->function_entry) {
 		XG_TRACE(trace_handler)->function_entry(XG_TRACE(trace_context), fse);
 	}
@@ -716,6 +1332,17 @@ void xdebug_tracing_execute_ex_end(function_stack_entry *fse, zend_execute_data
 		return;
 	}
 
+	if (fse->trace_suppressed) {
+		xdebug_trace_suppressed_call_end(fse);
+		return;
+	}
+
+	if (!xdebug_trace_enforce_size_limits()) {
+		return;
+	}
+
+	xdebug_trace_write_suppressed_calls(fse);
+
 	if ((XG_TRACE(trace_handler)->function_exit)) {
 		XG_TRACE(trace_handler)->function_exit(XG_TRACE(trace_context), fse);
 	}
@@ -748,12 +1375,25 @@ int xdebug_tracing_execute_internal(function_stack_entry *fse)
 		return 0;
 	}
 
-	if (fse->function.type != XFUNC_ZEND_PASS && (XG_TRACE(trace_handler)->function_entry)) {
-		XG_TRACE(trace_handler)->function_entry(XG_TRACE(trace_context), fse);
+	if (fse->function.type == XFUNC_ZEND_PASS) {
+		return 0;
+	}
+
+	if (!xdebug_trace_enforce_size_limits()) {
+		return 0;
+	}
+
+	/* The exit is still needed to add the call's time to the summary */
+	if (xdebug_trace_suppress_call(fse)) {
 		return 1;
 	}
 
-	return 0;
+	/* Handlers that only write on exit still need the exit to be called */
+	if (XG_TRACE(trace_handler)->function_entry) {
+		XG_TRACE(trace_handler)->function_entry(XG_TRACE(trace_context), fse);
+	}
+
+	return 1;
 }
 
 void xdebug_tracing_execute_internal_end(function_stack_entry *fse, zval *return_value)
@@ -762,6 +1402,17 @@ void xdebug_tracing_execute_internal_end(function_stack_entry *fse, zval *return
 		return;
 	}
 
+	if (fse->trace_suppressed) {
+		xdebug_trace_suppressed_call_end(fse);
+		return;
+	}
+
+	if (!xdebug_trace_enforce_size_limits()) {
+		return;
+	}
+
+	xdebug_trace_write_suppressed_calls(fse);
+
 	if (fse->function.type != XFUNC_ZEND_PASS && (XG_TRACE(trace_handler)->function_exit)) {
 		XG_TRACE(trace_handler)->function_exit(XG_TRACE(trace_context), fse);
 	}
@@ -772,6 +1423,38 @@ void xdebug_tracing_execute_internal_end(function_stack_entry *fse, zval *return
 	}
 }
 
+#if PHP_VERSION_ID >= 80100
+/* Lets the handler forget about a Fiber, whose address can be reused by a
+ * Fiber that is created later */
+void xdebug_tracing_fiber_destroyed(zend_fiber_context *fiber)
+{
+	if (XG_TRACE(trace_context) && XG_TRACE(trace_handler)->fiber_destroyed) {
+		XG_TRACE(trace_handler)->fiber_destroyed(XG_TRACE(trace_context), fiber);
+	}
+}
+#endif
+
+/* Writes a user-defined marker or span record, at the level of the calls made
+ * by the frame 'fse' */
+bool xdebug_tracing_marker(function_stack_entry *fse, xdebug_trace_marker *marker)
+{
+	if (!XG_TRACE(trace_context) || !XG_TRACE(trace_handler)->marker) {
+		return false;
+	}
+
+	if (fse->filtered_tracing || fse->trace_suppressed) {
+		return false;
+	}
+
+	if (!xdebug_trace_enforce_size_limits()) {
+		return false;
+	}
+
+	XG_TRACE(trace_handler)->marker(XG_TRACE(trace_context), fse, marker);
+
+	return true;
+}
+
 void xdebug_tracing_save_trace_context(void **original_trace_context)
 {
 	*original_trace_context = XG_TRACE(trace_context);
@@ -17,12 +17,53 @@
 #define XDEBUG_TRACING_H
 
 #include "lib/php-header.h"
+#include "lib/file.h"
+#include "lib/hash.h"
+#include "lib/llist.h"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeclaration-after-statement"
 #include "zend_generators.h"
 #pragma GCC diagnostic pop
 
+/* Calls of one function from one parent frame, see xdebug.trace_call_limit */
+typedef struct _xdebug_trace_call_count {
+	zend_long  written;
+	uint64_t   suppressed;
+	uint64_t   nanotime;
+	char      *function_name;
+} xdebug_trace_call_count;
+
+typedef struct _xdebug_trace_call_counts {
+	xdebug_hash  *functions;   /* keyed on the function's opcodes, or zend_function */
+	xdebug_hash  *trampolines; /* keyed on the called name */
+	xdebug_llist *counts;    /* the same entries, in order of first call */
+} xdebug_trace_call_counts;
+
+/* Values that were written in full before, see xdebug.trace_dedup_values */
+typedef struct _xdebug_trace_value_table {
+	xdebug_hash  *identities; /* immutable arrays and interned strings, keyed on their address */
+	xdebug_hash  *values;     /* keyed on their formatted text */
+	unsigned int  last_id;
+} xdebug_trace_value_table;
+
+/* User-defined records, see xdebug_trace_marker() and xdebug_span_begin() */
+#define XDEBUG_TRACE_MARKER     0
+#define XDEBUG_TRACE_SPAN_BEGIN 1
+#define XDEBUG_TRACE_SPAN_END   2
+
+typedef struct _xdebug_trace_marker {
+	int           type;
+	unsigned int  id;             /* span ID, 0 for markers */
+	zend_string  *label;
+	zval         *attributes;     /* NULL, or a non-empty array */
+	uint64_t      nanotime;
+	uint64_t      nanotime_begin; /* span end only */
+} xdebug_trace_marker;
+
+/* Only defined from PHP 8.1 on */
+struct _zend_fiber_context;
+
 typedef struct
 {
 	void *(*init)(char *fname, zend_string *script_filename, long options);
@@ -35,20 +76,43 @@ typedef struct
 	void (*return_value)(void *ctxt, function_stack_entry *fse, zval *return_value);
 	void (*generator_return_value)(void *ctxt, function_stack_entry *fse, zend_generator *generator);
 	void (*assignment)(void *ctxt, function_stack_entry *fse, char *full_varname, zval *value, char *right_full_varname, const char *op, char *file, int lineno);
+	void (*suppressed_calls)(void *ctxt, function_stack_entry *fse, xdebug_trace_call_count *count);
+	void (*marker)(void *ctxt, function_stack_entry *fse, xdebug_trace_marker *marker);
+	void (*fiber_destroyed)(void *ctxt, struct _zend_fiber_context *fiber);
 } xdebug_trace_handler_t;
 
 typedef struct _xdebug_tracing_globals_t {
 	xdebug_trace_handler_t *trace_handler;
 	void                   *trace_context;
+
+	/* Segment rotation, see xdebug.trace_segment_size */
+	xdebug_file            *trace_file;
+	char                   *trace_file_basename;
+	int                     trace_file_naked;
+	int                     trace_segment_nr;
+	xdebug_llist           *trace_segments; /* finished segments, oldest first */
+
+	/* Back-references to repeated values, reset for every file */
+	xdebug_trace_value_table *value_table;
+
+	/* Tables of compiled assignment variable names, one per op_array */
+	xdebug_llist           *var_name_tables;
+	HashTable              *closure_var_name_tables; /* by opcodes, not owning */
 } xdebug_tracing_globals_t;
 
 typedef struct _xdebug_tracing_settings_t {
 	char         *trace_output_name;
 	zend_long     trace_options;
 	zend_long     trace_format;
+	zend_long     trace_max_size;
+	zend_long     trace_segment_size;
+	zend_long     trace_call_limit;
+	zend_long     trace_flush_interval_ms;
+	zend_bool     trace_dedup_values;
 
 	zend_bool     collect_assignments;
 	zend_bool     collect_params;
+	zend_bool     collect_params_synopsis;
 	zend_bool     collect_return;
 } xdebug_tracing_settings_t;
 
@@ -63,6 +127,11 @@ void xdebug_tracing_execute_ex(function_stack_entry *fse);
 void xdebug_tracing_execute_ex_end(function_stack_entry *fse, zend_execute_data *execute_data);
 int xdebug_tracing_execute_internal(function_stack_entry *fse);
 void xdebug_tracing_execute_internal_end(function_stack_entry *fse, zval *return_value);
+#if PHP_VERSION_ID >= 80100
+void xdebug_tracing_fiber_destroyed(struct _zend_fiber_context *fiber);
+#endif
+
+bool xdebug_tracing_marker(function_stack_entry *fse, xdebug_trace_marker *marker);
 
 void xdebug_tracing_save_trace_context(void **old_trace_context);
 void xdebug_tracing_restore_trace_context(void *old_trace_context);
@@ -71,6 +140,8 @@ char* xdebug_return_trace_stack_retval(function_stack_entry* i, int fnr, zval* r
 char* xdebug_return_trace_stack_generator_retval(function_stack_entry* i, zend_generator* generator);
 char* xdebug_return_trace_assignment(function_stack_entry *i, char *varname, zval *retval, char *op, char *file, int fileno);
 
+void xdebug_trace_call_counts_dtor(xdebug_trace_call_counts *counts);
+
 void xdebug_trace_function_begin(function_stack_entry *fse);
 void xdebug_trace_function_end(function_stack_entry *fse);
 
@@ -62,4 +62,6 @@ int xdebug_post_dec_static_prop_handler(zend_execute_data *execute_data);
 
 xdebug_file *xdebug_trace_open_file(char *fname, zend_string *script_filename, long options);
 
+xdebug_str *xdebug_trace_format_value(zval *zv);
+
 #endif
@@ -0,0 +1,53 @@
+--TEST--
+Prefill analysis is cached in xdebug.coverage_cache_dir
+--INI--
+xdebug.mode=coverage
+--FILE--
+<?php
+	$dir = sys_get_temp_dir() . '/xdebug-coverage-cache-' . getmypid();
+	@mkdir( $dir );
+	ini_set( 'xdebug.coverage_cache_dir', $dir );
+
+	$options = XDEBUG_CC_UNUSED | XDEBUG_CC_DEAD_CODE | XDEBUG_CC_BRANCH_CHECK;
+	$file = dirname(__FILE__) . DIRECTORY_SEPARATOR . 'coverage-analysis-cache-001.inc';
+
+	// The first run analyses the file, and writes the cache when stopping
+	xdebug_start_code_coverage( $options );
+	include $file;
+	xdebug_stop_code_coverage( false );
+	$first = xdebug_get_code_coverage();
+
+	$cache_files = glob( "$dir/xdebug-cc-*.bin" );
+	var_dump( count( $cache_files ) > 0 );
+	foreach ( $cache_files as $cache_file ) {
+		touch( $cache_file, 1000000000 );
+	}
+
+	xdebug_start_code_coverage( $options );
+	xdebug_stop_code_coverage( true );
+
+	// The second run reads the cache, which then does not need writing again
+	xdebug_start_code_coverage( $options );
+	include $file;
+	xdebug_stop_code_coverage( false );
+	$cc = xdebug_get_code_coverage();
+
+	clearstatcache();
+	$reused = true;
+	foreach ( $cache_files as $cache_file ) {
+		$reused = $reused && filemtime( $cache_file ) == 1000000000;
+		unlink( $cache_file );
+	}
+	rmdir( $dir );
+	var_dump( $reused );
+
+	var_dump( $first[$file] == $cc[$file] );
+	var_dump( count( $cc[$file]['lines'] ) > 0 );
+	var_dump( isset( $cc[$file]['functions']['{main}']['paths'] ) );
+?>
+--EXPECT--
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
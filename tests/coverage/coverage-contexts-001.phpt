@@ -0,0 +1,36 @@
+--TEST--
+xdebug_set_coverage_context() attributes executed lines to context IDs
+--INI--
+xdebug.mode=coverage
+--FILE--
+<?php
+	xdebug_start_code_coverage();
+	$file = dirname(__FILE__) . DIRECTORY_SEPARATOR . 'coverage-contexts-001.inc';
+	include $file;
+
+	xdebug_set_coverage_context(1);
+	ctx_a();
+	xdebug_set_coverage_context(2);
+	ctx_a();
+	ctx_b();
+	xdebug_set_coverage_context(3);
+	ctx_a();
+	xdebug_set_coverage_context(5);
+	ctx_a();
+	ctx_b();
+	xdebug_set_coverage_context(4);
+	ctx_a();
+	xdebug_set_coverage_context(-1);
+	ctx_b();
+
+	$contexts = xdebug_get_code_coverage_contexts();
+	xdebug_stop_code_coverage();
+	var_dump($contexts[$file]);
+?>
+--EXPECT--
+array(2) {
+  [4]=>
+  string(3) "1-5"
+  [9]=>
+  string(3) "2,5"
+}
@@ -0,0 +1,52 @@
+--TEST--
+xdebug_get_code_coverage_delta() only returns lines that changed since the last call
+--INI--
+xdebug.mode=coverage
+--FILE--
+<?php
+	xdebug_start_code_coverage();
+	$file = dirname(__FILE__) . DIRECTORY_SEPARATOR . 'coverage-delta-001.inc';
+	include $file;
+	$delta = xdebug_get_code_coverage_delta();
+	var_dump($delta[$file]);
+
+	delta_a();
+	$delta = xdebug_get_code_coverage_delta();
+	var_dump($delta[$file]);
+
+	$delta = xdebug_get_code_coverage_delta();
+	var_dump(isset($delta[$file]));
+
+	delta_b();
+	delta_a();
+	$delta = xdebug_get_code_coverage_delta();
+	var_dump($delta[$file]);
+
+	$cc = xdebug_get_code_coverage();
+	xdebug_stop_code_coverage();
+	var_dump($cc[$file]);
+?>
+--EXPECT--
+array(1) {
+  [11]=>
+  int(1)
+}
+array(1) {
+  [4]=>
+  int(1)
+}
+bool(false)
+array(2) {
+  [4]=>
+  int(1)
+  [9]=>
+  int(1)
+}
+array(3) {
+  [4]=>
+  int(1)
+  [9]=>
+  int(1)
+  [11]=>
+  int(1)
+}
@@ -0,0 +1,63 @@
+--TEST--
+xdebug_dump_code_coverage() writes LCOV, Clover, and binary files
+--INI--
+xdebug.mode=coverage
+--FILE--
+<?php
+	xdebug_start_code_coverage( XDEBUG_CC_UNUSED | XDEBUG_CC_DEAD_CODE );
+	$file = dirname(__FILE__) . DIRECTORY_SEPARATOR . 'coverage-dump-001.inc';
+	include $file;
+	xdebug_stop_code_coverage( false );
+
+	$base = sys_get_temp_dir() . '/coverage-dump-001-' . getmypid();
+
+	var_dump( xdebug_dump_code_coverage( "{$base}.info", XDEBUG_CC_DUMP_LCOV ) );
+	$lcov = file_get_contents( "{$base}.info" );
+	if ( preg_match( '@SF:' . preg_quote( $file, '@' ) . '\n(.*?)end_of_record@s', $lcov, $m ) ) {
+		preg_match_all( '@^DA:(\d+),(\d+)$@m', $m[1], $lines, PREG_SET_ORDER );
+		foreach ( $lines as $line ) {
+			echo $line[1], ': ', $line[2] > 0 ? 'hit' : 'missed', "\n";
+		}
+		preg_match( '@^LF:(\d+)\nLH:(\d+)$@m', $m[1], $totals );
+		var_dump( (int) $totals[1], (int) $totals[2] );
+	}
+
+	var_dump( xdebug_dump_code_coverage( "{$base}.xml", XDEBUG_CC_DUMP_CLOVER ) );
+	$clover = simplexml_load_file( "{$base}.xml" );
+	foreach ( $clover->project->file as $clover_file ) {
+		if ( (string) $clover_file['name'] === $file ) {
+			var_dump( (int) $clover_file->metrics['statements'], (int) $clover_file->metrics['coveredstatements'] );
+		}
+	}
+
+	var_dump( xdebug_dump_code_coverage( "{$base}.bin" ) );
+	$binary = file_get_contents( "{$base}.bin" );
+	var_dump( substr( $binary, 0, 8 ), unpack( 'Vversion/Vflags', $binary, 8 ) );
+
+	var_dump( @xdebug_dump_code_coverage( "{$base}.bad", 42 ) );
+
+	@unlink( "{$base}.info" );
+	@unlink( "{$base}.xml" );
+	@unlink( "{$base}.bin" );
+?>
+--EXPECT--
+bool(true)
+4: hit
+5: hit
+8: missed
+11: hit
+12: hit
+int(5)
+int(4)
+bool(true)
+int(5)
+int(4)
+bool(true)
+string(8) "XDCOVBIN"
+array(2) {
+  ["version"]=>
+  int(1)
+  ["flags"]=>
+  int(0)
+}
+bool(false)
@@ -0,0 +1,29 @@
+--TEST--
+Branch coverage is not available with xdebug.coverage_line_only
+--INI--
+xdebug.mode=coverage
+xdebug.coverage_line_only=1
+--FILE--
+<?php
+	xdebug_start_code_coverage( XDEBUG_CC_UNUSED | XDEBUG_CC_DEAD_CODE | XDEBUG_CC_BRANCH_CHECK );
+	$file = dirname(__FILE__) . DIRECTORY_SEPARATOR . 'coverage-line-only-001.inc';
+	include $file;
+	line_only_a();
+	$cc = xdebug_get_code_coverage();
+	xdebug_stop_code_coverage();
+	var_dump($cc[$file]);
+?>
+--EXPECTF--
+Warning: xdebug_start_code_coverage(): Branch and path coverage needs 'xdebug.coverage_line_only' to be turned off, only collecting line coverage in %s on line %d
+array(5) {
+  [4]=>
+  int(1)
+  [5]=>
+  int(-2)
+  [9]=>
+  int(-1)
+  [10]=>
+  int(-2)
+  [11]=>
+  int(1)
+}
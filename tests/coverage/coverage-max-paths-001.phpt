@@ -0,0 +1,23 @@
+--TEST--
+Path coverage is truncated at xdebug.coverage_max_paths
+--INI--
+xdebug.mode=coverage
+xdebug.coverage_max_paths=5
+--FILE--
+<?php
+	xdebug_start_code_coverage( XDEBUG_CC_UNUSED | XDEBUG_CC_DEAD_CODE | XDEBUG_CC_BRANCH_CHECK );
+	$file = dirname(__FILE__) . DIRECTORY_SEPARATOR . 'coverage-max-paths-001.inc';
+	include $file;
+	$cc = xdebug_get_code_coverage();
+	xdebug_stop_code_coverage();
+
+	$many_ifs = $cc[$file]['functions']['many_ifs'];
+	$one_if = $cc[$file]['functions']['one_if'];
+	var_dump(count($many_ifs['paths']), $many_ifs['paths_truncated']);
+	var_dump(count($one_if['paths']), isset($one_if['paths_truncated']));
+?>
+--EXPECT--
+int(5)
+bool(true)
+int(2)
+bool(false)
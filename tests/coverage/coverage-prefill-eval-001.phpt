@@ -0,0 +1,17 @@
+--TEST--
+Functions defined in eval'd code are prefilled when they are compiled
+--INI--
+xdebug.mode=coverage
+--FILE--
+<?php
+	xdebug_start_code_coverage( XDEBUG_CC_UNUSED | XDEBUG_CC_DEAD_CODE );
+	eval( "function prefill_eval()\n{\n\treturn 'e';\n}\n" );
+	$cc = xdebug_get_code_coverage();
+	xdebug_stop_code_coverage();
+
+	$lines = $cc[__FILE__ . "(3) : eval()'d code"];
+	var_dump($lines[3], $lines[4]);
+?>
+--EXPECT--
+int(-1)
+int(-2)
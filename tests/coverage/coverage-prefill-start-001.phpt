@@ -0,0 +1,41 @@
+--TEST--
+Functions compiled before code coverage starts are prefilled when it starts
+--INI--
+xdebug.mode=coverage
+--FILE--
+<?php
+	$file = dirname(__FILE__) . DIRECTORY_SEPARATOR . 'coverage-prefill-start-001.inc';
+	include $file;
+
+	xdebug_start_code_coverage( XDEBUG_CC_UNUSED | XDEBUG_CC_DEAD_CODE );
+	$cc = xdebug_get_code_coverage();
+	xdebug_stop_code_coverage();
+	var_dump($cc[$file]);
+
+	/* Stopping threw away what was prefilled, so it is prefilled again */
+	xdebug_start_code_coverage( XDEBUG_CC_UNUSED | XDEBUG_CC_DEAD_CODE );
+	$cc = xdebug_get_code_coverage();
+	xdebug_stop_code_coverage();
+	var_dump($cc[$file]);
+?>
+--EXPECT--
+array(4) {
+  [4]=>
+  int(-1)
+  [5]=>
+  int(-2)
+  [9]=>
+  int(-1)
+  [10]=>
+  int(-2)
+}
+array(4) {
+  [4]=>
+  int(-1)
+  [5]=>
+  int(-2)
+  [9]=>
+  int(-1)
+  [10]=>
+  int(-2)
+}
@@ -0,0 +1,26 @@
+--TEST--
+xdebug.coverage_shared_file creates the shared coverage file
+--SKIPIF--
+<?php
+require __DIR__ . '/../utils.inc';
+check_reqs('NTS; !win');
+?>
+--INI--
+xdebug.mode=coverage
+xdebug.coverage_shared_file={TMP}/{RUNID}{TEST_PHP_WORKER}coverage-shared-001.bin
+--FILE--
+<?php
+$file = sys_get_temp_dir() . '/' . getenv('UNIQ_RUN_ID') . getenv('TEST_PHP_WORKER') . 'coverage-shared-001.bin';
+
+var_dump(xdebug_code_coverage_started());
+
+$header = unpack('a8magic/Vversion/Vmax_files/Vmax_words/Vfile_count/Vwords_used/Ventry_size', file_get_contents($file, false, null, 0, 32));
+echo $header['magic'], ' ', $header['version'], ' ', $header['entry_size'], "\n";
+?>
+--CLEAN--
+<?php
+@unlink(sys_get_temp_dir() . '/' . getenv('UNIQ_RUN_ID') . getenv('TEST_PHP_WORKER') . 'coverage-shared-001.bin');
+?>
+--EXPECT--
+bool(true)
+XDCOVSHM 2 512
@@ -0,0 +1,45 @@
+--TEST--
+xdebug.coverage_shared_file merges the lines of requests in different processes
+--SKIPIF--
+<?php
+require __DIR__ . '/../utils.inc';
+check_reqs('NTS; !win; 64bit');
+?>
+--INI--
+xdebug.mode=coverage
+xdebug.coverage_shared_file={TMP}/{RUNID}{TEST_PHP_WORKER}coverage-shared-002.bin
+--FILE--
+<?php
+require __DIR__ . '/coverage-shared.inc';
+
+$file = sys_get_temp_dir() . '/' . getenv('UNIQ_RUN_ID') . getenv('TEST_PHP_WORKER') . 'coverage-shared-002.bin';
+
+include __DIR__ . '/coverage-shared-002.inc';
+
+shared_a();
+
+// Merges this request's lines into the shared file
+xdebug_stop_code_coverage();
+
+$cmd = getenv('TEST_PHP_EXECUTABLE') . ' ' . (getenv('TEST_PHP_ARGS') ?: '') .
+	' -dxdebug.mode=coverage' .
+	' -dxdebug.coverage_shared_file=' . escapeshellarg($file) .
+	' ' . escapeshellarg(__DIR__ . '/coverage-shared-002-child.inc');
+$process = proc_open("exec {$cmd}", [ 1 => [ 'pipe', 'w' ], 2 => [ 'pipe', 'w' ] ], $pipes);
+echo stream_get_contents($pipes[1]), stream_get_contents($pipes[2]);
+fclose($pipes[1]);
+fclose($pipes[2]);
+proc_close($process);
+
+[ $requests, $lines ] = shared_coverage_lines($file, realpath(__DIR__ . '/coverage-shared-002.inc'));
+var_dump($requests);
+var_dump(in_array(4, $lines), in_array(9, $lines));
+?>
+--CLEAN--
+<?php
+@unlink(sys_get_temp_dir() . '/' . getenv('UNIQ_RUN_ID') . getenv('TEST_PHP_WORKER') . 'coverage-shared-002.bin');
+?>
+--EXPECT--
+int(2)
+bool(true)
+bool(true)
@@ -0,0 +1,53 @@
+--TEST--
+xdebug.coverage_shared_file starts a new bitmap for a file that changed
+--SKIPIF--
+<?php
+require __DIR__ . '/../utils.inc';
+check_reqs('NTS; !win; 64bit');
+?>
+--INI--
+xdebug.mode=coverage
+xdebug.coverage_shared_file={TMP}/{RUNID}{TEST_PHP_WORKER}coverage-shared-003.bin
+--FILE--
+<?php
+require __DIR__ . '/coverage-shared.inc';
+
+$file = sys_get_temp_dir() . '/' . getenv('UNIQ_RUN_ID') . getenv('TEST_PHP_WORKER') . 'coverage-shared-003.bin';
+$source = sys_get_temp_dir() . '/' . getenv('UNIQ_RUN_ID') . getenv('TEST_PHP_WORKER') . 'coverage-shared-003.php';
+
+file_put_contents($source, "<?php\nfunction changed()\n{\n\treturn 'old';\n}\n");
+$source = realpath($source);
+
+include $source;
+
+changed();
+
+// Merges this request's lines into the shared file
+xdebug_stop_code_coverage();
+
+// The new version is longer than the bitmap that the old one got
+file_put_contents($source, "<?php\n" . str_repeat("\n", 68) . "function changed()\n{\n\treturn 'new';\n}\n\nchanged();\n");
+
+$cmd = getenv('TEST_PHP_EXECUTABLE') . ' ' . (getenv('TEST_PHP_ARGS') ?: '') .
+	' -dxdebug.mode=coverage' .
+	' -dxdebug.coverage_shared_file=' . escapeshellarg($file) .
+	' ' . escapeshellarg($source);
+$process = proc_open("exec {$cmd}", [ 1 => [ 'pipe', 'w' ], 2 => [ 'pipe', 'w' ] ], $pipes);
+echo stream_get_contents($pipes[1]), stream_get_contents($pipes[2]);
+fclose($pipes[1]);
+fclose($pipes[2]);
+proc_close($process);
+
+[ $requests, $lines ] = shared_coverage_lines($file, $source);
+var_dump($requests);
+var_dump(in_array(4, $lines), in_array(72, $lines));
+?>
+--CLEAN--
+<?php
+@unlink(sys_get_temp_dir() . '/' . getenv('UNIQ_RUN_ID') . getenv('TEST_PHP_WORKER') . 'coverage-shared-003.bin');
+@unlink(sys_get_temp_dir() . '/' . getenv('UNIQ_RUN_ID') . getenv('TEST_PHP_WORKER') . 'coverage-shared-003.php');
+?>
+--EXPECT--
+int(2)
+bool(false)
+bool(true)
@@ -0,0 +1,47 @@
+--TEST--
+xdebug_get_code_coverage_summary() counts lines, branches, and paths
+--INI--
+xdebug.mode=coverage
+--FILE--
+<?php
+	xdebug_start_code_coverage( XDEBUG_CC_UNUSED | XDEBUG_CC_DEAD_CODE | XDEBUG_CC_BRANCH_CHECK );
+	$file = dirname(__FILE__) . DIRECTORY_SEPARATOR . 'coverage-summary-001.inc';
+	include $file;
+	summary_a();
+	$summary = xdebug_get_code_coverage_summary();
+	xdebug_stop_code_coverage();
+	var_dump($summary['files'][$file]);
+
+	$executed = 0;
+	foreach ($summary['files'] as $info) {
+		$executed += $info['lines']['executed'];
+	}
+	var_dump($executed === $summary['total']['lines']['executed']);
+?>
+--EXPECT--
+array(3) {
+  ["lines"]=>
+  array(3) {
+    ["executable"]=>
+    int(3)
+    ["executed"]=>
+    int(2)
+    ["dead"]=>
+    int(2)
+  }
+  ["branches"]=>
+  array(2) {
+    ["total"]=>
+    int(3)
+    ["hit"]=>
+    int(2)
+  }
+  ["paths"]=>
+  array(2) {
+    ["total"]=>
+    int(3)
+    ["hit"]=>
+    int(2)
+  }
+}
+bool(true)
@@ -0,0 +1,35 @@
+--TEST--
+Include costs with xdebug_get_include_stats()
+--INI--
+xdebug.mode=profile
+xdebug.start_with_request=yes
+--FILE--
+<?php
+spl_autoload_register( function ( $class ) {
+	require_once __DIR__ . '/include-stats-001.inc';
+} );
+
+new IncludeStatsA;
+
+require_once __DIR__ . '/include-stats-001.inc';
+require_once __DIR__ . '/include-stats-001.inc';
+
+$stats = xdebug_get_include_stats();
+$entry = $stats[__DIR__ . DIRECTORY_SEPARATOR . 'include-stats-001.inc'];
+
+var_dump( $entry['include_count'], $entry['compile_count'], $entry['once_hits'] );
+var_dump( $entry['include_time'] > 0, $entry['compile_time'] > 0 );
+var_dump( $entry['autoload'] );
+?>
+--EXPECTF--
+int(1)
+int(1)
+int(2)
+bool(true)
+bool(true)
+array(2) {
+  ["class"]=>
+  string(13) "includestatsa"
+  ["chain"]=>
+  string(%d) "{closure%s}"
+}
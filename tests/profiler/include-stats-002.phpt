@@ -0,0 +1,23 @@
+--TEST--
+Include costs with xdebug_get_include_stats(): once hits through relative paths
+--INI--
+xdebug.mode=profile
+xdebug.start_with_request=yes
+--FILE--
+<?php
+include_once 'include-stats-002.inc';
+include_once 'include-stats-002.inc';
+require_once 'include-stats-002.inc';
+@include_once 'include-stats-002-missing.inc';
+
+$stats = xdebug_get_include_stats();
+$entry = $stats[__DIR__ . DIRECTORY_SEPARATOR . 'include-stats-002.inc'];
+
+var_dump( $entry['include_count'], $entry['compile_count'], $entry['once_hits'] );
+var_dump( isset( $stats[__DIR__ . DIRECTORY_SEPARATOR . 'include-stats-002-missing.inc'] ) );
+?>
+--EXPECT--
+int(1)
+int(1)
+int(2)
+bool(false)
@@ -0,0 +1,34 @@
+--TEST--
+Time breakdown per category with xdebug_get_time_breakdown()
+--INI--
+xdebug.mode=profile
+xdebug.start_with_request=no
+xdebug.profiler_categories=regex=preg_*;mine=timebreakdown*
+--FILE--
+<?php
+function timeBreakdownMatch( $subject )
+{
+	return preg_match( '@^a+$@', $subject );
+}
+
+timeBreakdownMatch( 'aaa' );
+timeBreakdownMatch( 'aab' );
+preg_match( '@b@', 'abc' );
+
+$breakdown = xdebug_get_time_breakdown();
+
+var_dump( array_keys( $breakdown ) );
+var_dump( $breakdown['regex']['calls'], $breakdown['mine']['calls'] );
+var_dump( $breakdown['regex']['time'] > 0, $breakdown['mine']['time'] > 0 );
+?>
+--EXPECT--
+array(2) {
+  [0]=>
+  string(5) "regex"
+  [1]=>
+  string(4) "mine"
+}
+int(3)
+int(2)
+bool(true)
+bool(true)
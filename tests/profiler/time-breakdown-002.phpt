@@ -0,0 +1,45 @@
+--TEST--
+Time breakdown per category for trait methods in classes of different namespaces
+--INI--
+xdebug.mode=profile
+xdebug.start_with_request=no
+xdebug.profiler_categories=first=timebreakdown\first\*;second=timebreakdown\second\*
+--FILE--
+<?php
+namespace TimeBreakdown;
+
+trait Shared
+{
+	function run()
+	{
+		return strlen( 'run' );
+	}
+}
+
+namespace TimeBreakdown\First;
+
+class Worker
+{
+	use \TimeBreakdown\Shared;
+}
+
+namespace TimeBreakdown\Second;
+
+class Worker
+{
+	use \TimeBreakdown\Shared;
+}
+
+namespace Main;
+
+( new \TimeBreakdown\First\Worker )->run();
+( new \TimeBreakdown\Second\Worker )->run();
+( new \TimeBreakdown\Second\Worker )->run();
+
+$breakdown = xdebug_get_time_breakdown();
+
+var_dump( $breakdown['first']['calls'], $breakdown['second']['calls'] );
+?>
+--EXPECT--
+int(1)
+int(2)
@@ -0,0 +1,50 @@
+--TEST--
+Test for tracing assignments with dynamic keys and property names in a loop
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.trace_format=0
+xdebug.collect_return=0
+xdebug.collect_assignments=1
+--FILE--
+<?php
+require_once 'capture-trace.inc';
+
+function fill()
+{
+	$keys = ['one', 'two'];
+	$a = [];
+	$o = new stdClass;
+	for ($i = 0; $i < 2; $i++) {
+		$key = $keys[$i];
+		$a[$key] = $i;
+		$a['fixed'][$key] = $i;
+		$o->$key = $i;
+	}
+}
+
+fill();
+
+xdebug_stop_trace();
+?>
+--EXPECTF--
+TRACE START [%d-%d-%d %d:%d:%d.%d]
+                             => $tf = '%sxt%S' %s:%d
+%w%f %w%d     -> fill() %sassignment-trace-012.php:17
+                             => $keys = [0 => 'one', 1 => 'two'] %sassignment-trace-012.php:6
+                             => $a = [] %sassignment-trace-012.php:7
+                             => $o = class stdClass {  } %sassignment-trace-012.php:8
+                             => $i = 0 %sassignment-trace-012.php:9
+                             => $key = 'one' %sassignment-trace-012.php:10
+                             => $a['one'] = 0 %sassignment-trace-012.php:11
+                             => $a['fixed']['one'] = 0 %sassignment-trace-012.php:12
+                             => $o->one = 0 %sassignment-trace-012.php:13
+                             => $i++ %sassignment-trace-012.php:9
+                             => $key = 'two' %sassignment-trace-012.php:10
+                             => $a['two'] = 1 %sassignment-trace-012.php:11
+                             => $a['fixed']['two'] = 1 %sassignment-trace-012.php:12
+                             => $o->two = 1 %sassignment-trace-012.php:13
+                             => $i++ %sassignment-trace-012.php:9
+%w%f %w%d     -> xdebug_stop_trace() %sassignment-trace-012.php:19
+%w%f %w%d
+TRACE END   [%d-%d-%d %d:%d:%d.%d]
@@ -0,0 +1,28 @@
+--TEST--
+Tracing: Chrome Trace Event format
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.trace_format=5
+xdebug.collect_params=1
+--FILE--
+<?php
+require_once 'capture-trace.inc';
+
+function foo($a)
+{
+	return str_repeat($a, 2);
+}
+
+foo('ab"c');
+
+xdebug_stop_trace();
+?>
+--EXPECTF--
+[
+{"name":"process_name","ph":"M","pid":%d,"tid":0,"args":{"name":"%schrome-001.php"}},
+{"name":"thread_name","ph":"M","pid":%d,"tid":1,"args":{"name":"{main}"}},
+{"name":"thread_sort_index","ph":"M","pid":%d,"tid":1,"args":{"sort_index":1}},
+{"name":"str_repeat","cat":"internal","ph":"X","ts":%f,"pid":%d,"tid":1,"dur":%f,"args":{"function_nr":%d,"file":"%schrome-001.php","line":6,"memory":%d,"memory_delta":%i,"params":["'ab\"c'","2"]}},
+{"name":"foo","cat":"user","ph":"X","ts":%f,"pid":%d,"tid":1,"dur":%f,"args":{"function_nr":%d,"file":"%schrome-001.php","line":9,"memory":%d,"memory_delta":%i,"params":["'ab\"c'"]}}
+]
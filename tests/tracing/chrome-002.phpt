@@ -0,0 +1,48 @@
+--TEST--
+Tracing: Chrome Trace Event format gives each Fiber its own track
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.trace_format=5
+xdebug.use_compression=0
+--SKIPIF--
+<?php
+require __DIR__ . '/../utils.inc';
+check_reqs('PHP >= 8.1');
+?>
+--FILE--
+<?php
+function work($n)
+{
+	return $n;
+}
+
+$tf = xdebug_start_trace(sys_get_temp_dir() . '/' . uniqid('xdt', TRUE));
+
+// The second Fiber can get the address of the first one, which is gone by then
+$fiber = new Fiber(function () { work(1); });
+$fiber->start();
+unset($fiber);
+
+$fiber = new Fiber(function () { work(2); });
+$fiber->start();
+unset($fiber);
+
+xdebug_stop_trace();
+
+foreach (json_decode(file_get_contents($tf), true) as $event) {
+	if ($event['name'] === 'thread_name') {
+		echo "track {$event['tid']}: ", preg_replace('/^\{fiber:.*\}$/', '{fiber}', $event['args']['name']), "\n";
+	}
+	if ($event['name'] === 'work') {
+		echo "work() on track {$event['tid']}\n";
+	}
+}
+unlink($tf);
+?>
+--EXPECT--
+track 1: {main}
+track 2: {fiber}
+work() on track 2
+track 3: {fiber}
+work() on track 3
@@ -0,0 +1,29 @@
+--TEST--
+Tracing: xdebug.collect_params_synopsis only shows types and sizes of arguments
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.collect_return=0
+xdebug.collect_assignments=0
+xdebug.trace_format=0
+xdebug.collect_params_synopsis=1
+--FILE--
+<?php
+require_once 'capture-trace.inc';
+
+class Entity { public $children = [ [ 1, 2 ], [ 3 ] ]; }
+
+function store($entity, $values, $name, $description, $id, $ratio, $flag, $nothing)
+{
+}
+
+store(new Entity, [ 'a' => [ 1, 2, 3 ], 'b' => 2 ], 'short', "A description\nthat is rather long", 42, 0.5, true, null);
+
+xdebug_stop_trace();
+?>
+--EXPECTF--
+TRACE START [%d-%d-%d %d:%d:%d.%d]
+%w%f %w%d     -> store($entity = class Entity, $values = array(2), $name = string(5) 'short', $description = string(33) 'A description\nth'..., $id = long, $ratio = double, $flag = true, $nothing = null) %scollect-params-synopsis-001.php:10
+%w%f %w%d     -> xdebug_stop_trace() %s:%d
+%w%f %w%d
+TRACE END   [%d-%d-%d %d:%d:%d.%d]
@@ -0,0 +1,42 @@
+--TEST--
+Tracing: Calls over xdebug.trace_call_limit are summarised when their parent exits
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.collect_return=0
+xdebug.collect_assignments=0
+xdebug.trace_format=0
+xdebug.trace_call_limit=2
+--FILE--
+<?php
+require_once 'capture-trace.inc';
+
+function get($i) { return $i; }
+
+function loop()
+{
+	for ($i = 0; $i < 10; $i++) {
+		get($i);
+	}
+}
+
+loop();
+
+$ar = array('a', 'bb', 'ccc', 'dddd', 'eeeee');
+$r = array_map('strlen', $ar);
+
+xdebug_stop_trace();
+?>
+--EXPECTF--
+TRACE START [%d-%d-%d %d:%d:%d.%d]
+%w%f %w%d     -> loop() %strace-call-limit-001.php:13
+%w%f %w%d       -> get($i = 0) %strace-call-limit-001.php:9
+%w%f %w%d       -> get($i = 1) %strace-call-limit-001.php:9
+%w%f %w%d       -> get() x 8 more calls, %f sec
+%w%f %w%d     -> array_map($callback = 'strlen', $array = [0 => 'a', 1 => 'bb', 2 => 'ccc', 3 => 'dddd', 4 => 'eeeee']) %strace-call-limit-001.php:16
+%w%f %w%d       -> strlen($string = 'a') %strace-call-limit-001.php:16
+%w%f %w%d       -> strlen($string = 'bb') %strace-call-limit-001.php:16
+%w%f %w%d       -> strlen() x 3 more calls, %f sec
+%w%f %w%d     -> xdebug_stop_trace() %s:%d
+%w%f %w%d
+TRACE END   [%d-%d-%d %d:%d:%d.%d]
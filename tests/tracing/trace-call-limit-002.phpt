@@ -0,0 +1,35 @@
+--TEST--
+Tracing: Calls of new closure objects over xdebug.trace_call_limit are counted together
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.collect_return=0
+xdebug.collect_assignments=0
+xdebug.collect_params=0
+xdebug.trace_format=0
+xdebug.trace_call_limit=2
+--FILE--
+<?php
+require_once 'capture-trace.inc';
+
+function loop()
+{
+	for ($i = 0; $i < 5; $i++) {
+		$f = function ($i) { return $i; };
+		$f($i);
+	}
+}
+
+loop();
+
+xdebug_stop_trace();
+?>
+--EXPECTF--
+TRACE START [%d-%d-%d %d:%d:%d.%d]
+%w%f %w%d     -> loop() %strace-call-limit-002.php:12
+%w%f %w%d       -> {closure%s}() %strace-call-limit-002.php:8
+%w%f %w%d       -> {closure%s}() %strace-call-limit-002.php:8
+%w%f %w%d       -> {closure%s}() x 3 more calls, %f sec
+%w%f %w%d     -> xdebug_stop_trace() %s:%d
+%w%f %w%d
+TRACE END   [%d-%d-%d %d:%d:%d.%d]
@@ -0,0 +1,33 @@
+--TEST--
+Tracing: Calls over xdebug.trace_call_limit are summarised in HTML and Chrome traces
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.collect_return=0
+xdebug.collect_assignments=0
+xdebug.collect_params=0
+xdebug.trace_call_limit=1
+--FILE--
+<?php
+function get($i) { return $i; }
+
+function loop()
+{
+	for ($i = 0; $i < 4; $i++) {
+		get($i);
+	}
+}
+
+foreach ([XDEBUG_TRACE_HTML, XDEBUG_TRACE_CHROME] as $format) {
+	$tf = xdebug_start_trace(sys_get_temp_dir() . '/' . uniqid('xdt', TRUE), $format);
+	loop();
+	xdebug_stop_trace();
+
+	preg_match('@^.*more calls.*$|^\{"name":"get","cat":"suppressed".*$@m', file_get_contents($tf), $m);
+	echo $m[0], "\n";
+	unlink($tf);
+}
+?>
+--EXPECTF--
+	<tr><td></td><td>%f</td><td align='right'>%d</td><td align='left'>&nbsp; &nbsp;&nbsp; &nbsp;-&gt;</td><td colspan='2'><i>get() x 3 more calls, %f sec</i></td></tr>
+{"name":"get","cat":"suppressed","ph":"i","s":"t","ts":%f,"pid":%d,"tid":1,"args":{"function_nr":%d,"calls":3,"dur":%f}}
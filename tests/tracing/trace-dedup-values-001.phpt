@@ -0,0 +1,34 @@
+--TEST--
+Tracing: Repeated long values are written as back-references with xdebug.trace_dedup_values
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.collect_return=1
+xdebug.collect_assignments=0
+xdebug.trace_format=0
+xdebug.trace_dedup_values=1
+--FILE--
+<?php
+require_once 'capture-trace.inc';
+
+function render($template, $data) { return $template; }
+
+$data = [ 'title' => 'A page with a title', 'body' => 'And a body that is long enough' ];
+
+render('short', $data);
+render('short', $data);
+render('other', $data);
+
+xdebug_stop_trace();
+?>
+--EXPECTF--
+TRACE START [%d-%d-%d %d:%d:%d.%d]
+%w%f %w%d     -> render($template = 'short', $data = #1=['title' => 'A page with a title', 'body' => 'And a body that is long enough']) %strace-dedup-values-001.php:8
+%w%f %w%d      >=> 'short'
+%w%f %w%d     -> render($template = 'short', $data = #1) %strace-dedup-values-001.php:9
+%w%f %w%d      >=> 'short'
+%w%f %w%d     -> render($template = 'other', $data = #1) %strace-dedup-values-001.php:10
+%w%f %w%d      >=> 'other'
+%w%f %w%d     -> xdebug_stop_trace() %s:%d
+%w%f %w%d
+TRACE END   [%d-%d-%d %d:%d:%d.%d]
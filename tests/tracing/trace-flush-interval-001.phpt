@@ -0,0 +1,29 @@
+--TEST--
+Trace records are buffered until xdebug.trace_flush_interval_ms has passed
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.trace_format=1
+xdebug.trace_flush_interval_ms=600000
+xdebug.use_compression=0
+--FILE--
+<?php
+$tf = xdebug_start_trace(sys_get_temp_dir() . '/' . uniqid('xdt', TRUE));
+
+strlen( "flush" );
+$partial = file_get_contents( $tf );
+
+xdebug_stop_trace();
+$full = file_get_contents( $tf );
+unlink( $tf );
+
+var_dump( substr_count( $partial, "\n" ) );
+var_dump( strpos( $partial, 'strlen' ) );
+var_dump( strpos( $full, 'strlen' ) !== false );
+var_dump( strpos( $full, 'TRACE END' ) !== false );
+?>
+--EXPECT--
+int(3)
+bool(false)
+bool(true)
+bool(true)
@@ -0,0 +1,42 @@
+--TEST--
+Tracing: Markers and spans from xdebug_trace_marker() and xdebug_span_begin()
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.collect_return=0
+xdebug.collect_assignments=0
+xdebug.trace_format=0
+--FILE--
+<?php
+require_once 'capture-trace.inc';
+
+function work()
+{
+	xdebug_span_begin('inner');
+	strlen('x');
+}
+
+xdebug_trace_marker('start', ['user' => 42]);
+
+xdebug_span_begin('outer');
+work();
+xdebug_span_end();
+
+xdebug_stop_trace();
+?>
+--EXPECTF--
+TRACE START [%d-%d-%d %d:%d:%d.%d]
+%w%f %w%d     -> xdebug_trace_marker($label = 'start', $attributes = ['user' => 42]) %strace-marker-001.php:10
+%w%f %w%d     -- marker 'start' ['user' => 42]
+%w%f %w%d     -> xdebug_span_begin($label = 'outer') %strace-marker-001.php:12
+%w%f %w%d     -- span #1 begin 'outer'
+%w%f %w%d     -> work() %strace-marker-001.php:13
+%w%f %w%d       -> xdebug_span_begin($label = 'inner') %strace-marker-001.php:6
+%w%f %w%d       -- span #2 begin 'inner'
+%w%f %w%d       -> strlen($string = 'x') %strace-marker-001.php:7
+%w%f %w%d       -- span #2 end 'inner', %f sec
+%w%f %w%d     -> xdebug_span_end() %strace-marker-001.php:14
+%w%f %w%d     -- span #1 end 'outer', %f sec
+%w%f %w%d     -> xdebug_stop_trace() %s:%d
+%w%f %w%d
+TRACE END   [%d-%d-%d %d:%d:%d.%d]
@@ -0,0 +1,42 @@
+--TEST--
+Tracing: Trace file segment rotation with xdebug.trace_segment_size and xdebug.trace_max_size
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.use_compression=0
+xdebug.trace_format=0
+xdebug.trace_segment_size=1024
+xdebug.trace_max_size=3072
+--FILE--
+<?php
+$tf = xdebug_start_trace(sys_get_temp_dir() . '/' . uniqid('xdt', TRUE));
+
+for ($i = 0; $i < 100; $i++) {
+	str_repeat('x', 10);
+}
+
+$last = xdebug_stop_trace();
+
+$segments = glob(preg_replace('@\.xt$@', '', $tf) . '.*.xt');
+
+var_dump(file_exists($tf));
+var_dump(count($segments));
+var_dump(in_array($last, $segments));
+
+foreach ($segments as $segment) {
+	$trace = file_get_contents($segment);
+	echo substr($trace, 0, 11), "\n";
+	var_dump((bool) preg_match('@TRACE END   \[[^\]]+\]$@', rtrim($trace)));
+	unlink($segment);
+}
+?>
+--EXPECT--
+bool(false)
+int(3)
+bool(true)
+TRACE START
+bool(true)
+TRACE START
+bool(true)
+TRACE START
+bool(true)
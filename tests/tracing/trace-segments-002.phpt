@@ -0,0 +1,28 @@
+--TEST--
+Tracing: Trace stops with a footer when it reaches xdebug.trace_max_size
+--INI--
+xdebug.mode=trace
+xdebug.start_with_request=no
+xdebug.use_compression=0
+xdebug.trace_format=0
+xdebug.trace_max_size=2048
+--FILE--
+<?php
+$tf = xdebug_start_trace(sys_get_temp_dir() . '/' . uniqid('xdt', TRUE));
+
+for ($i = 0; $i < 100; $i++) {
+	str_repeat('x', 10);
+}
+
+var_dump(xdebug_get_tracefile_name());
+
+$trace = file_get_contents($tf);
+var_dump(strlen($trace) >= 2048 && strlen($trace) < 4096);
+var_dump((bool) preg_match('@TRACE END   \[[^\]]+\]$@', rtrim($trace)));
+
+unlink($tf);
+?>
+--EXPECT--
+bool(false)
+bool(true)
+bool(true)
@@ -63,6 +63,7 @@
 #include "lib/var_export_html.h"
 #include "lib/var_export_line.h"
 #include "lib/var_export_text.h"
+#include "profiler/categories.h"
 #include "profiler/profiler.h"
 #include "tracing/tracing.h"
 
@@ -289,6 +290,13 @@ PHP_INI_BEGIN()
 	/* Base settings */
 	STD_PHP_INI_ENTRY("xdebug.max_nesting_level", "512",                PHP_INI_ALL,    OnUpdateLong,   settings.base.max_nesting_level, zend_xdebug_globals, xdebug_globals)
 
+	/* Code coverage settings */
+	STD_PHP_INI_ENTRY("xdebug.coverage_cache_dir", "",                  PHP_INI_ALL,    OnUpdateString, settings.coverage.cache_dir,     zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_ENTRY("xdebug.coverage_max_paths", "4096",              PHP_INI_ALL,    OnUpdateLong,   settings.coverage.max_paths,     zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_BOOLEAN("xdebug.coverage_line_only", "0",               PHP_INI_SYSTEM, OnUpdateBool,   settings.coverage.line_only,     zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_ENTRY("xdebug.coverage_shared_file", "",                PHP_INI_SYSTEM, OnUpdateString, settings.coverage.shared_file,   zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_ENTRY("xdebug.coverage_shared_sample", "1",             PHP_INI_SYSTEM, OnUpdateLong,   settings.coverage.shared_sample, zend_xdebug_globals, xdebug_globals)
+
 	/* Develop settings */
 	STD_PHP_INI_ENTRY("xdebug.cli_color",         "0",                  PHP_INI_ALL,    OnUpdateLong,   settings.develop.cli_color,         zend_xdebug_globals, xdebug_globals)
 	STD_PHP_INI_BOOLEAN("xdebug.force_display_errors", "0",             PHP_INI_SYSTEM, OnUpdateBool,   settings.develop.force_display_errors, zend_xdebug_globals, xdebug_globals)
@@ -315,6 +323,8 @@ PHP_INI_BEGIN()
 	/* Profiler settings */
 	STD_PHP_INI_ENTRY("xdebug.profiler_output_name",      "cachegrind.out.%p",  PHP_INI_SYSTEM|PHP_INI_PERDIR, OnUpdateString, settings.profiler.profiler_output_name,          zend_xdebug_globals, xdebug_globals)
 	STD_PHP_INI_BOOLEAN("xdebug.profiler_append",         "0",                  PHP_INI_SYSTEM|PHP_INI_PERDIR, OnUpdateBool,   settings.profiler.profiler_append,               zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_BOOLEAN("xdebug.profiler_include_report", "0",                  PHP_INI_SYSTEM|PHP_INI_PERDIR, OnUpdateBool,   settings.profiler.profiler_include_report,       zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_ENTRY("xdebug.profiler_categories",       XDEBUG_PROFILER_DEFAULT_CATEGORIES, PHP_INI_SYSTEM, OnUpdateString, settings.profiler.profiler_categories,  zend_xdebug_globals, xdebug_globals)
 
 	/* Xdebug Cloud */
 	STD_PHP_INI_ENTRY("xdebug.cloud_id", "", PHP_INI_SYSTEM, OnUpdateString, settings.debugger.cloud_id, zend_xdebug_globals, xdebug_globals)
@@ -335,10 +345,16 @@ PHP_INI_BEGIN()
 
 	/* Tracing settings */
 	STD_PHP_INI_ENTRY("xdebug.trace_output_name", "trace.%c",           PHP_INI_ALL,    OnUpdateString, settings.tracing.trace_output_name, zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_ENTRY("xdebug.trace_call_limit",  "0",                  PHP_INI_ALL,    OnUpdateLong,   settings.tracing.trace_call_limit,  zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_BOOLEAN("xdebug.trace_dedup_values", "0",               PHP_INI_ALL,    OnUpdateBool,   settings.tracing.trace_dedup_values, zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_ENTRY("xdebug.trace_flush_interval_ms", "0",            PHP_INI_ALL,    OnUpdateLong,   settings.tracing.trace_flush_interval_ms, zend_xdebug_globals, xdebug_globals)
 	STD_PHP_INI_ENTRY("xdebug.trace_format",      "0",                  PHP_INI_ALL,    OnUpdateLong,   settings.tracing.trace_format,      zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_ENTRY("xdebug.trace_max_size",    "0",                  PHP_INI_ALL,    OnUpdateLong,   settings.tracing.trace_max_size,    zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_ENTRY("xdebug.trace_segment_size", "0",                 PHP_INI_ALL,    OnUpdateLong,   settings.tracing.trace_segment_size, zend_xdebug_globals, xdebug_globals)
 	STD_PHP_INI_ENTRY("xdebug.trace_options",     "0",                  PHP_INI_ALL,    OnUpdateLong,   settings.tracing.trace_options,     zend_xdebug_globals, xdebug_globals)
 	STD_PHP_INI_BOOLEAN("xdebug.collect_assignments", "0",              PHP_INI_ALL,    OnUpdateBool,   settings.tracing.collect_assignments, zend_xdebug_globals, xdebug_globals)
 	STD_PHP_INI_BOOLEAN("xdebug.collect_params", "1",                   PHP_INI_ALL,    OnUpdateBool,   settings.tracing.collect_params,    zend_xdebug_globals, xdebug_globals)
+	STD_PHP_INI_BOOLEAN("xdebug.collect_params_synopsis", "0",          PHP_INI_ALL,    OnUpdateBool,   settings.tracing.collect_params_synopsis, zend_xdebug_globals, xdebug_globals)
 	STD_PHP_INI_BOOLEAN("xdebug.collect_return",  "0",                  PHP_INI_ALL,    OnUpdateBool,   settings.tracing.collect_return,    zend_xdebug_globals, xdebug_globals)
 
 	/* Removed/Changed settings */
@@ -378,6 +394,8 @@ static void xdebug_init_base_globals(xdebug_base_globals_t *xg)
 	xg->in_var_serialisation = 0;
 	xg->error_reporting_override   = 0;
 	xg->error_reporting_overridden = 0;
+	xg->spans                = NULL;
+	xg->last_span_id         = 0;
 
 	xg->filter_type_code_coverage = XDEBUG_FILTER_NONE;
 	xg->filter_type_stack         = XDEBUG_FILTER_NONE;
@@ -385,6 +403,7 @@ static void xdebug_init_base_globals(xdebug_base_globals_t *xg)
 	xg->filters_code_coverage     = NULL;
 	xg->filters_stack             = NULL;
 	xg->filters_tracing           = NULL;
+	xg->filter_cache              = NULL;
 
 	xg->php_version_compile_time = PHP_VERSION;
 	xg->php_version_run_time     = zend_get_module_version("standard");
@@ -576,6 +595,9 @@ PHP_MSHUTDOWN_FUNCTION(xdebug)
 		return SUCCESS;
 	}
 
+	if (XDEBUG_MODE_IS(XDEBUG_MODE_COVERAGE)) {
+		xdebug_coverage_mshutdown();
+	}
 	if (XDEBUG_MODE_IS(XDEBUG_MODE_GCSTATS)) {
 		xdebug_gcstats_mshutdown();
 	}